@@ -75,6 +75,12 @@ void BaseRunner::execRunnableFunc()
     m_signals.emitDestroyRequest();
 }
 
+void BaseRunner::discardRunnableFunc()
+{
+    m_signals.emitEnded();
+    m_signals.emitDestroyRequest();
+}
+
 bool BaseRunner::isAbortRequested()
 {
     return false;
@@ -49,6 +49,7 @@ protected:
     BaseRunnerSignals* qtSignals();
 
     void execRunnableFunc();
+    void discardRunnableFunc();
 
     virtual bool isAbortRequested();
     virtual void requestAbort();
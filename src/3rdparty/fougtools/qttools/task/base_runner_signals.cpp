@@ -25,6 +25,7 @@ BaseRunnerSignals::BaseRunnerSignals(BaseRunner* runner, QObject *parent)
       m_runner(runner)
 {
     QObject::connect(this, &BaseRunnerSignals::aboutToRun, runner->m_mgr, &Manager::onAboutToRun);
+    QObject::connect(this, &BaseRunnerSignals::queued, runner->m_mgr, &Manager::queued);
     QObject::connect(this, &BaseRunnerSignals::started, runner->m_mgr, &Manager::started);
     QObject::connect(this, &BaseRunnerSignals::progressStep, runner->m_mgr, &Manager::progressStep);
     QObject::connect(this, &BaseRunnerSignals::progress, runner->m_mgr, &Manager::progress);
@@ -38,6 +39,11 @@ void BaseRunnerSignals::emitAboutToRun()
     emit aboutToRun(m_runner);
 }
 
+void BaseRunnerSignals::emitQueued(const QString &title)
+{
+    emit queued(m_runner->m_taskId, title);
+}
+
 void BaseRunnerSignals::emitStarted(const QString &title)
 {
     emit started(m_runner->m_taskId, title);
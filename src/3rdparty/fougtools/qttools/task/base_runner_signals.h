@@ -35,6 +35,7 @@ public:
     BaseRunnerSignals(BaseRunner* runner, QObject* parent = nullptr);
 
     void emitAboutToRun();
+    void emitQueued(const QString& title);
     void emitStarted(const QString& title);
     void emitProgressStep(const QString &title);
     void emitProgress(int pct);
@@ -44,6 +45,7 @@ public:
 
 signals:
     void aboutToRun(BaseRunner* runner);
+    void queued(quint64 taskId, const QString& title);
     void started(quint64 taskId, const QString& title);
     void progressStep(quint64 taskId, const QString& title);
     void progress(quint64 taskId, int pct);
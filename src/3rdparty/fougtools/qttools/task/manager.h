@@ -66,6 +66,7 @@ public:
     static Manager* globalInstance();
 
 signals:
+    void queued(quint64 taskId, const QString& title);
     void started(quint64 taskId, const QString& title);
     void progressStep(quint64 taskId, const QString& title);
     void progress(quint64 taskId, int percent);
@@ -6,10 +6,16 @@ HEADERS += \
     $$PWD/runner_current_thread.h \
     $$PWD/runner_qthread.h \
     $$PWD/runner_qthreadpool.h \
-    $$PWD/runner_stdasync.h
+    $$PWD/runner_scheduler.h \
+    $$PWD/runner_stdasync.h \
+    $$PWD/runner_work_stealing_pool.h \
+    $$PWD/scheduler.h \
+    $$PWD/work_stealing_pool.h
 
 SOURCES += \
     $$PWD/base_runner.cpp \
     $$PWD/base_runner_signals.cpp \
     $$PWD/manager.cpp \
-    $$PWD/progress.cpp
+    $$PWD/progress.cpp \
+    $$PWD/scheduler.cpp \
+    $$PWD/work_stealing_pool.cpp
@@ -0,0 +1,80 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "base_runner.h"
+#include "scheduler.h"
+
+#include <QtCore/QTimer>
+#include <atomic>
+
+namespace qttask {
+
+/*! \brief Task runner submitting a job to a Scheduler object
+ *
+ *  Manager::queued() is signalled when the task is submitted. If abort is
+ *  requested while the task is still queued then the job is cancelled and
+ *  Manager::ended() is signalled without prior Manager::started()
+ */
+template<>
+class Runner<Scheduler> : public BaseRunner
+{
+public:
+    /*! \param memoryCost Estimation of the memory(in bytes) required by the task
+     */
+    Runner<Scheduler>(const Manager* mgr,
+                      Scheduler* scheduler,
+                      int priority = 0,
+                      quint64 memoryCost = 0)
+        : BaseRunner(mgr),
+          m_scheduler(scheduler),
+          m_priority(priority),
+          m_memoryCost(memoryCost)
+    { }
+
+protected:
+    bool isAbortRequested() override
+    { return m_isAbortRequested; }
+
+    void requestAbort() override
+    {
+        m_isAbortRequested = true;
+        m_scheduler->cancel(this->taskId());
+    }
+
+    void launch() override
+    {
+        this->qtSignals()->emitQueued(this->taskTitle());
+        Scheduler::Job job;
+        job.id = this->taskId();
+        job.priority = m_priority;
+        job.memoryCost = m_memoryCost;
+        job.func = [=]{ this->execRunnableFunc(); };
+        // Deferred so the runner isn't destroyed within requestAbort()
+        job.cancelFunc = [=]{
+            QTimer::singleShot(0, this->qtSignals(), [=]{ this->discardRunnableFunc(); });
+        };
+        m_scheduler->submit(std::move(job));
+    }
+
+private:
+    Scheduler* m_scheduler = nullptr;
+    int m_priority = 0;
+    quint64 m_memoryCost = 0;
+    std::atomic<bool> m_isAbortRequested = {};
+};
+
+} // namespace qttask
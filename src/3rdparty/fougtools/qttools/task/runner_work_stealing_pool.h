@@ -0,0 +1,67 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "base_runner.h"
+#include "work_stealing_pool.h"
+
+#include <atomic>
+
+namespace qttask {
+
+/*! \brief Task runner executing in a WorkStealingPool
+ *
+ *  The task can be split into parallel subtasks with a TaskGroup sharing the
+ *  task progress:
+ *  \code
+ *      auto task = qttask::Manager::globalInstance()->newTask<qttask::WorkStealingPool>();
+ *      task->run([=]{
+ *          qttask::TaskGroup group(task->pool(), &task->progress());
+ *          for (const Item& item : items)
+ *              group.spawn([=]{ process(item); });
+ *      });
+ *  \endcode
+ */
+template<>
+class Runner<WorkStealingPool> : public BaseRunner
+{
+public:
+    Runner<WorkStealingPool>(
+            const Manager* mgr,
+            WorkStealingPool* pool = WorkStealingPool::globalInstance())
+        : BaseRunner(mgr),
+          m_pool(pool)
+    { }
+
+    WorkStealingPool* pool() const
+    { return m_pool; }
+
+protected:
+    bool isAbortRequested() override
+    { return m_isAbortRequested; }
+
+    void requestAbort() override
+    { m_isAbortRequested = true; }
+
+    void launch() override
+    { m_pool->submit([=]{ this->execRunnableFunc(); }); }
+
+private:
+    WorkStealingPool* m_pool = nullptr;
+    std::atomic<bool> m_isAbortRequested = {};
+};
+
+} // namespace qttask
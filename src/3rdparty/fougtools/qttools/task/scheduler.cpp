@@ -0,0 +1,191 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#include "scheduler.h"
+
+#include <algorithm>
+
+namespace qttask {
+
+Scheduler::Scheduler(int workerCount, quint64 memoryBudget)
+    : m_memoryBudget(memoryBudget)
+{
+    workerCount = std::max(workerCount, 1);
+    m_vecWorker.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i)
+        m_vecWorker.emplace_back([=]{ this->runWorker(); });
+}
+
+Scheduler::~Scheduler()
+{
+    std::vector<QueuedJob> vecCancelledJob;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+        vecCancelledJob.swap(m_vecQueuedJob);
+    }
+
+    m_condition.notify_all();
+    for (QueuedJob& queuedJob : vecCancelledJob) {
+        if (queuedJob.job.cancelFunc)
+            queuedJob.job.cancelFunc();
+    }
+
+    // Running jobs are completed
+    for (std::thread& worker : m_vecWorker)
+        worker.join();
+}
+
+int Scheduler::workerCount() const
+{
+    return static_cast<int>(m_vecWorker.size());
+}
+
+quint64 Scheduler::memoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryBudget;
+}
+
+void Scheduler::setMemoryBudget(quint64 budget)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_memoryBudget = budget;
+    }
+
+    m_condition.notify_all();
+}
+
+void Scheduler::submit(Job&& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_vecQueuedJob.push_back({ std::move(job), m_seq++ });
+    }
+
+    m_condition.notify_all();
+}
+
+bool Scheduler::cancel(quint64 jobId)
+{
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto itJob = this->findQueuedJob(jobId);
+        if (itJob == m_vecQueuedJob.end())
+            return false;
+
+        job = std::move(itJob->job);
+        m_vecQueuedJob.erase(itJob);
+    }
+
+    // Next job might now be admissible
+    m_condition.notify_all();
+    if (job.cancelFunc)
+        job.cancelFunc();
+
+    return true;
+}
+
+bool Scheduler::setPriority(quint64 jobId, int priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto itJob = this->findQueuedJob(jobId);
+        if (itJob == m_vecQueuedJob.end())
+            return false;
+
+        itJob->job.priority = priority;
+    }
+
+    m_condition.notify_all();
+    return true;
+}
+
+int Scheduler::queuedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int>(m_vecQueuedJob.size());
+}
+
+int Scheduler::runningCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_runningCount;
+}
+
+quint64 Scheduler::memoryInUse() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryInUse;
+}
+
+void Scheduler::runWorker()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_isStopping) {
+        auto itJob = this->findNextJob();
+        if (itJob == m_vecQueuedJob.end()) {
+            m_condition.wait(lock);
+            continue;
+        }
+
+        Job job = std::move(itJob->job);
+        m_vecQueuedJob.erase(itJob);
+        ++m_runningCount;
+        m_memoryInUse += job.memoryCost;
+        lock.unlock();
+        job.func();
+        lock.lock();
+        --m_runningCount;
+        m_memoryInUse -= job.memoryCost;
+        m_condition.notify_all();
+    }
+}
+
+// Returns the job of highest priority if it fits in the memory budget
+// Jobs of lower priority are not allowed to pass it, otherwise a big job would
+// be postponed as long as smaller ones are queued
+std::vector<Scheduler::QueuedJob>::iterator Scheduler::findNextJob()
+{
+    auto itNext = std::min_element(
+                m_vecQueuedJob.begin(),
+                m_vecQueuedJob.end(),
+                [](const QueuedJob& lhs, const QueuedJob& rhs) {
+        if (lhs.job.priority != rhs.job.priority)
+            return lhs.job.priority > rhs.job.priority;
+
+        return lhs.seq < rhs.seq;
+    });
+    if (itNext == m_vecQueuedJob.end())
+        return itNext;
+
+    const bool isAdmissible =
+            m_runningCount == 0
+            || m_memoryBudget == 0
+            || m_memoryInUse + itNext->job.memoryCost <= m_memoryBudget;
+    return isAdmissible ? itNext : m_vecQueuedJob.end();
+}
+
+std::vector<Scheduler::QueuedJob>::iterator Scheduler::findQueuedJob(quint64 jobId)
+{
+    return std::find_if(
+                m_vecQueuedJob.begin(),
+                m_vecQueuedJob.end(),
+                [=](const QueuedJob& queuedJob) { return queuedJob.job.id == jobId; });
+}
+
+} // namespace qttask
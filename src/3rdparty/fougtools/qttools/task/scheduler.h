@@ -0,0 +1,105 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QtGlobal>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qttask {
+
+/*! \brief Executes jobs on a fixed count of worker threads
+ *
+ *  Queued jobs are started by decreasing priority, jobs of same priority being
+ *  started in submission order.
+ *
+ *  Each job declares an estimated memory cost. A job is started only if the
+ *  sum of memory costs of running jobs stays within the memory budget, unless
+ *  no other job is running(so a job exceeding the budget still gets executed).
+ *
+ *  Typical use with Manager:
+ *  \code
+ *      auto task = qttask::Manager::globalInstance()->newTask<qttask::Scheduler>(
+ *                      &scheduler, priority, memoryCost);
+ *      task->run( [=] { someFunction(task->progress()); } );
+ *  \endcode
+ */
+class Scheduler
+{
+public:
+    struct Job {
+        quint64 id = 0;
+        int priority = 0;
+        quint64 memoryCost = 0;
+        std::function<void()> func;
+        //! Called if the job is removed from the queue before being started
+        std::function<void()> cancelFunc;
+    };
+
+    /*! \param memoryBudget Zero means no memory limit
+     */
+    Scheduler(int workerCount, quint64 memoryBudget = 0);
+    ~Scheduler();
+
+    int workerCount() const;
+
+    quint64 memoryBudget() const;
+    void setMemoryBudget(quint64 budget);
+
+    void submit(Job&& job);
+
+    /*! \brief Remove job \p jobId from the queue and call its cancel function
+     *
+     *  Returns false if the job is unknown or already started
+     */
+    bool cancel(quint64 jobId);
+
+    /*! \brief Change the priority of queued job \p jobId
+     *
+     *  Returns false if the job is unknown or already started
+     */
+    bool setPriority(quint64 jobId, int priority);
+
+    int queuedCount() const;
+    int runningCount() const;
+    quint64 memoryInUse() const;
+
+private:
+    struct QueuedJob {
+        Job job;
+        quint64 seq;
+    };
+
+    void runWorker();
+    std::vector<QueuedJob>::iterator findNextJob();
+    std::vector<QueuedJob>::iterator findQueuedJob(quint64 jobId);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<QueuedJob> m_vecQueuedJob;
+    std::vector<std::thread> m_vecWorker;
+    quint64 m_seq = 0;
+    quint64 m_memoryBudget = 0;
+    quint64 m_memoryInUse = 0;
+    int m_runningCount = 0;
+    bool m_isStopping = false;
+};
+
+} // namespace qttask
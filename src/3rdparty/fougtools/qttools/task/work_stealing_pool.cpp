@@ -0,0 +1,226 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#include "work_stealing_pool.h"
+
+#include "progress.h"
+
+#include <QtCore/QGlobalStatic>
+#include <QtCore/QThread>
+
+#include <algorithm>
+
+namespace qttask {
+
+namespace internal {
+
+// Pool and identifier of the worker running in the current thread
+static thread_local const WorkStealingPool* threadPool = nullptr;
+static thread_local int threadWorkerId = -1;
+
+} // namespace internal
+
+WorkStealingPool::WorkStealingPool(int workerCount)
+{
+    if (workerCount <= 0)
+        workerCount = QThread::idealThreadCount();
+
+    workerCount = std::max(workerCount, 1);
+    for (int i = 0; i < workerCount; ++i)
+        m_vecWorkerQueue.emplace_back(new JobQueue);
+
+    m_vecThread.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i)
+        m_vecThread.emplace_back([=]{ this->runWorker(i); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutexIdle);
+        m_isStopping = true;
+    }
+
+    m_conditionIdle.notify_all();
+    for (std::thread& thread : m_vecThread)
+        thread.join();
+}
+
+int WorkStealingPool::workerCount() const
+{
+    return static_cast<int>(m_vecThread.size());
+}
+
+void WorkStealingPool::submit(Job&& job)
+{
+    const int workerId = this->currentWorkerId();
+    JobQueue& queue = workerId >= 0 ? *m_vecWorkerQueue.at(workerId) : m_sharedQueue;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.deque.push_back(std::move(job));
+    }
+
+    ++m_pendingJobCount;
+    {
+        // Sleeping workers check the pending count with this mutex locked
+        std::lock_guard<std::mutex> lock(m_mutexIdle);
+    }
+
+    m_conditionIdle.notify_one();
+}
+
+Q_GLOBAL_STATIC(WorkStealingPool, globalPool)
+
+WorkStealingPool* WorkStealingPool::globalInstance()
+{
+    return globalPool();
+}
+
+void WorkStealingPool::runWorker(int workerId)
+{
+    internal::threadPool = this;
+    internal::threadWorkerId = workerId;
+    for (;;) {
+        if (this->runPendingJob())
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_mutexIdle);
+        m_conditionIdle.wait(lock, [=]{ return m_isStopping || m_pendingJobCount > 0; });
+        if (m_isStopping)
+            return;
+    }
+}
+
+bool WorkStealingPool::runPendingJob()
+{
+    Job job;
+    if (!this->takeJob(&job))
+        return false;
+
+    job();
+    return true;
+}
+
+bool WorkStealingPool::takeJob(Job* job)
+{
+    auto fnTake = [=](JobQueue& queue, bool fromBack) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.deque.empty())
+            return false;
+
+        if (fromBack) {
+            *job = std::move(queue.deque.back());
+            queue.deque.pop_back();
+        }
+        else {
+            *job = std::move(queue.deque.front());
+            queue.deque.pop_front();
+        }
+
+        --m_pendingJobCount;
+        return true;
+    };
+
+    // Most recent job of own queue, then oldest job of the other queues
+    const int workerId = this->currentWorkerId();
+    if (workerId >= 0 && fnTake(*m_vecWorkerQueue.at(workerId), true))
+        return true;
+
+    const int queueCount = static_cast<int>(m_vecWorkerQueue.size());
+    const int firstVictimId = workerId >= 0 ? workerId + 1 : 0;
+    for (int i = 0; i < queueCount; ++i) {
+        const int victimId = (firstVictimId + i) % queueCount;
+        if (victimId != workerId && fnTake(*m_vecWorkerQueue.at(victimId), false))
+            return true;
+    }
+
+    return fnTake(m_sharedQueue, false);
+}
+
+int WorkStealingPool::currentWorkerId() const
+{
+    return internal::threadPool == this ? internal::threadWorkerId : -1;
+}
+
+TaskGroup::TaskGroup(WorkStealingPool* pool, Progress* progress)
+    : m_pool(pool),
+      m_progress(progress)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    this->wait();
+}
+
+void TaskGroup::spawn(std::function<void()>&& func, int weight)
+{
+    ++m_pendingSubtaskCount;
+    m_totalWeight += weight;
+    m_pool->submit([=]{
+        if (!this->isAbortRequested())
+            func();
+
+        this->onSubtaskDone(weight);
+    });
+}
+
+void TaskGroup::wait()
+{
+    while (m_pendingSubtaskCount > 0) {
+        if (m_pool->runPendingJob())
+            continue;
+
+        // Remaining subtasks are running in other threads. Jobs submitted
+        // meanwhile are picked by idle workers, or by this thread if it's woken up
+        std::unique_lock<std::mutex> lock(m_mutexDone);
+        m_conditionDone.wait(lock, [=]{
+            return m_pendingSubtaskCount == 0 || m_pool->m_pendingJobCount > 0;
+        });
+    }
+
+    // The last subtask releases the mutex after decrementing the count, the
+    // group must not be destroyed before
+    std::lock_guard<std::mutex> lock(m_mutexDone);
+}
+
+bool TaskGroup::isAbortRequested() const
+{
+    return m_progress != nullptr && m_progress->isAbortRequested();
+}
+
+void TaskGroup::onSubtaskDone(int weight)
+{
+    const qint64 doneWeight = m_doneWeight += weight;
+    if (m_progress != nullptr) {
+        const qint64 totalWeight = m_totalWeight;
+        const int value = totalWeight > 0 ? static_cast<int>((100 * doneWeight) / totalWeight) : 100;
+        // Total weight can grow while subtasks are spawned, only increasing
+        // values are reported. Reports are serialized so they keep their order
+        std::lock_guard<std::mutex> lock(m_mutexProgress);
+        if (value > m_progressValue) {
+            m_progressValue = value;
+            m_progress->setValue(value);
+        }
+    }
+
+    // Count is decremented under the mutex so wait() can't miss the
+    // notification, nor return while the mutex is still in use
+    std::lock_guard<std::mutex> lock(m_mutexDone);
+    if (--m_pendingSubtaskCount == 0)
+        m_conditionDone.notify_all();
+}
+
+} // namespace qttask
@@ -0,0 +1,125 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QtGlobal>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qttask {
+
+class Progress;
+
+/*! \brief Thread pool where each worker owns a queue of jobs
+ *
+ *  A worker executes the jobs it pushed in LIFO order, and steals jobs from the
+ *  other workers in FIFO order when its own queue is empty.\n
+ *  Jobs are usually spawned through a TaskGroup, which allows fork/join
+ *  parallelism: a thread waiting for a TaskGroup executes pending jobs instead
+ *  of blocking, so nested groups don't oversubscribe the system. It blocks only
+ *  when there is nothing left to steal.
+ */
+class WorkStealingPool
+{
+public:
+    using Job = std::function<void()>;
+
+    /*! \param workerCount Zero means QThread::idealThreadCount()
+     */
+    explicit WorkStealingPool(int workerCount = 0);
+    ~WorkStealingPool();
+
+    int workerCount() const;
+
+    void submit(Job&& job);
+
+    static WorkStealingPool* globalInstance();
+
+private:
+    friend class TaskGroup;
+
+    struct JobQueue {
+        std::mutex mutex;
+        std::deque<Job> deque;
+    };
+
+    void runWorker(int workerId);
+    bool runPendingJob();
+    bool takeJob(Job* job);
+    int currentWorkerId() const;
+
+    std::vector<std::unique_ptr<JobQueue>> m_vecWorkerQueue;
+    JobQueue m_sharedQueue; // Jobs submitted by threads outside the pool
+    std::vector<std::thread> m_vecThread;
+    std::atomic<int> m_pendingJobCount = {};
+    std::mutex m_mutexIdle;
+    std::condition_variable m_conditionIdle;
+    bool m_isStopping = false;
+};
+
+/*! \brief Set of subtasks spawned in a WorkStealingPool, to be joined
+ *
+ *  Typical use:
+ *  \code
+ *      qttask::TaskGroup group(pool, progress);
+ *      group.spawn([=]{ computeLeft(); });
+ *      group.spawn([=]{ computeRight(); });
+ *      group.wait();
+ *  \endcode
+ *
+ *  If a Progress object is associated then its value is the weighted ratio of
+ *  completed subtasks. Subtasks not started yet are skipped once abort is
+ *  requested on the Progress object, running ones should check
+ *  TaskGroup::isAbortRequested()
+ */
+class TaskGroup
+{
+public:
+    TaskGroup(WorkStealingPool* pool, Progress* progress = nullptr);
+    ~TaskGroup();
+
+    void spawn(std::function<void()>&& func, int weight = 1);
+
+    //! Execute pending jobs until all subtasks are completed
+    /*! When no job is left to steal, the calling thread sleeps until the
+     *  subtasks still running in other threads are done
+     */
+    void wait();
+
+    bool isAbortRequested() const;
+
+private:
+    void onSubtaskDone(int weight);
+
+    WorkStealingPool* m_pool = nullptr;
+    Progress* m_progress = nullptr;
+    std::atomic<int> m_pendingSubtaskCount = {};
+    std::atomic<qint64> m_totalWeight = {};
+    std::atomic<qint64> m_doneWeight = {};
+    std::mutex m_mutexProgress;
+    int m_progressValue = 0;
+    std::mutex m_mutexDone;
+    std::condition_variable m_conditionDone;
+};
+
+} // namespace qttask
@@ -0,0 +1,248 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "batch_convert.h"
+
+#include "../base/application_item.h"
+#include "../base/document.h"
+#include "../base/os_utils.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <mutex>
+
+namespace Mayo {
+
+namespace Internal {
+
+class FunctionRunnable : public QRunnable {
+public:
+    FunctionRunnable(std::function<void()> fn)
+        : m_fn(std::move(fn))
+    {}
+
+    void run() override { m_fn(); }
+
+private:
+    std::function<void()> m_fn;
+};
+
+static Application::PartFormat partFormatFromName(const QString& name)
+{
+    const QString lowerName = name.toLower();
+    if (lowerName == "iges" || lowerName == "igs")
+        return Application::PartFormat::Iges;
+    if (lowerName == "step" || lowerName == "stp")
+        return Application::PartFormat::Step;
+    if (lowerName == "brep" || lowerName == "occ")
+        return Application::PartFormat::OccBrep;
+    if (lowerName == "stl" || lowerName == "stla")
+        return Application::PartFormat::Stl;
+
+    return Application::PartFormat::Unknown;
+}
+
+static QString partFormatSuffix(Application::PartFormat format)
+{
+    switch (format) {
+    case Application::PartFormat::Iges: return "iges";
+    case Application::PartFormat::Step: return "step";
+    case Application::PartFormat::OccBrep: return "brep";
+    case Application::PartFormat::Stl: return "stl";
+    case Application::PartFormat::Unknown: break;
+    }
+
+    return QString();
+}
+
+static QString toMegabytesText(qint64 bytes)
+{
+    return bytes >= 0 ? QString::number(bytes / (1024 * 1024)) + "MB" : QString("?");
+}
+
+static Application::ExportOptions defaultExportOptions()
+{
+    Application::ExportOptions options;
+#ifdef HAVE_GMIO
+    options.stlFormat = GMIO_STL_FORMAT_BINARY_LE;
+#else
+    options.stlFormat = Application::ExportOptions::StlFormat::Binary;
+#endif
+    return options;
+}
+
+// Converts a single file, returns a BatchConvert::ExitCode value
+static int convertFile(
+        const BatchConvert::Job& job,
+        const Application::MeshingParameters& meshingParams,
+        QString* report)
+{
+    auto app = Application::instance();
+    QElapsedTimer chrono;
+    chrono.start();
+
+    // Import
+    const Application::PartFormat inputFormat = Application::findPartFormat(job.inputFilePath);
+    if (inputFormat == Application::PartFormat::Unknown) {
+        *report = BatchConvert::tr("FAILED %1: unknown input format").arg(job.inputFilePath);
+        return BatchConvert::ExitImportFailure;
+    }
+
+    Document doc(nullptr);
+    Application::ImportInfo importInfo;
+    const Application::IoResult resImport =
+            app->importInDocument(
+                &doc, inputFormat, job.inputFilePath, meshingParams, nullptr, &importInfo);
+    if (!resImport) {
+        *report = BatchConvert::tr("FAILED %1: import error '%2'")
+                .arg(job.inputFilePath, resImport.errorText());
+        return BatchConvert::ExitImportFailure;
+    }
+
+    const qint64 importTime = chrono.restart();
+
+    // Export
+    std::vector<ApplicationItem> vecAppItem;
+    for (DocumentItem* docItem : doc.rootItems())
+        vecAppItem.emplace_back(docItem);
+
+    const Application::IoResult resExport = app->exportApplicationItems(
+                vecAppItem, job.outputFormat, Internal::defaultExportOptions(), job.outputFilePath);
+    if (!resExport) {
+        *report = BatchConvert::tr("FAILED %1: export error '%2'")
+                .arg(job.inputFilePath, resExport.errorText());
+        return BatchConvert::ExitExportFailure;
+    }
+
+    const qint64 exportTime = chrono.elapsed();
+    QString importText = BatchConvert::tr("import %1ms").arg(importTime);
+    if (importInfo.meshingTime >= 0)
+        importText += BatchConvert::tr(" (meshing %1ms)").arg(importInfo.meshingTime);
+    else if (importInfo.isFromCache)
+        importText += BatchConvert::tr(" (from cache)");
+
+    // Memory usage is the one of the whole process, so it includes the jobs
+    // running in parallel
+    *report = BatchConvert::tr("OK %1 -> %2 | %3 | export %4ms | process memory %5")
+            .arg(job.inputFilePath, job.outputFilePath, importText)
+            .arg(exportTime)
+            .arg(Internal::toMegabytesText(OsUtils::processMemoryUsage()));
+    return BatchConvert::ExitSuccess;
+}
+
+} // namespace Internal
+
+BatchConvert::JobsResult BatchConvert::createJobs(
+        const QStringList& listInputFilePath,
+        const QString& outputPath,
+        const QString& outputFormat)
+{
+    if (listInputFilePath.isEmpty())
+        return JobsResult::error(tr("No input file"));
+
+    if (outputPath.isEmpty())
+        return JobsResult::error(tr("No output specified"));
+
+    const QFileInfo outputInfo(outputPath);
+    const bool isOutputDir =
+            listInputFilePath.size() > 1
+            || outputInfo.isDir()
+            || outputPath.endsWith('/')
+            || outputPath.endsWith('\\');
+    const QString formatName = !outputFormat.isEmpty() ? outputFormat : outputInfo.suffix();
+    const Application::PartFormat format = Internal::partFormatFromName(formatName);
+    if (format == Application::PartFormat::Unknown)
+        return JobsResult::error(tr("Unknown output format '%1'").arg(formatName));
+
+    if (isOutputDir && !QDir().mkpath(outputPath))
+        return JobsResult::error(tr("Failed to create output directory '%1'").arg(outputPath));
+
+    std::vector<Job> vecJob;
+    QHash<QString, QString> hashOutputInput;
+    for (const QString& inputFilePath : listInputFilePath) {
+        Job job;
+        job.inputFilePath = inputFilePath;
+        job.outputFormat = format;
+        if (isOutputDir) {
+            const QString outputFileName =
+                    QFileInfo(inputFilePath).completeBaseName()
+                    + "." + Internal::partFormatSuffix(format);
+            job.outputFilePath = QDir(outputPath).filePath(outputFileName);
+        }
+        else {
+            job.outputFilePath = outputPath;
+        }
+
+        // Inputs with the same base name(eg from different directories) would
+        // overwrite the output of each other
+        const QString absOutputFilePath = QFileInfo(job.outputFilePath).absoluteFilePath();
+        auto itOutput = hashOutputInput.constFind(absOutputFilePath);
+        if (itOutput != hashOutputInput.cend()) {
+            return JobsResult::error(
+                        tr("Input files '%1' and '%2' have the same output file '%3'")
+                        .arg(itOutput.value(), inputFilePath, job.outputFilePath));
+        }
+
+        hashOutputInput.insert(absOutputFilePath, inputFilePath);
+        vecJob.push_back(std::move(job));
+    }
+
+    return JobsResult::ok(std::move(vecJob));
+}
+
+int BatchConvert::run(Span<const Job> spanJob, int threadCount)
+{
+    // Jobs share a snapshot of the meshing parameters, application state is
+    // left untouched. STL output requires meshed shapes
+    Application::MeshingParameters meshingParams = Application::instance()->meshingParameters();
+    const bool hasStlOutput = std::any_of(spanJob.begin(), spanJob.end(), [](const Job& job) {
+        return job.outputFormat == Application::PartFormat::Stl;
+    });
+    if (hasStlOutput)
+        meshingParams.enabled = true;
+
+    QElapsedTimer chrono;
+    chrono.start();
+    std::mutex mutexOutput;
+    std::atomic<int> exitCode = {};
+    std::atomic<int> failureCount = {};
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::max(1, threadCount));
+    for (const Job& job : spanJob) {
+        pool.start(new Internal::FunctionRunnable([&, job]{
+            QString report;
+            const int jobExitCode = Internal::convertFile(job, meshingParams, &report);
+            exitCode.fetch_or(jobExitCode);
+            if (jobExitCode != ExitSuccess)
+                ++failureCount;
+
+            std::lock_guard<std::mutex> lock(mutexOutput);
+            std::ostream& out = jobExitCode == ExitSuccess ? std::cout : std::cerr;
+            out << qUtf8Printable(report) << std::endl;
+        }));
+    }
+
+    pool.waitForDone();
+    const QString summary =
+            tr("%1 file(s) converted, %2 failed | total %3ms | process peak memory %4")
+            .arg(static_cast<int>(spanJob.size()) - failureCount.load())
+            .arg(failureCount.load())
+            .arg(chrono.elapsed())
+            .arg(Internal::toMegabytesText(OsUtils::processPeakMemoryUsage()));
+    std::cout << qUtf8Printable(summary) << std::endl;
+    return exitCode;
+}
+
+} // namespace Mayo
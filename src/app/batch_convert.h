@@ -0,0 +1,51 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/application.h"
+#include "../base/result.h"
+#include "../base/span.h"
+#include <QtCore/QCoreApplication>
+#include <QtCore/QStringList>
+#include <vector>
+
+namespace Mayo {
+
+// Headless conversion of part files, backs the '--convert' command-line mode
+// Jobs are run by a bounded pool of worker threads, no GUI object is created
+class BatchConvert {
+    Q_DECLARE_TR_FUNCTIONS(Mayo::BatchConvert)
+public:
+    struct Job {
+        QString inputFilePath;
+        QString outputFilePath;
+        Application::PartFormat outputFormat;
+    };
+
+    // Exit code of run(), bits are combined when several kind of failures occur
+    enum ExitCode {
+        ExitSuccess = 0,
+        ExitInvalidArguments = 1,
+        ExitImportFailure = 2,
+        ExitExportFailure = 4
+    };
+
+    using JobsResult = Result<std::vector<Job>>;
+
+    // 'outputPath' is the output file if there is a single input file, otherwise
+    // it's the directory where output files are written. 'outputFormat' can be
+    // empty if it can be deduced from the suffix of 'outputPath'
+    // Fails if several input files would be converted to the same output file
+    static JobsResult createJobs(
+            const QStringList& listInputFilePath,
+            const QString& outputPath,
+            const QString& outputFormat);
+
+    static int run(Span<const Job> spanJob, int threadCount);
+};
+
+} // namespace Mayo
@@ -38,7 +38,7 @@ DialogOptions::DialogOptions(QWidget *parent)
 {
     m_ui->setupUi(this);
 #ifndef HAVE_GMIO
-    m_ui->groupBox_StlIo->hide();
+    m_ui->radioBtn_UseGmio->hide();
     this->adjustSize();
 #endif
 
@@ -48,10 +48,34 @@ DialogOptions::DialogOptions(QWidget *parent)
     auto btnGrp_stlIoLib = new QButtonGroup(this);
     btnGrp_stlIoLib->addButton(m_ui->radioBtn_UseGmio);
     btnGrp_stlIoLib->addButton(m_ui->radioBtn_UseOcc);
+    btnGrp_stlIoLib->addButton(m_ui->radioBtn_UseMayo);
 
     const auto lib = settings->valueAsEnum<Application::StlIoLibrary>(Keys::Base_StlIoLibrary);
     m_ui->radioBtn_UseGmio->setChecked(lib == Application::StlIoLibrary::Gmio);
     m_ui->radioBtn_UseOcc->setChecked(lib == Application::StlIoLibrary::OpenCascade);
+    m_ui->radioBtn_UseMayo->setChecked(lib == Application::StlIoLibrary::Mayo);
+
+    // STEP/IGES import
+    m_ui->checkBox_ConcurrentImport->setChecked(
+                settings->valueAs<bool>(Keys::Base_ConcurrentImportEnabled));
+
+    // BRep meshing
+    m_ui->checkBox_MeshingEnabled->setChecked(settings->valueAs<bool>(Keys::Base_MeshingEnabled));
+    m_ui->spinBox_MeshingDeviationCoefficient->setValue(
+                settings->valueAs<double>(Keys::Base_MeshingDeviationCoefficient));
+    m_ui->spinBox_MeshingAngularDeflection->setValue(
+                settings->valueAs<double>(Keys::Base_MeshingAngularDeflection));
+
+    // Tessellation cache
+    m_ui->checkBox_TessellationCacheEnabled->setChecked(
+                settings->valueAs<bool>(Keys::Base_TessellationCacheEnabled));
+    m_ui->lineEdit_TessellationCacheDirectory->setText(
+                settings->valueAs<QString>(Keys::Base_TessellationCacheDirectory));
+    m_ui->spinBox_TessellationCacheMaxSize->setValue(
+                settings->valueAs<int>(Keys::Base_TessellationCacheMaxSize));
+    QObject::connect(m_ui->btn_TessellationCacheClear, &QAbstractButton::clicked, [=]{
+        Application::instance()->tessellationCache()->clear();
+    });
 
     // BRep shape defaults
     m_brepShapeDefaultColor = settings->valueAs<QColor>(Keys::Gpx_BrepShapeDefaultColor);
@@ -68,6 +92,8 @@ DialogOptions::DialogOptions(QWidget *parent)
     m_ui->comboBox_BRepShapeDefaultMaterial->setCurrentIndex(
                 m_ui->comboBox_BRepShapeDefaultMaterial->findData(
                     settings->valueAsEnum<Graphic3d_NameOfMaterial>(Keys::Gpx_BrepShapeDefaultMaterial)));
+    m_ui->checkBox_BRepShapeInstancing->setChecked(
+                settings->valueAs<bool>(Keys::Gpx_BrepShapeDefaultInstancing));
 
     // Mesh defaults
     m_meshDefaultColor = settings->valueAs<QColor>(Keys::Gpx_MeshDefaultColor);
@@ -87,6 +113,10 @@ DialogOptions::DialogOptions(QWidget *parent)
     m_ui->checkBox_MeshShowEdges->setChecked(settings->valueAs<bool>(Keys::Gpx_MeshDefaultShowEdges));
     m_ui->checkBox_MeshShowNodes->setChecked(settings->valueAs<bool>(Keys::Gpx_MeshDefaultShowNodes));
 
+    // 3D view
+    m_ui->spinBox_TargetFrameTime->setValue(settings->valueAs<int>(Keys::Gui_TargetFrameTime));
+    m_ui->checkBox_ShowFrameStats->setChecked(settings->valueAs<bool>(Keys::Gui_ShowFrameStats));
+
     // Clip planes
     m_ui->checkBox_Capping->setChecked(settings->valueAs<bool>(Keys::Gui_ClipPlaneCappingOn));
     for (const Enumeration::Item& m : OcctEnums::Aspect_HatchStyle().items())
@@ -121,10 +151,36 @@ void DialogOptions::accept()
         settings->setValue(Keys::Base_StlIoLibrary, int(Application::StlIoLibrary::Gmio));
     else if (m_ui->radioBtn_UseOcc->isChecked())
         settings->setValue(Keys::Base_StlIoLibrary, int(Application::StlIoLibrary::OpenCascade));
+    else if (m_ui->radioBtn_UseMayo->isChecked())
+        settings->setValue(Keys::Base_StlIoLibrary, int(Application::StlIoLibrary::Mayo));
+
+    // STEP/IGES import
+    settings->setValue(Keys::Base_ConcurrentImportEnabled, m_ui->checkBox_ConcurrentImport->isChecked());
+
+    // BRep meshing
+    settings->setValue(Keys::Base_MeshingEnabled, m_ui->checkBox_MeshingEnabled->isChecked());
+    settings->setValue(
+                Keys::Base_MeshingDeviationCoefficient,
+                m_ui->spinBox_MeshingDeviationCoefficient->value());
+    settings->setValue(
+                Keys::Base_MeshingAngularDeflection,
+                m_ui->spinBox_MeshingAngularDeflection->value());
+
+    // Tessellation cache
+    settings->setValue(
+                Keys::Base_TessellationCacheEnabled,
+                m_ui->checkBox_TessellationCacheEnabled->isChecked());
+    settings->setValue(
+                Keys::Base_TessellationCacheDirectory,
+                m_ui->lineEdit_TessellationCacheDirectory->text());
+    settings->setValue(
+                Keys::Base_TessellationCacheMaxSize,
+                m_ui->spinBox_TessellationCacheMaxSize->value());
 
     // BRep shape defaults
     settings->setValue(Keys::Gpx_BrepShapeDefaultColor, m_brepShapeDefaultColor);
     settings->setValue( Keys::Gpx_BrepShapeDefaultMaterial, m_ui->comboBox_BRepShapeDefaultMaterial->currentData());
+    settings->setValue(Keys::Gpx_BrepShapeDefaultInstancing, m_ui->checkBox_BRepShapeInstancing->isChecked());
 
     // Mesh defaults
     settings->setValue(Keys::Gpx_MeshDefaultColor, m_meshDefaultColor);
@@ -132,6 +188,10 @@ void DialogOptions::accept()
     settings->setValue(Keys::Gpx_MeshDefaultShowEdges, m_ui->checkBox_MeshShowEdges->isChecked());
     settings->setValue(Keys::Gpx_MeshDefaultShowNodes, m_ui->checkBox_MeshShowNodes->isChecked());
 
+    // 3D view
+    settings->setValue(Keys::Gui_TargetFrameTime, m_ui->spinBox_TargetFrameTime->value());
+    settings->setValue(Keys::Gui_ShowFrameStats, m_ui->checkBox_ShowFrameStats->isChecked());
+
     // Clip planes
     settings->setValue(Keys::Gui_ClipPlaneCappingOn, m_ui->checkBox_Capping->isChecked());
     settings->setValue(Keys::Gui_ClipPlaneCappingHatch, m_ui->comboBox_CappingHatch->currentData());
@@ -6,6 +6,7 @@
 
 #include "dialog_task_manager.h"
 
+#include "../base/application.h"
 #include "../base/string_utils.h"
 #include "settings.h"
 #include "ui_dialog_task_manager.h"
@@ -114,6 +115,9 @@ DialogTaskManager::DialogTaskManager(QWidget* parent)
     this->setWindowModality(Qt::WindowModal);
 
     auto taskMgr = qttask::Manager::globalInstance();
+    QObject::connect(
+                taskMgr, &qttask::Manager::queued,
+                this, &DialogTaskManager::onTaskQueued);
     QObject::connect(
                 taskMgr, &qttask::Manager::started,
                 this, &DialogTaskManager::onTaskStarted);
@@ -126,6 +130,7 @@ DialogTaskManager::DialogTaskManager(QWidget* parent)
     QObject::connect(
                 taskMgr, &qttask::Manager::progressStep,
                 this, &DialogTaskManager::onTaskProgressStep);
+    this->updateTessellationCacheStatistics();
 }
 
 DialogTaskManager::~DialogTaskManager()
@@ -133,21 +138,23 @@ DialogTaskManager::~DialogTaskManager()
     delete m_ui;
 }
 
+void DialogTaskManager::onTaskQueued(quint64 taskId, const QString& /*title*/)
+{
+    this->addTaskWidget(taskId);
+    this->onTaskProgressStep(taskId, tr("Queued"));
+}
+
 void DialogTaskManager::onTaskStarted(quint64 taskId, const QString& title)
 {
-    if (!m_isRunning)
-        this->show();
+    // Widget already exists if the task was queued
+    const bool wasQueued = this->taskWidget(taskId) != nullptr;
+    if (!wasQueued)
+        this->addTaskWidget(taskId);
 
-    auto widget = new TaskWidget(m_ui->scrollAreaContents);
-    widget->m_interruptBtn->setProperty(TaskWidget::TaskIdProp, taskId);
-    QObject::connect(
-                widget->m_interruptBtn, &QToolButton::clicked,
-                this, &DialogTaskManager::interruptTask);
-    m_ui->contentsLayout->insertWidget(0, widget);
-    m_taskIdToWidget.insert(taskId, widget);
-    ++m_taskCount;
-    if (!title.isEmpty())
+    if (!title.isEmpty() || wasQueued)
         this->onTaskProgressStep(taskId, QString());
+
+    this->updateTessellationCacheStatistics();
 }
 
 void DialogTaskManager::onTaskEnded(quint64 taskId)
@@ -162,6 +169,7 @@ void DialogTaskManager::onTaskEnded(quint64 taskId)
         m_taskIdToWidget.remove(taskId);
     }
 
+    this->updateTessellationCacheStatistics();
     --m_taskCount;
     if (m_taskCount == 0) {
         m_isRunning = false;
@@ -211,10 +219,42 @@ void DialogTaskManager::interruptTask()
     }
 }
 
+void DialogTaskManager::updateTessellationCacheStatistics()
+{
+    const TessellationCache* cache = Application::instance()->tessellationCache();
+    m_ui->label_TessellationCache->setVisible(cache->isEnabled());
+    if (cache->isEnabled()) {
+        const TessellationCache::Statistics stats = cache->statistics();
+        const QLocale locale = Settings::instance()->locale();
+        m_ui->label_TessellationCache->setText(
+                    tr("Tessellation cache: %1 hits, %2 misses, %3 entries (%4MB)")
+                    .arg(stats.hitCount)
+                    .arg(stats.missCount)
+                    .arg(stats.entryCount)
+                    .arg(locale.toString(stats.totalSize / (1024. * 1024.), 'f', 1)));
+    }
+}
+
 DialogTaskManager::TaskWidget* DialogTaskManager::taskWidget(quint64 taskId)
 {
     auto it = m_taskIdToWidget.find(taskId);
     return it != m_taskIdToWidget.end() ? it.value() : nullptr;
 }
 
+DialogTaskManager::TaskWidget* DialogTaskManager::addTaskWidget(quint64 taskId)
+{
+    if (!m_isRunning)
+        this->show();
+
+    auto widget = new TaskWidget(m_ui->scrollAreaContents);
+    widget->m_interruptBtn->setProperty(TaskWidget::TaskIdProp, taskId);
+    QObject::connect(
+                widget->m_interruptBtn, &QToolButton::clicked,
+                this, &DialogTaskManager::interruptTask);
+    m_ui->contentsLayout->insertWidget(0, widget);
+    m_taskIdToWidget.insert(taskId, widget);
+    ++m_taskCount;
+    return widget;
+}
+
 } // namespace Mayo
@@ -20,12 +20,15 @@ public:
 private:
     class TaskWidget;
     TaskWidget* taskWidget(quint64 taskId);
+    TaskWidget* addTaskWidget(quint64 taskId);
 
+    void onTaskQueued(quint64 taskId, const QString& title);
     void onTaskStarted(quint64 taskId, const QString& title);
     void onTaskEnded(quint64 taskId);
     void onTaskProgress(quint64 taskId, int percent);
     void onTaskProgressStep(quint64 taskId, const QString& name);
     void interruptTask();
+    void updateTessellationCacheStatistics();
 
     class Ui_DialogTaskManager* m_ui = nullptr;
     QHash<quint64, TaskWidget*> m_taskIdToWidget;
@@ -9,6 +9,7 @@
 #include "../gpx/gpx_document_item_factory.h"
 #include "../gpx/gpx_mesh_item.h"
 #include "../gpx/gpx_xde_document_item.h"
+#include "batch_convert.h"
 #include "mainwindow.h"
 #include "settings.h"
 #include "settings_keys.h"
@@ -19,8 +20,13 @@
 #include "widget_model_tree_builder_mesh.h"
 
 #include <QtCore/QCommandLineParser>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QThread>
 #include <QtCore/QTimer>
 #include <QtWidgets/QApplication>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
 
@@ -31,6 +37,10 @@ class Main { Q_DECLARE_TR_FUNCTIONS(Main) };
 struct CommandLineArguments {
     QString themeName;
     QStringList listFileToOpen;
+    QStringList listFileToConvert;
+    QString convertOutputPath;
+    QString convertOutputFormat;
+    int convertJobCount = 0;
 };
 
 static CommandLineArguments processCommandLine()
@@ -49,18 +59,64 @@ static CommandLineArguments processCommandLine()
                 Main::tr("name"));
     cmdParser.addOption(cmdOptionTheme);
 
+    const QCommandLineOption cmdOptionConvert(
+                "convert",
+                Main::tr("Convert file without GUI, can be repeated. Exit code is 0 on success, "
+                         "otherwise a combination of 1(invalid arguments), 2(import failure) "
+                         "and 4(export failure)"),
+                Main::tr("file"));
+    cmdParser.addOption(cmdOptionConvert);
+
+    const QCommandLineOption cmdOptionConvertTo(
+                "to",
+                Main::tr("Output file of conversion, or output directory if several files "
+                         "are converted"),
+                Main::tr("path"));
+    cmdParser.addOption(cmdOptionConvertTo);
+
+    const QCommandLineOption cmdOptionConvertFormat(
+                "format",
+                Main::tr("Output format of conversion(iges|step|brep|stl), deduced from "
+                         "output file suffix if not specified"),
+                Main::tr("format"));
+    cmdParser.addOption(cmdOptionConvertFormat);
+
+    const QCommandLineOption cmdOptionConvertJobs(
+                "jobs",
+                Main::tr("Count of files converted in parallel, defaults to the count of "
+                         "processor cores"),
+                Main::tr("count"));
+    cmdParser.addOption(cmdOptionConvertJobs);
+
     cmdParser.addPositionalArgument(
                 Main::tr("files"),
                 Main::tr("Files to open at startup, optionally"),
                 Main::tr("[files...]"));
 
-    cmdParser.process(QApplication::arguments());
+    cmdParser.process(QCoreApplication::arguments());
 
     // Retrieve arguments
     args.themeName = "dark";
     if (cmdParser.isSet(cmdOptionTheme))
         args.themeName = cmdParser.value(cmdOptionTheme);
     args.listFileToOpen = cmdParser.positionalArguments();
+    args.listFileToConvert = cmdParser.values(cmdOptionConvert);
+    args.convertOutputPath = cmdParser.value(cmdOptionConvertTo);
+    args.convertOutputFormat = cmdParser.value(cmdOptionConvertFormat);
+    args.convertJobCount = QThread::idealThreadCount();
+    if (cmdParser.isSet(cmdOptionConvertJobs)) {
+        // Invalid value is a usage error, as unknown options are for QCommandLineParser
+        bool isCountValid = false;
+        const QString strCount = cmdParser.value(cmdOptionConvertJobs);
+        args.convertJobCount = strCount.toInt(&isCountValid);
+        if (!isCountValid || args.convertJobCount < 1) {
+            const QString errorText =
+                    Main::tr("ERROR: Invalid count of jobs '%1', a positive integer is expected")
+                    .arg(strCount);
+            std::cerr << qUtf8Printable(errorText) << std::endl;
+            std::exit(BatchConvert::ExitInvalidArguments);
+        }
+    }
 
     return args;
 }
@@ -73,29 +129,36 @@ Theme* mayoTheme()
     return globalTheme.get();
 }
 
-static int runApp(QApplication* app)
+// Setup of settings and Application, common to GUI and headless modes
+static void initApplication()
 {
-    const CommandLineArguments args = processCommandLine();
     Mayo::Application::setOpenCascadeEnvironment("opencascade.conf");
 
-    // Register Gpx factory functions
-    GpxDocumentItemFactory::instance()->registerCreatorFunction(
-                XdeDocumentItem::TypeName,
-                &GpxDocumentItemFactory::createGpx<XdeDocumentItem, GpxXdeDocumentItem>);
-    GpxDocumentItemFactory::instance()->registerCreatorFunction(
-                MeshItem::TypeName,
-                &GpxDocumentItemFactory::createGpx<MeshItem, GpxMeshItem>);
-
     // Default values
     auto settings = Settings::instance();
     settings->setDefaultValue(Keys::App_RecentFiles, QStringList());
     settings->setDefaultValue(Keys::App_MainWindowLastOpenDir, QString());
     settings->setDefaultValue(Keys::App_MainWindowLastSelectedFilter, QString());
     settings->setDefaultValue(Keys::App_MainWindowLinkWithDocumentSelector, false);
+    {
+        const Application::MeshingParameters meshingParams;
+        settings->setDefaultValue(Keys::Base_MeshingEnabled, meshingParams.enabled);
+        settings->setDefaultValue(Keys::Base_MeshingDeviationCoefficient, meshingParams.deviationCoefficient);
+        settings->setDefaultValue(
+                    Keys::Base_MeshingAngularDeflection,
+                    UnitSystem::degrees(meshingParams.angularDeflection).value);
+    }
+    settings->setDefaultValue(Keys::Base_ConcurrentImportEnabled, false);
     settings->setDefaultValue(Keys::Base_StlIoLibrary, static_cast<int>(Application::StlIoLibrary::OpenCascade));
+    settings->setDefaultValue(
+                Keys::Base_TessellationCacheDirectory,
+                QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/tessellation");
+    settings->setDefaultValue(Keys::Base_TessellationCacheEnabled, false);
+    settings->setDefaultValue(Keys::Base_TessellationCacheMaxSize, 1024); // MB
     settings->setDefaultValue(Keys::Base_UnitSystemSchema, UnitSystem::SI);
     settings->setDefaultValue(Keys::Base_UnitSystemDecimals, 2);
     settings->setDefaultValue(Keys::Gpx_BrepShapeDefaultColor, QColor(Qt::gray));
+    settings->setDefaultValue(Keys::Gpx_BrepShapeDefaultInstancing, false);
     settings->setDefaultValue(Keys::Gpx_BrepShapeDefaultMaterial, Graphic3d_NOM_PLASTIC);
     settings->setDefaultValue(Keys::Gpx_MeshDefaultColor, QColor(Qt::gray));
     settings->setDefaultValue(Keys::Gpx_MeshDefaultMaterial, Graphic3d_NOM_PLASTIC);
@@ -104,6 +167,8 @@ static int runApp(QApplication* app)
     settings->setDefaultValue(Keys::Gui_ClipPlaneCappingHatch, Aspect_HS_SOLID);
     settings->setDefaultValue(Keys::Gui_ClipPlaneCappingOn, true);
     settings->setDefaultValue(Keys::Gui_DefaultShowOriginTrihedron, true);
+    settings->setDefaultValue(Keys::Gui_ShowFrameStats, false);
+    settings->setDefaultValue(Keys::Gui_TargetFrameTime, 33); // ms
 
     {
         auto fnUpdateDefaults = [=]{
@@ -131,18 +196,111 @@ static int runApp(QApplication* app)
             GpxXdeDocumentItem::DefaultValues defaults;
             defaults.color = settings->valueAs<QColor>(Keys::Gpx_BrepShapeDefaultColor);
             defaults.material = settings->valueAsEnum<Graphic3d_NameOfMaterial>(Keys::Gpx_BrepShapeDefaultMaterial);
+            defaults.instancing = settings->valueAs<bool>(Keys::Gpx_BrepShapeDefaultInstancing);
             GpxXdeDocumentItem::setDefaultValues(defaults);
         };
         fnUpdateDefaults();
         QObject::connect(Settings::instance(), &Settings::valueChanged, [=](const QString& key) {
             if (key == Keys::Gpx_BrepShapeDefaultColor
-                    || key == Keys::Gpx_BrepShapeDefaultMaterial)
+                    || key == Keys::Gpx_BrepShapeDefaultMaterial
+                    || key == Keys::Gpx_BrepShapeDefaultInstancing)
             {
                 fnUpdateDefaults();
             }
         });
     }
 
+    {
+        auto fnUpdateStlIoLibrary = [=]{
+            Application::instance()->setStlIoLibrary(
+                        settings->valueAsEnum<Application::StlIoLibrary>(Keys::Base_StlIoLibrary));
+        };
+        fnUpdateStlIoLibrary();
+        QObject::connect(Settings::instance(), &Settings::valueChanged, [=](const QString& key) {
+            if (key == Keys::Base_StlIoLibrary)
+                fnUpdateStlIoLibrary();
+        });
+    }
+
+    {
+        auto fnUpdateConcurrentImport = [=]{
+            Application::instance()->setConcurrentImportEnabled(
+                        settings->valueAs<bool>(Keys::Base_ConcurrentImportEnabled));
+        };
+        fnUpdateConcurrentImport();
+        QObject::connect(Settings::instance(), &Settings::valueChanged, [=](const QString& key) {
+            if (key == Keys::Base_ConcurrentImportEnabled)
+                fnUpdateConcurrentImport();
+        });
+    }
+
+    {
+        auto fnUpdateMeshingParameters = [=]{
+            Application::MeshingParameters params;
+            params.enabled = settings->valueAs<bool>(Keys::Base_MeshingEnabled);
+            params.deviationCoefficient = settings->valueAs<double>(Keys::Base_MeshingDeviationCoefficient);
+            params.angularDeflection =
+                    settings->valueAs<double>(Keys::Base_MeshingAngularDeflection) * Quantity_Degree;
+            Application::instance()->setMeshingParameters(params);
+        };
+        fnUpdateMeshingParameters();
+        QObject::connect(Settings::instance(), &Settings::valueChanged, [=](const QString& key) {
+            if (key == Keys::Base_MeshingEnabled
+                    || key == Keys::Base_MeshingDeviationCoefficient
+                    || key == Keys::Base_MeshingAngularDeflection)
+            {
+                fnUpdateMeshingParameters();
+            }
+        });
+    }
+
+    {
+        auto fnUpdateTessellationCache = [=]{
+            TessellationCache* cache = Application::instance()->tessellationCache();
+            cache->setDirectory(settings->valueAs<QString>(Keys::Base_TessellationCacheDirectory));
+            cache->setEnabled(settings->valueAs<bool>(Keys::Base_TessellationCacheEnabled));
+            cache->setMaxSize(settings->valueAs<qint64>(Keys::Base_TessellationCacheMaxSize) * 1024 * 1024);
+        };
+        fnUpdateTessellationCache();
+        QObject::connect(Settings::instance(), &Settings::valueChanged, [=](const QString& key) {
+            if (key == Keys::Base_TessellationCacheDirectory
+                    || key == Keys::Base_TessellationCacheEnabled
+                    || key == Keys::Base_TessellationCacheMaxSize)
+            {
+                fnUpdateTessellationCache();
+            }
+        });
+    }
+}
+
+static int runConvert()
+{
+    const CommandLineArguments args = processCommandLine();
+    initApplication();
+    const BatchConvert::JobsResult jobs = BatchConvert::createJobs(
+                args.listFileToConvert, args.convertOutputPath, args.convertOutputFormat);
+    if (!jobs) {
+        const QString errorText = Main::tr("ERROR: %1").arg(jobs.errorText());
+        std::cerr << qUtf8Printable(errorText) << std::endl;
+        return BatchConvert::ExitInvalidArguments;
+    }
+
+    return BatchConvert::run(jobs.get(), args.convertJobCount);
+}
+
+static int runApp(QApplication* app)
+{
+    const CommandLineArguments args = processCommandLine();
+    initApplication();
+
+    // Register Gpx factory functions
+    GpxDocumentItemFactory::instance()->registerCreatorFunction(
+                XdeDocumentItem::TypeName,
+                &GpxDocumentItemFactory::createGpx<XdeDocumentItem, GpxXdeDocumentItem>);
+    GpxDocumentItemFactory::instance()->registerCreatorFunction(
+                MeshItem::TypeName,
+                &GpxDocumentItemFactory::createGpx<MeshItem, GpxMeshItem>);
+
     // Register WidgetModelTreeBuilter prototypes
     WidgetModelTree::addPrototypeBuilder(new WidgetModelTreeBuilder_Mesh);
     WidgetModelTree::addPrototypeBuilder(new WidgetModelTreeBuilder_Xde);
@@ -174,9 +332,19 @@ static int runApp(QApplication* app)
 
 int main(int argc, char* argv[])
 {
+    QCoreApplication::setOrganizationName("Fougue Ltd");
+    QCoreApplication::setOrganizationDomain("www.fougue.pro");
+    QCoreApplication::setApplicationName("Mayo");
+
+    // Headless conversion mode, must not require any GUI support(display, OpenGL)
+    const bool isConvertMode = std::any_of(argv + 1, argv + argc, [](const char* arg) {
+        return std::strcmp(arg, "--convert") == 0 || std::strncmp(arg, "--convert=", 10) == 0;
+    });
+    if (isConvertMode) {
+        QCoreApplication app(argc, argv);
+        return Mayo::runConvert();
+    }
+
     QApplication app(argc, argv);
-    QApplication::setOrganizationName("Fougue Ltd");
-    QApplication::setOrganizationDomain("www.fougue.pro");
-    QApplication::setApplicationName("Mayo");
     return Mayo::runApp(&app);
 }
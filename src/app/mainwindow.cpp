@@ -11,6 +11,7 @@
 #include "../base/application_item_selection_model.h"
 #include "../base/document.h"
 #include "../base/document_item.h"
+#include "../base/os_utils.h"
 #include "../base/xde_document_item.h"
 #include "../gpx/gpx_utils.h"
 #include "../gui/gui_application.h"
@@ -39,11 +40,13 @@
 #include <fougtools/qttools/gui/item_view_buttons.h>
 #include <fougtools/qttools/gui/qwidget_utils.h>
 #include <fougtools/qttools/task/manager.h>
+#include <fougtools/qttools/task/runner_scheduler.h>
 #include <fougtools/qttools/task/runner_stdasync.h>
 
 #include <QtCore/QMimeData>
 #include <QtCore/QTime>
 #include <QtCore/QSettings>
+#include <QtCore/QThread>
 #include <QtGui/QDesktopServices>
 #include <QtGui/QDragEnterEvent>
 #include <QtGui/QDropEvent>
@@ -160,12 +163,55 @@ static void prependRecentFile(QStringList* listRecentFile, const QString& filepa
         listRecentFile->pop_back();
 }
 
+// Imports already run parallel algorithms(meshing, STL decoding, ...) so only
+// a few files are imported at the same time
+static int importWorkerCount()
+{
+    return qBound(1, QThread::idealThreadCount() / 4, 3);
+}
+
+// Imports in progress are allowed to use half of the physical memory
+static quint64 importMemoryBudget()
+{
+    const qint64 memSize = OsUtils::physicalMemorySize();
+    return memSize > 0 ? static_cast<quint64>(memSize / 2) : 0;
+}
+
+// Rough estimation of the memory needed to import a file, based on its size
+static quint64 importMemoryCost(Application::PartFormat format, const QString& filepath)
+{
+    const double fileSize = QFileInfo(filepath).size();
+    switch (format) {
+    case Application::PartFormat::Iges:
+    case Application::PartFormat::Step:
+        // Entity model, then shapes along with their triangulations
+        return static_cast<quint64>(10 * fileSize);
+    case Application::PartFormat::OccBrep:
+        return static_cast<quint64>(4 * fileSize);
+    case Application::PartFormat::Stl:
+        // Triangulation and its graphics buffers
+        return static_cast<quint64>(2 * fileSize);
+    case Application::PartFormat::Unknown:
+        break;
+    }
+
+    return static_cast<quint64>(fileSize);
+}
+
+// Queued imports targeting the visible document are started first
+static int importTaskPriority(const Document* doc, const Document* currentDoc)
+{
+    return doc == currentDoc ? 1 : 0;
+}
+
 } // namespace Internal
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
       m_ui(new Ui_MainWindow),
-      m_listRecentFile(Settings::instance()->valueAs<QStringList>(Keys::App_RecentFiles))
+      m_listRecentFile(Settings::instance()->valueAs<QStringList>(Keys::App_RecentFiles)),
+      m_importScheduler(new qttask::Scheduler(
+                            Internal::importWorkerCount(), Internal::importMemoryBudget()))
 {
     m_ui->setupUi(this);
     m_ui->widget_ModelTree->loadConfiguration(Settings::instance(), "GUI/MainWindow");
@@ -331,6 +377,9 @@ MainWindow::MainWindow(QWidget *parent)
     QObject::connect(
                 this, &MainWindow::operationFinished,
                 this, &MainWindow::onOperationFinished);
+    QObject::connect(
+                qttask::Manager::globalInstance(), &qttask::Manager::ended,
+                this, [=](quint64 taskId) { m_hashImportTaskDoc.remove(taskId); });
 
     // Creation of annex objects
     {
@@ -378,6 +427,9 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // Queued imports are cancelled, running ones are asked to abort then waited for
+    this->abortImportTasks(nullptr);
+    m_importScheduler.reset();
     m_ui->widget_ModelTree->saveConfiguration(Settings::instance(), "GUI/MainWindow");
     delete m_ui;
     Settings::instance()->setValue(Keys::App_RecentFiles, m_listRecentFile);
@@ -485,19 +537,30 @@ void MainWindow::importInCurrentDoc()
 void MainWindow::runImportTask(
         Document* doc, Application::PartFormat format, const QString& filepath)
 {
-    auto task = qttask::Manager::globalInstance()->newTask<qttask::StdAsync>();
+    const WidgetGuiDocument* currentWidget = this->currentWidgetGuiDocument();
+    const Document* currentDoc = currentWidget ? currentWidget->guiDocument()->document() : nullptr;
+    auto task = qttask::Manager::globalInstance()->newTask<qttask::Scheduler>(
+                m_importScheduler.get(),
+                Internal::importTaskPriority(doc, currentDoc),
+                Internal::importMemoryCost(format, filepath));
     task->setTaskTitle(QFileInfo(filepath).fileName());
+    m_hashImportTaskDoc.insert(task->taskId(), doc);
     task->run([=]{
         QTime chrono;
         chrono.start();
+        Application::ImportInfo importInfo;
         const Application::IoResult result =
                 Application::instance()->importInDocument(
-                    doc, format, filepath, &task->progress());
+                    doc, format, filepath, &task->progress(), &importInfo);
         QString msg;
         if (result) {
             msg = tr("Import time '%1': %2ms")
                     .arg(QFileInfo(filepath).fileName())
                     .arg(chrono.elapsed());
+            if (importInfo.meshingTime >= 0)
+                msg += tr(" (meshing: %1ms)").arg(importInfo.meshingTime);
+            else if (importInfo.isFromCache)
+                msg += tr(" (from cache)");
         } else {
             msg = tr("Failed to import part:\n    %1\nError: %2")
                     .arg(filepath, result.errorText());
@@ -507,6 +570,23 @@ void MainWindow::runImportTask(
     });
 }
 
+void MainWindow::updateImportTaskPriorities()
+{
+    const WidgetGuiDocument* currentWidget = this->currentWidgetGuiDocument();
+    const Document* currentDoc = currentWidget ? currentWidget->guiDocument()->document() : nullptr;
+    for (auto it = m_hashImportTaskDoc.cbegin(); it != m_hashImportTaskDoc.cend(); ++it)
+        m_importScheduler->setPriority(it.key(), Internal::importTaskPriority(it.value(), currentDoc));
+}
+
+// Aborts import tasks targeting 'doc', or all import tasks if 'doc' is null
+void MainWindow::abortImportTasks(const Document* doc)
+{
+    for (auto it = m_hashImportTaskDoc.cbegin(); it != m_hashImportTaskDoc.cend(); ++it) {
+        if (!doc || it.value() == doc)
+            qttask::Manager::globalInstance()->requestAbort(it.key());
+    }
+}
+
 void MainWindow::runExportTask(
         Span<const ApplicationItem> appItems,
         Application::PartFormat format,
@@ -805,6 +885,7 @@ void MainWindow::onCurrentDocumentIndexChanged(int idx)
     m_ui->actionCloseDoc->setText(textActionClose);
     m_ui->actionCloseAllExcept->setText(textActionCloseAllExcept);
     m_ui->widget_FileSystem->setLocation(docFilePath);
+    this->updateImportTaskPriorities();
 
     if (this->currentWidgetGuiDocument()) {
         const GuiDocument* guiDoc = this->currentWidgetGuiDocument()->guiDocument();
@@ -841,6 +922,7 @@ void MainWindow::closeDocument(WidgetGuiDocument *widget)
 {
     if (widget) {
         Document* doc = widget->guiDocument()->document();
+        this->abortImportTasks(doc);
         m_ui->stack_GuiDocuments->removeWidget(widget);
         widget->deleteLater();
         Application::instance()->eraseDocument(doc);
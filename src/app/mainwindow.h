@@ -9,9 +9,11 @@
 #include "../base/application.h"
 #include "../base/application_item.h"
 #include "../base/application_item_selection_model.h"
+#include <QtCore/QHash>
 #include <QtWidgets/QMainWindow>
 #include <memory>
 class QFileInfo;
+namespace qttask { class Scheduler; }
 
 namespace Mayo {
 
@@ -73,6 +75,8 @@ private:
             Document* doc,
             Application::PartFormat format,
             const QString& filepath);
+    void updateImportTaskPriorities();
+    void abortImportTasks(const Document* doc);
     void runExportTask(
             Span<const ApplicationItem> appItems,
             Application::PartFormat format,
@@ -95,6 +99,8 @@ private:
     Qt::WindowStates m_previousWindowState = Qt::WindowNoState;
     QStringList m_listRecentFile;
     std::unique_ptr<PropertyOwnerSignals> m_ptrCurrentNodeProperties;
+    std::unique_ptr<qttask::Scheduler> m_importScheduler;
+    QHash<quint64, const Document*> m_hashImportTaskDoc;
 };
 
 } // namespace Mayo
@@ -0,0 +1,509 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "model_tree_model.h"
+
+#include "../base/application.h"
+#include "../base/document.h"
+#include "../base/document_item.h"
+#include "widget_model_tree_builder.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace Mayo {
+
+namespace Internal {
+
+// Internal id of a model index : slot of the entry in high bits, node id in low bits
+// On 32-bit platforms large node ids can't be packed, the low bits then hold
+// 'wideNodeIdFlag' and the index of the node id in a table of the entry
+constexpr int nodeIdBitCount = sizeof(quintptr) >= 8 ? 32 : 20;
+constexpr quintptr nodeIdMask = (quintptr(1) << nodeIdBitCount) - 1;
+constexpr quintptr wideNodeIdFlag = sizeof(quintptr) >= 8 ? 0 : quintptr(1) << (nodeIdBitCount - 1);
+constexpr int slotBitCount = 8 * sizeof(quintptr) - nodeIdBitCount;
+
+static_assert(sizeof(quintptr) < 8 || sizeof(TreeNodeId) <= 4, "TreeNodeId doesn't fit in low bits");
+
+static bool isWideNodeId(TreeNodeId nodeId)
+{
+    return wideNodeIdFlag != 0 && nodeId >= wideNodeIdFlag;
+}
+
+static quintptr toInternalId(int slot, quintptr nodeBits)
+{
+    Q_ASSERT(quintptr(slot) < (quintptr(1) << slotBitCount));
+    Q_ASSERT(nodeBits <= nodeIdMask);
+    return (quintptr(slot) << nodeIdBitCount) | nodeBits;
+}
+
+static int slotFromInternalId(quintptr id)
+{
+    return static_cast<int>(id >> nodeIdBitCount);
+}
+
+} // namespace Internal
+
+// Document or document item, nodes of the document item don't need entries
+struct ModelTreeModel::Entry {
+    int slot = -1;
+    Entry* parent = nullptr;
+    Document* doc = nullptr;
+    DocumentItem* docItem = nullptr;
+    WidgetModelTreeBuilder* builder = nullptr;
+    std::vector<Entry*> vecChild;
+    // Display texts of nodes, indexed by node id
+    std::vector<QString> vecNodeText;
+    // Node ids too large to be packed in internal ids (32-bit platforms only)
+    std::vector<TreeNodeId> vecWideNodeId;
+    std::unordered_map<TreeNodeId, quintptr> mapWideNodeIndex;
+};
+
+ModelTreeModel::ModelTreeModel(Span<WidgetModelTreeBuilder* const> spanBuilder, QObject* parent)
+    : QAbstractItemModel(parent),
+      m_vecBuilder(spanBuilder.begin(), spanBuilder.end())
+{
+    Q_ASSERT(!m_vecBuilder.empty());
+    auto app = Application::instance();
+    for (Document* doc : app->documents())
+        this->onDocumentAdded(doc);
+
+    QObject::connect(
+                app, &Application::documentAdded,
+                this, &ModelTreeModel::onDocumentAdded);
+    QObject::connect(
+                app, &Application::documentErased,
+                this, &ModelTreeModel::onDocumentErased);
+    QObject::connect(
+                app, &Application::documentPropertyChanged,
+                this, &ModelTreeModel::onDocumentPropertyChanged);
+    QObject::connect(
+                app, &Application::documentItemsAdded,
+                this, &ModelTreeModel::onDocumentItemsAdded);
+    QObject::connect(
+                app, &Application::documentItemErased,
+                this, &ModelTreeModel::onDocumentItemErased);
+    QObject::connect(
+                app, &Application::documentItemPropertyChanged,
+                this, &ModelTreeModel::onDocumentItemPropertyChanged);
+}
+
+ModelTreeModel::~ModelTreeModel()
+{
+}
+
+ApplicationItem ModelTreeModel::applicationItem(const QModelIndex& index) const
+{
+    const Entry* entry = this->entry(index);
+    if (!entry)
+        return ApplicationItem();
+
+    if (entry->doc)
+        return ApplicationItem(entry->doc);
+
+    const TreeNodeId nodeId = this->indexNodeId(index);
+    if (nodeId == 0)
+        return ApplicationItem(entry->docItem);
+
+    return ApplicationItem(DocumentItemNode(entry->docItem, nodeId));
+}
+
+QModelIndex ModelTreeModel::findIndex(const ApplicationItem& appItem) const
+{
+    if (appItem.isDocument())
+        return this->entryIndex(this->findEntry(appItem.document()));
+
+    Entry* entry = this->findEntry(appItem.documentItem());
+    if (!entry || !appItem.isDocumentItemNode())
+        return this->entryIndex(entry);
+
+    const TreeNodeId nodeId = appItem.documentItemNode().id;
+    const int row = entry->builder->nodeRow(entry->docItem, nodeId);
+    if (row < 0)
+        return QModelIndex();
+
+    return this->createIndex(row, 0, this->nodeInternalId(entry, nodeId));
+}
+
+void ModelTreeModel::refreshItemText(const ApplicationItem& appItem)
+{
+    if (appItem.isDocumentItemNode()) {
+        Entry* entry = this->findEntry(appItem.documentItem());
+        if (!entry)
+            return;
+
+        // Text of the parent node can depend on the node (eg referred shape
+        // merged in the node of its reference)
+        const TreeNodeId nodeId = appItem.documentItemNode().id;
+        const TreeNodeId parentNodeId = entry->builder->nodeParent(entry->docItem, nodeId);
+        for (TreeNodeId id : { nodeId, parentNodeId }) {
+            if (id == 0 || id >= entry->vecNodeText.size())
+                continue;
+
+            entry->vecNodeText.at(id) = QString();
+            const QModelIndex index = this->findIndex(DocumentItemNode(entry->docItem, id));
+            if (index.isValid())
+                emit this->dataChanged(index, index, { Qt::DisplayRole });
+        }
+    }
+    else {
+        const QModelIndex index = this->findIndex(appItem);
+        if (index.isValid())
+            emit this->dataChanged(index, index);
+    }
+}
+
+void ModelTreeModel::invalidateText()
+{
+    for (const std::unique_ptr<Entry>& ptrEntry : m_vecEntrySlot) {
+        if (ptrEntry)
+            ptrEntry->vecNodeText.clear();
+    }
+
+    emit this->layoutAboutToBeChanged();
+    emit this->layoutChanged();
+}
+
+QModelIndex ModelTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (!this->hasIndex(row, column, parent))
+        return QModelIndex();
+
+    if (!parent.isValid()) {
+        const Entry* entryDoc = m_vecDocumentEntry.at(row);
+        return this->createIndex(row, column, Internal::toInternalId(entryDoc->slot, 0));
+    }
+
+    Entry* entryParent = this->entry(parent);
+    if (entryParent->doc) {
+        const Entry* entryDocItem = entryParent->vecChild.at(row);
+        return this->createIndex(row, column, Internal::toInternalId(entryDocItem->slot, 0));
+    }
+
+    const TreeNodeId parentNodeId = this->indexNodeId(parent);
+    const TreeNodeId nodeId = entryParent->builder->nodeChild(entryParent->docItem, parentNodeId, row);
+    return this->createIndex(row, column, this->nodeInternalId(entryParent, nodeId));
+}
+
+QModelIndex ModelTreeModel::parent(const QModelIndex& index) const
+{
+    Entry* entry = this->entry(index);
+    if (!entry || entry->doc)
+        return QModelIndex();
+
+    const TreeNodeId nodeId = this->indexNodeId(index);
+    if (nodeId == 0)
+        return this->entryIndex(entry->parent);
+
+    const TreeNodeId parentNodeId = entry->builder->nodeParent(entry->docItem, nodeId);
+    if (parentNodeId == 0)
+        return this->entryIndex(entry);
+
+    const int row = entry->builder->nodeRow(entry->docItem, parentNodeId);
+    return this->createIndex(row, 0, this->nodeInternalId(entry, parentNodeId));
+}
+
+int ModelTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0)
+        return 0;
+
+    if (!parent.isValid())
+        return static_cast<int>(m_vecDocumentEntry.size());
+
+    const Entry* entry = this->entry(parent);
+    if (!entry)
+        return 0;
+
+    if (entry->doc)
+        return static_cast<int>(entry->vecChild.size());
+
+    const TreeNodeId nodeId = this->indexNodeId(parent);
+    return entry->builder->nodeChildCount(entry->docItem, nodeId);
+}
+
+int ModelTreeModel::columnCount(const QModelIndex&) const
+{
+    return 1;
+}
+
+QVariant ModelTreeModel::data(const QModelIndex& index, int role) const
+{
+    Entry* entry = this->entry(index);
+    if (!entry)
+        return QVariant();
+
+    const TreeNodeId nodeId = this->indexNodeId(index);
+    if (role == ItemTypeRole) {
+        if (entry->doc)
+            return ItemType_Document;
+        else
+            return nodeId == 0 ? ItemType_DocumentItem : ItemType_DocumentItemNode;
+    }
+
+    if (entry->doc)
+        return entry->builder->data(entry->doc, role);
+
+    if (nodeId == 0)
+        return entry->builder->data(entry->docItem, role);
+
+    const DocumentItemNode node(entry->docItem, nodeId);
+    if (role == Qt::DisplayRole) {
+        if (nodeId >= entry->vecNodeText.size())
+            entry->vecNodeText.resize(nodeId + 1);
+
+        QString& text = entry->vecNodeText.at(nodeId);
+        if (text.isNull())
+            text = entry->builder->data(node, role).toString();
+
+        return text;
+    }
+
+    return entry->builder->data(node, role);
+}
+
+bool ModelTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    return this->rowCount(parent) > 0 || this->canFetchMore(parent);
+}
+
+bool ModelTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    const Entry* entry = this->entry(parent);
+    if (!entry || entry->doc)
+        return false;
+
+    const TreeNodeId nodeId = this->indexNodeId(parent);
+    return entry->builder->canFetchMore(entry->docItem, nodeId);
+}
+
+void ModelTreeModel::fetchMore(const QModelIndex& parent)
+{
+    Entry* entry = this->entry(parent);
+    if (!entry || entry->doc)
+        return;
+
+    // Rows are announced before the builder populates them, so views never see
+    // the model ahead of the notification
+    const TreeNodeId nodeId = this->indexNodeId(parent);
+    const int fetchCount = entry->builder->fetchMoreCount(entry->docItem, nodeId);
+    if (fetchCount > 0) {
+        const int row = this->rowCount(parent);
+        this->beginInsertRows(parent, row, row + fetchCount - 1);
+        entry->builder->fetchMore(entry->docItem, nodeId);
+        Q_ASSERT(this->rowCount(parent) == row + fetchCount);
+        this->endInsertRows();
+    }
+    else {
+        entry->builder->fetchMore(entry->docItem, nodeId);
+    }
+}
+
+void ModelTreeModel::onDocumentAdded(Document* doc)
+{
+    if (this->findEntry(doc))
+        return;
+
+    const int row = static_cast<int>(m_vecDocumentEntry.size());
+    this->beginInsertRows(QModelIndex(), row, row);
+    Entry* entryDoc = this->createEntry(nullptr);
+    entryDoc->doc = doc;
+    entryDoc->builder = this->findSupportBuilder(doc);
+    m_vecDocumentEntry.push_back(entryDoc);
+    for (DocumentItem* docItem : doc->rootItems()) {
+        Entry* entryDocItem = this->createEntry(entryDoc);
+        entryDocItem->docItem = docItem;
+        entryDocItem->builder = this->findSupportBuilder(docItem);
+    }
+
+    this->endInsertRows();
+}
+
+void ModelTreeModel::onDocumentErased(const Document* doc)
+{
+    Entry* entryDoc = this->findEntry(doc);
+    if (!entryDoc)
+        return;
+
+    const int row = this->entryRow(entryDoc);
+    this->beginRemoveRows(QModelIndex(), row, row);
+    m_vecDocumentEntry.erase(m_vecDocumentEntry.begin() + row);
+    this->destroyEntry(entryDoc);
+    this->endRemoveRows();
+}
+
+void ModelTreeModel::onDocumentPropertyChanged(Document* doc, Property* prop)
+{
+    if (prop == &doc->propertyLabel || prop == &doc->propertyFilePath)
+        this->refreshItemText(ApplicationItem(doc));
+}
+
+void ModelTreeModel::onDocumentItemsAdded(Span<DocumentItem* const> spanDocItem)
+{
+    // Items of a batch belong to the same document, rows are inserted at once
+    std::vector<DocumentItem*> vecDocItem;
+    vecDocItem.reserve(spanDocItem.size());
+    for (DocumentItem* docItem : spanDocItem) {
+        if (!this->findEntry(docItem))
+            vecDocItem.push_back(docItem);
+    }
+
+    Entry* entryDoc = !vecDocItem.empty() ? this->findEntry(vecDocItem.front()->document()) : nullptr;
+    if (!entryDoc)
+        return;
+
+    const int row = static_cast<int>(entryDoc->vecChild.size());
+    const int rowLast = row + static_cast<int>(vecDocItem.size()) - 1;
+    this->beginInsertRows(this->entryIndex(entryDoc), row, rowLast);
+    for (DocumentItem* docItem : vecDocItem) {
+        Entry* entryDocItem = this->createEntry(entryDoc);
+        entryDocItem->docItem = docItem;
+        entryDocItem->builder = this->findSupportBuilder(docItem);
+    }
+
+    this->endInsertRows();
+}
+
+void ModelTreeModel::onDocumentItemErased(const DocumentItem* docItem)
+{
+    Entry* entryDocItem = this->findEntry(docItem);
+    if (!entryDocItem)
+        return;
+
+    Entry* entryDoc = entryDocItem->parent;
+    const int row = this->entryRow(entryDocItem);
+    this->beginRemoveRows(this->entryIndex(entryDoc), row, row);
+    entryDoc->vecChild.erase(entryDoc->vecChild.begin() + row);
+    this->destroyEntry(entryDocItem);
+    this->endRemoveRows();
+}
+
+void ModelTreeModel::onDocumentItemPropertyChanged(DocumentItem* docItem, Property* prop)
+{
+    if (prop == &docItem->propertyLabel)
+        this->refreshItemText(ApplicationItem(docItem));
+}
+
+ModelTreeModel::Entry* ModelTreeModel::createEntry(Entry* parent)
+{
+    auto itSlot = std::find(m_vecEntrySlot.begin(), m_vecEntrySlot.end(), nullptr);
+    if (itSlot == m_vecEntrySlot.end())
+        itSlot = m_vecEntrySlot.insert(m_vecEntrySlot.end(), nullptr);
+
+    itSlot->reset(new Entry);
+    Entry* entry = itSlot->get();
+    entry->slot = static_cast<int>(itSlot - m_vecEntrySlot.begin());
+    entry->parent = parent;
+    if (parent)
+        parent->vecChild.push_back(entry);
+
+    return entry;
+}
+
+void ModelTreeModel::destroyEntry(Entry* entry)
+{
+    for (Entry* child : entry->vecChild)
+        this->destroyEntry(child);
+
+    m_vecEntrySlot.at(entry->slot).reset();
+}
+
+ModelTreeModel::Entry* ModelTreeModel::entry(const QModelIndex& index) const
+{
+    if (!index.isValid() || index.model() != this)
+        return nullptr;
+
+    const int slot = Internal::slotFromInternalId(index.internalId());
+    return slot < static_cast<int>(m_vecEntrySlot.size()) ? m_vecEntrySlot.at(slot).get() : nullptr;
+}
+
+TreeNodeId ModelTreeModel::indexNodeId(const QModelIndex& index) const
+{
+    const quintptr nodeBits = index.internalId() & Internal::nodeIdMask;
+    if (Internal::wideNodeIdFlag == 0 || nodeBits < Internal::wideNodeIdFlag)
+        return static_cast<TreeNodeId>(nodeBits);
+
+    const Entry* entry = this->entry(index);
+    const quintptr wideIndex = nodeBits & ~Internal::wideNodeIdFlag;
+    return entry && wideIndex < entry->vecWideNodeId.size() ? entry->vecWideNodeId.at(wideIndex) : 0;
+}
+
+quintptr ModelTreeModel::nodeInternalId(Entry* entry, TreeNodeId nodeId) const
+{
+    if (!Internal::isWideNodeId(nodeId))
+        return Internal::toInternalId(entry->slot, nodeId);
+
+    auto itFound = entry->mapWideNodeIndex.find(nodeId);
+    if (itFound == entry->mapWideNodeIndex.end()) {
+        const quintptr wideIndex = entry->vecWideNodeId.size();
+        itFound = entry->mapWideNodeIndex.emplace(nodeId, wideIndex).first;
+        entry->vecWideNodeId.push_back(nodeId);
+    }
+
+    Q_ASSERT(itFound->second < Internal::wideNodeIdFlag);
+    return Internal::toInternalId(entry->slot, Internal::wideNodeIdFlag | itFound->second);
+}
+
+ModelTreeModel::Entry* ModelTreeModel::findEntry(const Document* doc) const
+{
+    for (Entry* entryDoc : m_vecDocumentEntry) {
+        if (entryDoc->doc == doc)
+            return entryDoc;
+    }
+
+    return nullptr;
+}
+
+ModelTreeModel::Entry* ModelTreeModel::findEntry(const DocumentItem* docItem) const
+{
+    if (!docItem)
+        return nullptr;
+
+    for (Entry* entryDoc : m_vecDocumentEntry) {
+        for (Entry* entryDocItem : entryDoc->vecChild) {
+            if (entryDocItem->docItem == docItem)
+                return entryDocItem;
+        }
+    }
+
+    return nullptr;
+}
+
+QModelIndex ModelTreeModel::entryIndex(const Entry* entry) const
+{
+    if (!entry)
+        return QModelIndex();
+
+    return this->createIndex(this->entryRow(entry), 0, Internal::toInternalId(entry->slot, 0));
+}
+
+int ModelTreeModel::entryRow(const Entry* entry) const
+{
+    const std::vector<Entry*>& vecSibling =
+            entry->parent ? entry->parent->vecChild : m_vecDocumentEntry;
+    auto itFound = std::find(vecSibling.cbegin(), vecSibling.cend(), entry);
+    return itFound != vecSibling.cend() ? static_cast<int>(itFound - vecSibling.cbegin()) : -1;
+}
+
+WidgetModelTreeBuilder* ModelTreeModel::findSupportBuilder(const Document* doc) const
+{
+    auto it = std::find_if(
+                std::next(m_vecBuilder.cbegin()),
+                m_vecBuilder.cend(),
+                [=](WidgetModelTreeBuilder* builder) { return builder->supports(doc); });
+    return it != m_vecBuilder.cend() ? *it : m_vecBuilder.front();
+}
+
+WidgetModelTreeBuilder* ModelTreeModel::findSupportBuilder(const DocumentItem* docItem) const
+{
+    auto it = std::find_if(
+                std::next(m_vecBuilder.cbegin()),
+                m_vecBuilder.cend(),
+                [=](WidgetModelTreeBuilder* builder) { return builder->supports(docItem); });
+    return it != m_vecBuilder.cend() ? *it : m_vecBuilder.front();
+}
+
+} // namespace Mayo
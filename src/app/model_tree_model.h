@@ -0,0 +1,86 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/application_item.h"
+#include "../base/span.h"
+
+#include <QtCore/QAbstractItemModel>
+#include <memory>
+#include <vector>
+
+namespace Mayo {
+
+class Property;
+class WidgetModelTreeBuilder;
+
+// Item model of the documents, document items and their nodes
+// No object is allocated per node : a model index holds the id of a node in the
+// tree of its document item, contents are provided on demand by builders
+class ModelTreeModel : public QAbstractItemModel {
+public:
+    enum Role {
+        ItemTypeRole = Qt::UserRole + 1
+    };
+
+    enum ItemType {
+        ItemType_Unknown = 0,
+        ItemType_Document = 1,
+        ItemType_DocumentItem = 2,
+        ItemType_DocumentItemNode = 3
+    };
+
+    // First builder is the fallback one, builders are not owned
+    ModelTreeModel(Span<WidgetModelTreeBuilder* const> spanBuilder, QObject* parent = nullptr);
+    ~ModelTreeModel();
+
+    ApplicationItem applicationItem(const QModelIndex& index) const;
+    // Returns a null index if 'appItem' isn't part of the model (eg node not fetched yet)
+    QModelIndex findIndex(const ApplicationItem& appItem) const;
+
+    void refreshItemText(const ApplicationItem& appItem);
+    // Cached texts are discarded, to be called when presentation of nodes changed
+    void invalidateText();
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& index) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    struct Entry;
+
+    void onDocumentAdded(Document* doc);
+    void onDocumentErased(const Document* doc);
+    void onDocumentPropertyChanged(Document* doc, Property* prop);
+    void onDocumentItemsAdded(Span<DocumentItem* const> spanDocItem);
+    void onDocumentItemErased(const DocumentItem* docItem);
+    void onDocumentItemPropertyChanged(DocumentItem* docItem, Property* prop);
+
+    Entry* createEntry(Entry* parent);
+    void destroyEntry(Entry* entry);
+    Entry* entry(const QModelIndex& index) const;
+    TreeNodeId indexNodeId(const QModelIndex& index) const;
+    quintptr nodeInternalId(Entry* entry, TreeNodeId nodeId) const;
+    Entry* findEntry(const Document* doc) const;
+    Entry* findEntry(const DocumentItem* docItem) const;
+    QModelIndex entryIndex(const Entry* entry) const;
+    int entryRow(const Entry* entry) const;
+
+    WidgetModelTreeBuilder* findSupportBuilder(const Document* doc) const;
+    WidgetModelTreeBuilder* findSupportBuilder(const DocumentItem* docItem) const;
+
+    std::vector<WidgetModelTreeBuilder*> m_vecBuilder;
+    std::vector<std::unique_ptr<Entry>> m_vecEntrySlot;
+    std::vector<Entry*> m_vecDocumentEntry;
+};
+
+} // namespace Mayo
@@ -13,10 +13,18 @@ const char App_RecentFiles[] = "App/RecentFiles";
 const char App_MainWindowLastOpenDir[] = "App/MainWindowLastOpenDir";
 const char App_MainWindowLastSelectedFilter[] = "App/MainWindowLastSelectedFilter";
 const char App_MainWindowLinkWithDocumentSelector[] = "App/MainWindowLinkWithDocumentSelector";
+const char Base_ConcurrentImportEnabled[] = "Base/ConcurrentImportEnabled";
+const char Base_MeshingAngularDeflection[] = "Base/MeshingAngularDeflection";
+const char Base_MeshingDeviationCoefficient[] = "Base/MeshingDeviationCoefficient";
+const char Base_MeshingEnabled[] = "Base/MeshingEnabled";
 const char Base_StlIoLibrary[] = "Base/stlIoLibrary";
+const char Base_TessellationCacheDirectory[] = "Base/TessellationCacheDirectory";
+const char Base_TessellationCacheEnabled[] = "Base/TessellationCacheEnabled";
+const char Base_TessellationCacheMaxSize[] = "Base/TessellationCacheMaxSize";
 const char Base_UnitSystemDecimals[] = "Base/UnitSystemDecimals";
 const char Base_UnitSystemSchema[] = "Base/UnitSystemSchema";
 const char Gpx_BrepShapeDefaultColor[] = "Gpx/BRepShapeDefaultColor";
+const char Gpx_BrepShapeDefaultInstancing[] = "Gpx/BRepShapeDefaultInstancing";
 const char Gpx_BrepShapeDefaultMaterial[] = "Gpx/BRepShapeDefaultMaterial";
 const char Gpx_MeshDefaultColor[] = "Gpx/MeshDefaultColor";
 const char Gpx_MeshDefaultMaterial[] = "Gpx/MeshDefaultMaterial";
@@ -25,6 +33,8 @@ const char Gpx_MeshDefaultShowNodes[] = "Gpx/MeshDefaultShowNodes";
 const char Gui_ClipPlaneCappingHatch[] = "Gui/ClipPlaneCappingHatch";
 const char Gui_ClipPlaneCappingOn[] = "Gui/ClipPlaneCappingOn";
 const char Gui_DefaultShowOriginTrihedron[] = "Gui/defaultShowOriginTrihedron";
+const char Gui_ShowFrameStats[] = "Gui/ShowFrameStats";
+const char Gui_TargetFrameTime[] = "Gui/TargetFrameTime";
 
 } // namespace Keys
 } // namespace Mayo
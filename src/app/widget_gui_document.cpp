@@ -8,8 +8,11 @@
 
 #include "../gpx/gpx_utils.h"
 #include "../gpx/v3d_view_camera_animation.h"
+#include "../gpx/v3d_view_quality_controller.h"
 #include "../gui/gui_document.h"
 #include "button_flat.h"
+#include "settings.h"
+#include "settings_keys.h"
 #include "theme.h"
 #include "widget_clip_planes.h"
 #include "widget_occ_view.h"
@@ -18,6 +21,7 @@
 #include <fougtools/qttools/gui/qwidget_utils.h>
 #include <QtGui/QPainter>
 #include <QtWidgets/QBoxLayout>
+#include <QtWidgets/QLabel>
 
 namespace Mayo {
 
@@ -59,9 +63,22 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
       m_guiDoc(guiDoc),
       m_qtOccView(new WidgetOccView(guiDoc->v3dView(), this)),
       m_controller(new WidgetOccViewController(m_qtOccView)),
-      m_cameraAnimation(new V3dViewCameraAnimation(guiDoc->v3dView(), this))
+      m_cameraAnimation(new V3dViewCameraAnimation(guiDoc->v3dView(), this)),
+      m_qualityController(new V3dViewQualityController(guiDoc->v3dView(), this))
 {
     m_cameraAnimation->setEasingCurve(QEasingCurve::OutExpo);
+    const auto settings = Settings::instance();
+    m_qualityController->setTargetFrameTime(settings->valueAs<int>(Keys::Gui_TargetFrameTime));
+    m_qualityController->setMinFrameTime(V3dViewController::framePacingPeriod());
+    QObject::connect(
+                settings, &Settings::valueChanged,
+                this, [=](const QString& key, const QVariant& value) {
+        if (key == Keys::Gui_TargetFrameTime)
+            m_qualityController->setTargetFrameTime(value.toInt());
+        else if (key == Keys::Gui_ShowFrameStats)
+            this->setFrameStatsVisible(value.toBool());
+    });
+
     auto layout = new QVBoxLayout;
     layout->setContentsMargins(0, 0, 0, 0);
     layout->addWidget(m_qtOccView);
@@ -106,6 +123,26 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
     QObject::connect(
                 m_controller, &V3dViewController::viewScaled,
                 m_cameraAnimation, &V3dViewCameraAnimation::stop);
+    QObject::connect(
+                m_controller, &V3dViewController::dynamicActionStarted,
+                this, [=](V3dViewController::DynamicAction dynAction) {
+        using DynamicAction = V3dViewController::DynamicAction;
+        if (dynAction == DynamicAction::Rotation || dynAction == DynamicAction::Panning) {
+            m_qualityController->beginInteraction();
+            m_guiDoc->enterReducedDetail();
+        }
+    });
+    QObject::connect(
+                m_controller, &V3dViewController::frameRendered,
+                m_qualityController, &V3dViewQualityController::addFrameTime);
+    QObject::connect(
+                m_controller, &V3dViewController::dynamicActionEnded,
+                this, [=]{
+        m_qualityController->endInteraction();
+        m_guiDoc->restoreFullDetail(); // Redraws view at full quality
+        if (m_labelFrameStats)
+            this->updateFrameStats();
+    });
     QObject::connect(
                 btnEditClipping, &ButtonFlat::clicked,
                 this, &WidgetGuiDocument::toggleWidgetClipPlanes);
@@ -115,6 +152,8 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
     m_rectControls.setCoords(
                 rectFirstBtn.left(), rectFirstBtn.top(),
                 rectLastBtn.right(), rectLastBtn.bottom());
+
+    this->setFrameStatsVisible(settings->valueAs<bool>(Keys::Gui_ShowFrameStats));
 }
 
 GuiDocument* WidgetGuiDocument::guiDocument() const
@@ -152,6 +191,44 @@ void WidgetGuiDocument::connectViewProjButton(ButtonFlat* btn, V3d_TypeOfOrienta
     });
 }
 
+void WidgetGuiDocument::setFrameStatsVisible(bool on)
+{
+    if (on && !m_labelFrameStats) {
+        auto panel = new Internal::PanelView3d(this);
+        auto label = new QLabel(panel);
+        label->setMargin(Internal::widgetMargin);
+        qtgui::QWidgetUtils::addContentsWidget(panel, label);
+        m_labelFrameStats = label;
+        this->updateFrameStats();
+    }
+
+    if (m_labelFrameStats) {
+        QWidget* panel = m_labelFrameStats->parentWidget();
+        panel->setVisible(on);
+        const int margin = Internal::widgetMargin;
+        panel->move(m_rectControls.right() + 2 * margin, m_rectControls.top());
+    }
+}
+
+void WidgetGuiDocument::updateFrameStats()
+{
+    // Statistics of the last rotation or panning, input counters are
+    // accumulated since the view was created
+    const RenderQualityRegulator::Stats& stats = m_qualityController->stats();
+    const V3dViewController::FrameStats& inputStats = m_controller->frameStats();
+    m_labelFrameStats->setText(
+                tr("Frames: %1  Average: %2ms  Max: %3ms  Quality changes: %4\n"
+                   "Coalesced input events: %5  Input latency: %6ms (max %7ms)")
+                .arg(stats.frameCount)
+                .arg(stats.averageFrameTime_ms, 0, 'f', 1)
+                .arg(stats.maxFrameTime_ms, 0, 'f', 1)
+                .arg(stats.levelChangeCount)
+                .arg(inputStats.coalescedEventCount)
+                .arg(inputStats.lastInputLatency_ms, 0, 'f', 1)
+                .arg(inputStats.maxInputLatency_ms, 0, 'f', 1));
+    m_labelFrameStats->parentWidget()->adjustSize();
+}
+
 void WidgetGuiDocument::toggleWidgetClipPlanes()
 {
     if (!m_widgetClipPlanes) {
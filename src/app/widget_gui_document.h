@@ -8,6 +8,7 @@
 
 #include <QtWidgets/QWidget>
 #include <V3d_TypeOfOrientation.hxx>
+class QLabel;
 
 namespace Mayo {
 
@@ -15,6 +16,7 @@ class ButtonFlat;
 class GuiDocument;
 class V3dViewCameraAnimation;
 class V3dViewController;
+class V3dViewQualityController;
 class WidgetClipPlanes;
 class WidgetOccView;
 
@@ -33,12 +35,16 @@ public:
 private:
     void connectViewProjButton(ButtonFlat* btn, V3d_TypeOfOrientation proj);
     void toggleWidgetClipPlanes();
+    void setFrameStatsVisible(bool on);
+    void updateFrameStats();
 
     GuiDocument* m_guiDoc = nullptr;
     WidgetOccView* m_qtOccView = nullptr;
     V3dViewController* m_controller = nullptr;
     V3dViewCameraAnimation* m_cameraAnimation = nullptr;
+    V3dViewQualityController* m_qualityController = nullptr;
     WidgetClipPlanes* m_widgetClipPlanes = nullptr;
+    QLabel* m_labelFrameStats = nullptr;
     QRect m_rectControls;
 };
 
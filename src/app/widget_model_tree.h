@@ -8,14 +8,14 @@
 
 #include "../base/application_item.h"
 #include "../base/property.h"
+#include "../base/span.h"
 
 #include <QtWidgets/QWidget>
 class QItemSelection;
-class QTreeWidget;
-class QTreeWidgetItem;
 
 namespace Mayo {
 
+class ModelTreeModel;
 class Settings;
 class WidgetModelTreeBuilder;
 
@@ -37,35 +37,15 @@ public:
     // For builders
     static void addPrototypeBuilder(WidgetModelTreeBuilder* builder);
 
-    static DocumentItemNode documentItemNode(const QTreeWidgetItem* treeItem);
-    static void setDocumentItemNode(QTreeWidgetItem* treeItem, const DocumentItemNode& node);
-
-    static bool holdsDocument(const QTreeWidgetItem* treeItem);
-    static bool holdsDocumentItem(const QTreeWidgetItem* treeItem);
-    static bool holdsDocumentItemNode(const QTreeWidgetItem* treeItem);
-
 private:
-    void onDocumentAdded(Document* doc);
-    void onDocumentErased(const Document* doc);
-    void onDocumentPropertyChanged(Document* doc, Property* prop);
-    void onDocumentItemAdded(DocumentItem* docItem);
-    void onDocumentItemErased(const DocumentItem* docItem);
-    void onDocumentItemPropertyChanged(DocumentItem* docItem, Property* prop);
+    void onDocumentItemsAdded(Span<DocumentItem* const> spanDocItem);
 
-    void onTreeWidgetDocumentSelectionChanged(
+    void onTreeViewDocumentSelectionChanged(
             const QItemSelection& selected, const QItemSelection& deselected);
 
-    QTreeWidgetItem* loadDocumentItem(DocumentItem* docItem);
-
-    QTreeWidgetItem* findTreeItem(const Document* doc) const;
-    QTreeWidgetItem* findTreeItem(const DocumentItem* docItem) const;
-
-    WidgetModelTreeBuilder* findSupportBuilder(const Document* doc) const;
-    WidgetModelTreeBuilder* findSupportBuilder(const DocumentItem* docItem) const;
-
     class Ui_WidgetModelTree* m_ui = nullptr;
     std::vector<WidgetModelTreeBuilder*> m_vecBuilder;
-    QString m_refItemTextTemplate;
+    ModelTreeModel* m_model = nullptr;
 };
 
 } // namespace Mayo
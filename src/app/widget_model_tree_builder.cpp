@@ -11,8 +11,7 @@
 #include "widget_model_tree.h"
 #include "theme.h"
 
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItem>
+#include <QtGui/QIcon>
 
 namespace Mayo {
 
@@ -20,33 +19,62 @@ WidgetModelTreeBuilder::~WidgetModelTreeBuilder()
 {
 }
 
-void WidgetModelTreeBuilder::refreshTextTreeItem(
-        const Document* doc, QTreeWidgetItem* treeItem)
+QVariant WidgetModelTreeBuilder::data(const Document* doc, int role) const
 {
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(doc->propertyLabel));
+    switch (role) {
+    case Qt::DisplayRole: return WidgetModelTreeBuilder::labelText(doc->propertyLabel);
+    case Qt::DecorationRole: return mayoTheme()->icon(Theme::Icon::File);
+    case Qt::ToolTipRole: return doc->filePath();
+    }
+
+    return QVariant();
+}
+
+QVariant WidgetModelTreeBuilder::data(const DocumentItem* docItem, int role) const
+{
+    if (role == Qt::DisplayRole)
+        return WidgetModelTreeBuilder::labelText(docItem->propertyLabel);
+
+    return QVariant();
+}
+
+QVariant WidgetModelTreeBuilder::data(const DocumentItemNode&, int) const
+{
+    return QVariant();
+}
+
+int WidgetModelTreeBuilder::nodeChildCount(DocumentItem*, TreeNodeId) const
+{
+    return 0;
+}
+
+TreeNodeId WidgetModelTreeBuilder::nodeChild(DocumentItem*, TreeNodeId, int) const
+{
+    return 0;
+}
+
+TreeNodeId WidgetModelTreeBuilder::nodeParent(DocumentItem*, TreeNodeId) const
+{
+    return 0;
 }
 
-void WidgetModelTreeBuilder::refreshTextTreeItem(
-        const DocumentItem* docItem, QTreeWidgetItem* treeItem)
+int WidgetModelTreeBuilder::nodeRow(DocumentItem*, TreeNodeId) const
 {
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(docItem->propertyLabel));
+    return -1;
 }
 
-void WidgetModelTreeBuilder::refreshTextTreeItem(
-        const DocumentItemNode&, QTreeWidgetItem*)
+bool WidgetModelTreeBuilder::canFetchMore(DocumentItem*, TreeNodeId) const
 {
+    return false;
 }
 
-void WidgetModelTreeBuilder::fillTreeItem(QTreeWidgetItem* treeItem, Document* doc)
+int WidgetModelTreeBuilder::fetchMoreCount(DocumentItem*, TreeNodeId) const
 {
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(doc->propertyLabel));
-    treeItem->setIcon(0, mayoTheme()->icon(Theme::Icon::File));
-    treeItem->setToolTip(0, doc->filePath());
+    return 0;
 }
 
-void WidgetModelTreeBuilder::fillTreeItem(QTreeWidgetItem* treeItem, DocumentItem* docItem)
+void WidgetModelTreeBuilder::fetchMore(DocumentItem*, TreeNodeId)
 {
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(docItem->propertyLabel));
 }
 
 void WidgetModelTreeBuilder::loadConfiguration(const Settings*, const QString&)
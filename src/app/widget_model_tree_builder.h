@@ -6,21 +6,25 @@
 
 #pragma once
 
+#include "../base/libtree.h"
 #include "../base/property_builtins.h"
 #include <vector>
 #include <QtCore/QString>
+#include <QtCore/QVariant>
 class QAction;
 class QObject;
-class QTreeWidget;
-class QTreeWidgetItem;
 
 namespace Mayo {
 
 class Document;
 class DocumentItem;
 struct DocumentItemNode;
+class ModelTreeModel;
 class Settings;
 
+// Provides the contents of ModelTreeModel for a kind of document or document item
+// Nodes below a document item are designated by their tree id, the null id
+// designates the document item itself
 // TODO Rename Builder -> Extension ?
 class WidgetModelTreeBuilder {
 public:
@@ -29,15 +33,24 @@ public:
     virtual bool supports(const Document*) const { return true; }
     virtual bool supports(const DocumentItem*) const { return true; }
 
-    virtual void refreshTextTreeItem(const Document* doc, QTreeWidgetItem* treeItem);
-    virtual void refreshTextTreeItem(const DocumentItem* docItem, QTreeWidgetItem* treeItem);
-    virtual void refreshTextTreeItem(const DocumentItemNode& node, QTreeWidgetItem* treeItemDocItem);
+    virtual QVariant data(const Document* doc, int role) const;
+    virtual QVariant data(const DocumentItem* docItem, int role) const;
+    virtual QVariant data(const DocumentItemNode& node, int role) const;
 
-    virtual void fillTreeItem(QTreeWidgetItem* treeItem, Document* doc);
-    virtual void fillTreeItem(QTreeWidgetItem* treeItem, DocumentItem* docItem);
+    virtual int nodeChildCount(DocumentItem* docItem, TreeNodeId nodeId) const;
+    virtual TreeNodeId nodeChild(DocumentItem* docItem, TreeNodeId nodeId, int row) const;
+    virtual TreeNodeId nodeParent(DocumentItem* docItem, TreeNodeId nodeId) const;
+    virtual int nodeRow(DocumentItem* docItem, TreeNodeId nodeId) const;
 
-    QTreeWidget* treeWidget() const { return m_treeWidget; }
-    void setTreeWidget(QTreeWidget* tree) { m_treeWidget = tree; }
+    // Lazy population of children, called when a node is about to be expanded
+    virtual bool canFetchMore(DocumentItem* docItem, TreeNodeId nodeId) const;
+    // Count of the children fetchMore() is about to add, known before population
+    // so the model can announce the rows first
+    virtual int fetchMoreCount(DocumentItem* docItem, TreeNodeId nodeId) const;
+    virtual void fetchMore(DocumentItem* docItem, TreeNodeId nodeId);
+
+    ModelTreeModel* model() const { return m_model; }
+    void setModel(ModelTreeModel* model) { m_model = model; }
 
     virtual void loadConfiguration(const Settings* settings, const QString& keyGroup);
     virtual void saveConfiguration(Settings* settings, const QString& keyGroup);
@@ -50,7 +63,7 @@ protected:
     static QString labelText(const PropertyQString& propLabel);
 
 private:
-    QTreeWidget* m_treeWidget = nullptr;
+    ModelTreeModel* m_model = nullptr;
 };
 
 } // namespace Mayo
@@ -8,9 +8,8 @@
 
 #include "../base/mesh_item.h"
 #include "theme.h"
-#include "widget_model_tree.h"
 
-#include <QtWidgets/QTreeWidgetItem>
+#include <QtGui/QIcon>
 
 namespace Mayo {
 
@@ -19,11 +18,13 @@ bool WidgetModelTreeBuilder_Mesh::supports(const DocumentItem* docItem) const
     return sameType<MeshItem>(docItem);
 }
 
-void WidgetModelTreeBuilder_Mesh::fillTreeItem(QTreeWidgetItem* treeItem, DocumentItem* docItem)
+QVariant WidgetModelTreeBuilder_Mesh::data(const DocumentItem* docItem, int role) const
 {
-    WidgetModelTreeBuilder::fillTreeItem(treeItem, docItem);
     Q_ASSERT(this->supports(docItem));
-    treeItem->setIcon(0, mayoTheme()->icon(Theme::Icon::ItemMesh));
+    if (role == Qt::DecorationRole)
+        return mayoTheme()->icon(Theme::Icon::ItemMesh);
+
+    return WidgetModelTreeBuilder::data(docItem, role);
 }
 
 WidgetModelTreeBuilder* WidgetModelTreeBuilder_Mesh::clone() const
@@ -13,7 +13,7 @@ namespace Mayo {
 class WidgetModelTreeBuilder_Mesh : public WidgetModelTreeBuilder {
 public:
     bool supports(const DocumentItem* docItem) const override;
-    void fillTreeItem(QTreeWidgetItem* treeItem, DocumentItem* docItem) override;
+    QVariant data(const DocumentItem* docItem, int role) const override;
 
     WidgetModelTreeBuilder* clone() const override;
 };
@@ -1,16 +1,11 @@
 #include "widget_model_tree_builder_xde.h"
 
 #include "../base/xde_document_item.h"
+#include "model_tree_model.h"
 #include "settings.h"
 #include "theme.h"
-#include "widget_model_tree.h"
 
 #include <QtWidgets/QActionGroup>
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItemIterator>
-
-#include <unordered_map>
-#include <unordered_set>
 
 namespace Mayo {
 
@@ -47,96 +42,110 @@ bool WidgetModelTreeBuilder_Xde::supports(const DocumentItem* docItem) const
     return sameType<XdeDocumentItem>(docItem);
 }
 
-void WidgetModelTreeBuilder_Xde::refreshTextTreeItem(
-        const DocumentItemNode& node, QTreeWidgetItem* treeItemDocItem)
+QVariant WidgetModelTreeBuilder_Xde::data(const DocumentItem* docItem, int role) const
 {
-    const TDF_Label labelNode = XdeDocumentItem::label(node);
-    TDF_LabelSequence seqLabelRefresh;
-    if (XdeDocumentItem::isShapeReference(labelNode)
-            && m_refItemTextTemplate.contains("%referred"))
-    {
-        XCAFDoc_ShapeTool::GetUsers(
-                    XdeDocumentItem::shapeReferred(labelNode),
-                    seqLabelRefresh,
-                    false /* don't get sub children */);
+    Q_ASSERT(this->supports(docItem));
+    if (role == Qt::DecorationRole)
+        return mayoTheme()->icon(Theme::Icon::ItemXde);
+
+    return ParentType::data(docItem, role);
+}
+
+QVariant WidgetModelTreeBuilder_Xde::data(const DocumentItemNode& node, int role) const
+{
+    auto xdeDocItem = static_cast<const XdeDocumentItem*>(node.documentItem);
+    const Tree<TDF_Label>& asmTree = xdeDocItem->assemblyTree();
+    const TreeNodeId contentNodeId = this->contentNodeId(xdeDocItem, node.id);
+    if (role == Qt::DisplayRole) {
+        const TDF_Label& nodeLabel = asmTree.nodeData(node.id);
+        if (contentNodeId != node.id)
+            return this->referenceItemText(nodeLabel, asmTree.nodeData(contentNodeId));
+
+        return XdeDocumentItem::findLabelName(nodeLabel);
     }
-    else {
-        seqLabelRefresh.Append(labelNode);
+    else if (role == Qt::DecorationRole) {
+        const QIcon icon = Internal::shapeIcon(asmTree.nodeData(contentNodeId));
+        return !icon.isNull() ? QVariant(icon) : QVariant();
     }
 
-    for (const TDF_Label& labelRefresh : seqLabelRefresh) {
-        QTreeWidgetItem* treeItemLabel = this->findTreeItem(treeItemDocItem, labelRefresh);
-        if (treeItemLabel)
-            this->refreshXdeAssemblyNodeItemText(treeItemLabel);
+    return QVariant();
+}
+
+int WidgetModelTreeBuilder_Xde::nodeChildCount(DocumentItem* docItem, TreeNodeId nodeId) const
+{
+    auto xdeDocItem = static_cast<const XdeDocumentItem*>(docItem);
+    const Tree<TDF_Label>& asmTree = xdeDocItem->assemblyTree();
+    if (nodeId == 0)
+        return static_cast<int>(asmTree.roots().size());
+
+    return asmTree.nodeChildCount(this->contentNodeId(xdeDocItem, nodeId));
+}
+
+TreeNodeId WidgetModelTreeBuilder_Xde::nodeChild(
+        DocumentItem* docItem, TreeNodeId nodeId, int row) const
+{
+    auto xdeDocItem = static_cast<const XdeDocumentItem*>(docItem);
+    const Tree<TDF_Label>& asmTree = xdeDocItem->assemblyTree();
+    if (nodeId == 0)
+        return asmTree.roots().at(row);
+
+    return asmTree.nodeChild(this->contentNodeId(xdeDocItem, nodeId), row);
+}
+
+TreeNodeId WidgetModelTreeBuilder_Xde::nodeParent(DocumentItem* docItem, TreeNodeId nodeId) const
+{
+    auto xdeDocItem = static_cast<const XdeDocumentItem*>(docItem);
+    const Tree<TDF_Label>& asmTree = xdeDocItem->assemblyTree();
+    const TreeNodeId parentNodeId = asmTree.nodeParent(nodeId);
+    // Parent can be a referred shape merged in the node of its reference
+    const TreeNodeId grandParentNodeId = asmTree.nodeParent(parentNodeId);
+    if (grandParentNodeId != 0
+            && this->contentNodeId(xdeDocItem, grandParentNodeId) == parentNodeId)
+    {
+        return grandParentNodeId;
     }
+
+    return parentNodeId;
 }
 
-void WidgetModelTreeBuilder_Xde::fillTreeItem(QTreeWidgetItem* treeItem, DocumentItem* docItem)
+int WidgetModelTreeBuilder_Xde::nodeRow(DocumentItem* docItem, TreeNodeId nodeId) const
 {
-    WidgetModelTreeBuilder::fillTreeItem(treeItem, docItem);
-    Q_ASSERT(this->supports(docItem));
-    treeItem->setIcon(0, mayoTheme()->icon(Theme::Icon::ItemXde));
-    auto xdeDocItem = static_cast<XdeDocumentItem*>(docItem);
-    this->buildXdeTree(treeItem, xdeDocItem);
+    auto xdeDocItem = static_cast<const XdeDocumentItem*>(docItem);
+    return xdeDocItem->assemblyTree().nodeSiblingIndex(nodeId);
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::guiCreateXdeTreeNode(
-        QTreeWidgetItem* guiParentNode, TreeNodeId nodeId, XdeDocumentItem* docItem)
+bool WidgetModelTreeBuilder_Xde::canFetchMore(DocumentItem* docItem, TreeNodeId nodeId) const
 {
-    auto guiNode = new QTreeWidgetItem(guiParentNode);
-    const QString stdName = docItem->findLabelName(nodeId);
-    guiNode->setText(0, stdName);
-    WidgetModelTree::setDocumentItemNode(guiNode, DocumentItemNode(docItem, nodeId));
-    const QIcon icon = Internal::shapeIcon(docItem->assemblyTree().nodeData(nodeId));
-    if (!icon.isNull())
-        guiNode->setIcon(0, icon);
-
-    return guiNode;
+    auto xdeDocItem = static_cast<const XdeDocumentItem*>(docItem);
+    return nodeId != 0
+            && xdeDocItem->canFetchAssemblyNodeChildren(this->contentNodeId(xdeDocItem, nodeId));
 }
 
-void WidgetModelTreeBuilder_Xde::buildXdeTree(
-        QTreeWidgetItem* treeItem, XdeDocumentItem* docItem)
+int WidgetModelTreeBuilder_Xde::fetchMoreCount(DocumentItem* docItem, TreeNodeId nodeId) const
 {
-    std::unordered_map<TreeNodeId, QTreeWidgetItem*> mapNodeIdToTreeItem;
-    std::unordered_set<TreeNodeId> setRefNodeId;
-    const Tree<TDF_Label>& asmTree = docItem->assemblyTree();
-    deepForeachTreeNode(asmTree, [&](TreeNodeId nodeId) {
-        const TreeNodeId nodeParentId = asmTree.nodeParent(nodeId);
-        const TDF_Label& nodeLabel = asmTree.nodeData(nodeId);
-        auto itParentFound = mapNodeIdToTreeItem.find(nodeParentId);
-        QTreeWidgetItem* guiParentNode =
-                itParentFound != mapNodeIdToTreeItem.end() ?
-                    itParentFound->second : treeItem;
-        if (m_isMergeXdeReferredShapeOn) {
-            if (XdeDocumentItem::isShapeReference(nodeLabel)) {
-                mapNodeIdToTreeItem.insert({ nodeId, guiParentNode });
-                setRefNodeId.insert(nodeId);
-            }
-            else {
-                auto guiNode = new QTreeWidgetItem(guiParentNode);
-                QString guiNodeText = XdeDocumentItem::findLabelName(nodeLabel);
-                TreeNodeId guiNodeId = nodeId;
-                if (setRefNodeId.find(nodeParentId) != setRefNodeId.cend()) {
-                    const TDF_Label& refLabel = asmTree.nodeData(nodeParentId);
-                    guiNodeText = this->referenceItemText(refLabel, nodeLabel);
-                    guiNodeId = nodeParentId;
-                }
-
-                guiNode->setText(0, guiNodeText);
-                WidgetModelTree::setDocumentItemNode(
-                            guiNode, DocumentItemNode(docItem, guiNodeId));
-                const QIcon icon = Internal::shapeIcon(nodeLabel);
-                if (!icon.isNull())
-                    guiNode->setIcon(0, icon);
-
-                mapNodeIdToTreeItem.insert({ nodeId, guiNode });
-            }
-        }
-        else {
-            auto guiNode = ThisType::guiCreateXdeTreeNode(guiParentNode, nodeId, docItem);
-            mapNodeIdToTreeItem.insert({ nodeId, guiNode });
-        }
-    });
+    // Nodes of references already have their referred shape fetched (see
+    // fetchMore()), so rows are the children of the content node
+    if (nodeId == 0)
+        return 0;
+
+    auto xdeDocItem = static_cast<const XdeDocumentItem*>(docItem);
+    return xdeDocItem->assemblyNodeFetchCount(this->contentNodeId(xdeDocItem, nodeId));
+}
+
+void WidgetModelTreeBuilder_Xde::fetchMore(DocumentItem* docItem, TreeNodeId nodeId)
+{
+    auto xdeDocItem = static_cast<XdeDocumentItem*>(docItem);
+    const Tree<TDF_Label>& asmTree = xdeDocItem->assemblyTree();
+    const TreeNodeId contentNodeId = this->contentNodeId(xdeDocItem, nodeId);
+    xdeDocItem->fetchAssemblyNodeChildren(contentNodeId);
+    if (!m_isMergeXdeReferredShapeOn)
+        return;
+
+    // Referred shapes have to exist to be merged in nodes of references
+    for (auto it = asmTree.nodeChildFirst(contentNodeId); it != 0; it = asmTree.nodeSiblingNext(it)) {
+        if (XdeDocumentItem::isShapeReference(asmTree.nodeData(it)))
+            xdeDocItem->fetchAssemblyNodeChildren(it);
+    }
 }
 
 const QString& WidgetModelTreeBuilder_Xde::referenceItemTextTemplate() const
@@ -150,10 +159,8 @@ void WidgetModelTreeBuilder_Xde::setReferenceItemTextTemplate(const QString& tex
         return;
 
     m_refItemTextTemplate = textTemplate;
-    for (QTreeWidgetItemIterator it(this->treeWidget()); *it; ++it) {
-        if (WidgetModelTree::holdsDocumentItemNode(*it))
-            this->refreshXdeAssemblyNodeItemText(*it);
-    }
+    if (this->model())
+        this->model()->invalidateText();
 }
 
 void WidgetModelTreeBuilder_Xde::loadConfiguration(
@@ -209,24 +216,6 @@ WidgetModelTreeBuilder* WidgetModelTreeBuilder_Xde::clone() const
     return builder;
 }
 
-void WidgetModelTreeBuilder_Xde::refreshXdeAssemblyNodeItemText(QTreeWidgetItem* item)
-{
-    const DocumentItemNode docItemNode = WidgetModelTree::documentItemNode(item);
-    if (!sameType<XdeDocumentItem>(docItemNode.documentItem))
-        return;
-
-    const TDF_Label label = XdeDocumentItem::label(docItemNode);
-    if (XdeDocumentItem::isShapeReference(label)) {
-        const TDF_Label& refLabel = label;
-        const TDF_Label referredLabel = XdeDocumentItem::shapeReferred(refLabel);
-        const QString itemText = this->referenceItemText(refLabel, referredLabel);
-        item->setText(0, itemText);
-    }
-    else {
-        item->setText(0, XdeDocumentItem::findLabelName(label));
-    }
-}
-
 QString WidgetModelTreeBuilder_Xde::referenceItemText(
         const TDF_Label& refLabel, const TDF_Label& referredLabel) const
 {
@@ -238,19 +227,19 @@ QString WidgetModelTreeBuilder_Xde::referenceItemText(
     return itemText;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::findTreeItem(
-        QTreeWidgetItem* parentTreeItem, const TDF_Label& label) const
+TreeNodeId WidgetModelTreeBuilder_Xde::contentNodeId(
+        const XdeDocumentItem* docItem, TreeNodeId nodeId) const
 {
-    if (!parentTreeItem)
-        return nullptr;
-
-    for (QTreeWidgetItemIterator it(parentTreeItem); *it; ++it) {
-        const DocumentItemNode docItemNode = WidgetModelTree::documentItemNode(*it);
-        if (XdeDocumentItem::label(docItemNode) == label)
-            return *it;
+    // Reference and referred shape are merged in a single node, the children
+    // displayed are those of the referred shape
+    const Tree<TDF_Label>& asmTree = docItem->assemblyTree();
+    if (m_isMergeXdeReferredShapeOn && XdeDocumentItem::isShapeReference(asmTree.nodeData(nodeId))) {
+        const TreeNodeId referredNodeId = asmTree.nodeChildFirst(nodeId);
+        if (referredNodeId != 0)
+            return referredNodeId;
     }
 
-    return nullptr;
+    return nodeId;
 }
 
 } // namespace Mayo
@@ -21,8 +21,18 @@ public:
     WidgetModelTreeBuilder_Xde();
 
     bool supports(const DocumentItem* docItem) const override;
-    void refreshTextTreeItem(const DocumentItemNode& node, QTreeWidgetItem* treeItemDocItem) override;
-    void fillTreeItem(QTreeWidgetItem* treeItem, DocumentItem* docItem) override;
+
+    QVariant data(const DocumentItem* docItem, int role) const override;
+    QVariant data(const DocumentItemNode& node, int role) const override;
+
+    int nodeChildCount(DocumentItem* docItem, TreeNodeId nodeId) const override;
+    TreeNodeId nodeChild(DocumentItem* docItem, TreeNodeId nodeId, int row) const override;
+    TreeNodeId nodeParent(DocumentItem* docItem, TreeNodeId nodeId) const override;
+    int nodeRow(DocumentItem* docItem, TreeNodeId nodeId) const override;
+
+    bool canFetchMore(DocumentItem* docItem, TreeNodeId nodeId) const override;
+    int fetchMoreCount(DocumentItem* docItem, TreeNodeId nodeId) const override;
+    void fetchMore(DocumentItem* docItem, TreeNodeId nodeId) override;
 
     void loadConfiguration(const Settings* settings, const QString& keyGroup) override;
     void saveConfiguration(Settings* settings, const QString& keyGroup) override;
@@ -37,18 +47,10 @@ private:
     using ThisType = WidgetModelTreeBuilder_Xde;
     using ParentType = WidgetModelTreeBuilder;
 
-    static QTreeWidgetItem* guiCreateXdeTreeNode(
-            QTreeWidgetItem* guiParentNode,
-            TreeNodeId nodeId,
-            XdeDocumentItem* docItem);
-
-    void buildXdeTree(QTreeWidgetItem* treeItem, XdeDocumentItem* docItem);
-    void refreshXdeAssemblyNodeItemText(QTreeWidgetItem* item);
+    TreeNodeId contentNodeId(const XdeDocumentItem* docItem, TreeNodeId nodeId) const;
     QString referenceItemText(
             const TDF_Label& refLabel,
             const TDF_Label& referredLabel) const;
-    QTreeWidgetItem* findTreeItem(
-            QTreeWidgetItem* parentTreeItem, const TDF_Label& label) const;
 
     bool m_isMergeXdeReferredShapeOn = true;
     QString m_refItemTextTemplate;
@@ -129,7 +129,7 @@ bool WidgetOccViewController::eventFilter(QObject* watched, QEvent* event)
                 view->StartRotation(prevPos.x(), prevPos.y());
             }
 
-            view->Rotation(currPos.x(), currPos.y());
+            this->queueRotation(currPos);
         }
         else if (mouseEvent->buttons() == Qt::RightButton) {
             if (!this->isPanningStarted()) {
@@ -137,7 +137,7 @@ bool WidgetOccViewController::eventFilter(QObject* watched, QEvent* event)
                 this->startDynamicAction(DynamicAction::Panning);
             }
 
-            view->Pan(currPos.x() - prevPos.x(), prevPos.y() - currPos.y());
+            this->queuePanning(currPos.x() - prevPos.x(), prevPos.y() - currPos.y());
         }
         else if (mouseEvent->buttons() == Qt::MiddleButton) {
             if (!this->isWindowZoomingStarted()) {
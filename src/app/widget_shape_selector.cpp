@@ -6,6 +6,7 @@
 
 #include "widget_shape_selector.h"
 
+#include "../gpx/gpx_xde_document_item.h"
 #include "../gui/gui_document.h"
 #include "widget_gui_document.h"
 #include "widget_occ_view_controller.h"
@@ -38,6 +39,20 @@ static QString stringShapeTypePlural(TopAbs_ShapeEnum shapeType)
     return QString("?");
 }
 
+static int xdeSelectionMode(TopAbs_ShapeEnum shapeType)
+{
+    switch (shapeType) {
+    case TopAbs_VERTEX: return GpxXdeDocumentItem::SelectVertex;
+    case TopAbs_EDGE: return GpxXdeDocumentItem::SelectEdge;
+    case TopAbs_WIRE: return GpxXdeDocumentItem::SelectWire;
+    case TopAbs_FACE: return GpxXdeDocumentItem::SelectFace;
+    case TopAbs_SHELL: return GpxXdeDocumentItem::SelectShell;
+    case TopAbs_SOLID: return GpxXdeDocumentItem::SelectSolid;
+    default: break;
+    }
+    return -1;
+}
+
 static const TopAbs_ShapeEnum allShapeTypes[] = {
     TopAbs_VERTEX, TopAbs_EDGE, TopAbs_WIRE, TopAbs_FACE, TopAbs_SHELL, TopAbs_SOLID
 };
@@ -216,10 +231,18 @@ void GpxShapeSelector::onShapeTypeChanged(TopAbs_ShapeEnum shapeEnum)
     this->context()->RemoveFilters();
     if (shapeEnum != TopAbs_SHAPE)
         this->context()->AddFilter(new StdSelect_ShapeTypeFilter(shapeEnum));
+
+    // Selection modes are activated on first use
+    for (TopAbs_ShapeEnum shapeType : allShapeTypes) {
+        const int mode = xdeSelectionMode(shapeType);
+        if (mode != -1 && (shapeEnum == TopAbs_SHAPE || shapeEnum == shapeType))
+            m_guiDocument->activateSelection(mode);
+    }
 }
 
 void GpxShapeSelector::onView3dMouseMove(const QPoint& pos)
 {
+    m_guiDocument->waitSelectionPrepared();
     this->context()->MoveTo(pos.x(), pos.y(), m_guiDocument->v3dView(), true);
 }
 
@@ -12,13 +12,17 @@
 #include "xde_document_item.h"
 #include "mesh_item.h"
 #include "mesh_utils.h"
+#include "stl_reader.h"
+#include "stl_writer.h"
 #include "string_utils.h"
+#include "tessellation_cache.h"
 
 #include <fougtools/qttools/task/progress.h>
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QSettings>
@@ -26,9 +30,13 @@
 #include <BRepGProp.hxx>
 #include <GProp_GProps.hxx>
 #include <BRep_Builder.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
 #include <BRepTools.hxx>
+#include <Bnd_Box.hxx>
 #include <IGESControl_Controller.hxx>
 #include <Interface_Static.hxx>
+#include <STEPCAFControl_Controller.hxx>
 #include <Message_ProgressIndicator.hxx>
 #include <OSD_Path.hxx>
 #include <RWStl.hxx>
@@ -66,8 +74,25 @@ namespace Mayo {
 
 namespace Internal {
 
+// Serializes STEP/IGES translations, unless concurrent import is enabled
 static std::mutex globalMutex;
 
+// Registers the IGES/STEP translation controllers and sets the static
+// parameters shared by all readers/writers.
+// Interface_Static is process-wide in OpenCascade and cannot be made thread
+// local, so its values are written once here and then only read concurrently
+// by the per-task XSControl_WorkSession objects.
+static void initXdeControllers()
+{
+    static std::once_flag onceFlag;
+    std::call_once(onceFlag, []{
+        IGESControl_Controller::Init();
+        STEPCAFControl_Controller::Init();
+        Interface_Static::SetIVal("read.stepcaf.subshapes.name", 1);
+        Interface_Static::SetIVal("write.stepcaf.subshapes.name", 1);
+    });
+}
+
 #ifdef HAVE_GMIO
 static bool gmio_qttask_is_stop_requested(void* cookie)
 {
@@ -178,7 +203,7 @@ TopoDS_Shape loadShapeFromFile(
         IFSelect_ReturnStatus* error,
         qttask::Progress* progress)
 {
-    std::lock_guard<std::mutex> lock(globalMutex); Q_UNUSED(lock);
+    initXdeControllers();
     Handle_Message_ProgressIndicator indicator = new OccProgress(progress);
     TopoDS_Shape result;
 
@@ -231,7 +256,10 @@ void loadCafDocumentFromFile(
         IFSelect_ReturnStatus* error,
         qttask::Progress* progress)
 {
-    std::lock_guard<std::mutex> lock(globalMutex); Q_UNUSED(lock);
+    initXdeControllers();
+    // Each reader owns its XSControl_WorkSession (and so its MapReader), hence
+    // concurrent calls don't share any transfer state. Callers still serialize
+    // them unless Application::isConcurrentImportEnabled()
     Handle_Message_ProgressIndicator indicator = new OccProgress(progress);
     if (!indicator.IsNull())
         indicator->NewScope(30, "Loading file");
@@ -262,6 +290,51 @@ void loadCafDocumentFromFile(
     }
 }
 
+// Meshes the free shapes of 'cafDoc', returns the elapsed time in milliseconds
+static qint64 meshXdeDocument(
+        const Handle_TDocStd_Document& cafDoc,
+        const Application::MeshingParameters& params,
+        qttask::Progress* progress)
+{
+    QElapsedTimer chrono;
+    chrono.start();
+    if (progress) {
+        progress->setStep(Application::tr("Meshing"));
+        progress->setValue(0);
+    }
+
+    Handle_XCAFDoc_ShapeTool shapeTool = XCAFDoc_DocumentTool::ShapeTool(cafDoc->Main());
+    TDF_LabelSequence seqFreeShape;
+    shapeTool->GetFreeShapes(seqFreeShape);
+    for (int i = 1; i <= seqFreeShape.Size(); ++i) {
+        if (progress && progress->isAbortRequested())
+            break;
+
+        const TopoDS_Shape shape = XCAFDoc_ShapeTool::GetShape(seqFreeShape.Value(i));
+        Bnd_Box bndBox;
+        BRepBndLib::Add(shape, bndBox, false);
+        if (!bndBox.IsVoid()) {
+            // Same computation as Prs3d::GetDeflection(), so the presentation
+            // considers the shape already tessellated
+            double xMin, yMin, zMin, xMax, yMax, zMax;
+            bndBox.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+            const double maxDim = std::max({ xMax - xMin, yMax - yMin, zMax - zMin });
+            const double linearDeflection = maxDim * params.deviationCoefficient * 4.;
+            BRepMesh_IncrementalMesh mesher(
+                        shape,
+                        linearDeflection,
+                        false, // isRelative
+                        params.angularDeflection.value(),
+                        true); // isInParallel
+        }
+
+        if (progress)
+            progress->setValue((100 * i) / seqFreeShape.Size());
+    }
+
+    return chrono.elapsed();
+}
+
 static TopoDS_Shape xdeDocumentWholeShape(const XdeDocumentItem* xdeDocItem)
 {
     TopoDS_Shape shape;
@@ -288,10 +361,9 @@ static MeshItem* createMeshItem(
     partItem->propertyLabel.setValue(QFileInfo(filepath).baseName());
     partItem->propertyNodeCount.setValue(mesh->NbNodes());
     partItem->propertyTriangleCount.setValue(mesh->NbTriangles());
-    partItem->propertyVolume.setQuantity(
-                MeshUtils::triangulationVolume(mesh) * Quantity_CubicMillimeter);
-    partItem->propertyArea.setQuantity(
-                MeshUtils::triangulationArea(mesh) * Quantity_SquaredMillimeter);
+    const MeshUtils::VolumeArea volumeArea = MeshUtils::triangulationVolumeArea(mesh);
+    partItem->propertyVolume.setQuantity(volumeArea.volume * Quantity_CubicMillimeter);
+    partItem->propertyArea.setQuantity(volumeArea.area * Quantity_SquaredMillimeter);
     partItem->setTriangulation(mesh);
     return partItem;
 }
@@ -314,6 +386,70 @@ static XdeDocumentItem* createXdeDocumentItem(
     return xdeDocItem;
 }
 
+// Key of the tessellation cache entry for an import, empty if the cache is disabled
+static QByteArray tessellationCacheKey(
+        const TessellationCache& cache,
+        const QString& filepath,
+        Application::PartFormat format,
+        const Application::MeshingParameters& meshingParams)
+{
+    if (!cache.isEnabled())
+        return QByteArray();
+
+    QByteArray extraData = QByteArray::number(static_cast<int>(format));
+    if (meshingParams.enabled) {
+        extraData += '/' + QByteArray::number(meshingParams.deviationCoefficient, 'g', 17);
+        extraData += '/' + QByteArray::number(meshingParams.angularDeflection.value(), 'g', 17);
+    }
+
+    return TessellationCache::computeKey(filepath, extraData);
+}
+
+static bool importFromTessellationCache(
+        TessellationCache* cache,
+        const QByteArray& cacheKey,
+        Document* doc,
+        const QString& filepath,
+        qttask::Progress* progress)
+{
+    if (cacheKey.isEmpty())
+        return false;
+
+    if (progress)
+        progress->setStep(Application::tr("Loading from cache"));
+
+    TessellationCache::Entry entry;
+    if (!cache->load(cacheKey, &entry))
+        return false;
+
+    auto xdeDocItem = new XdeDocumentItem(entry.cafDoc);
+    xdeDocItem->propertyLabel.setValue(QFileInfo(filepath).baseName());
+    xdeDocItem->propertyVolume.setQuantity(entry.volume * Quantity_CubicMillimeter);
+    xdeDocItem->propertyArea.setQuantity(entry.area * Quantity_SquaredMillimeter);
+    doc->addRootItem(xdeDocItem);
+    return true;
+}
+
+static void storeInTessellationCache(
+        TessellationCache* cache,
+        const QByteArray& cacheKey,
+        const XdeDocumentItem* xdeDocItem,
+        qttask::Progress* progress)
+{
+    // Don't store partial meshing
+    if (cacheKey.isEmpty() || (progress && progress->isAbortRequested()))
+        return;
+
+    if (progress)
+        progress->setStep(Application::tr("Storing in cache"));
+
+    TessellationCache::Entry entry;
+    entry.cafDoc = xdeDocItem->cafDoc();
+    entry.volume = xdeDocItem->propertyVolume.quantity().value();
+    entry.area = xdeDocItem->propertyArea.quantity().value();
+    cache->store(cacheKey, entry);
+}
+
 static Application::PartFormat findPartFormatFromContents(
         std::string_view contentsBegin,
         uint64_t hintFullContentsSize)
@@ -399,6 +535,7 @@ static Application::PartFormat findPartFormatFromContents(
 Application::Application(QObject *parent)
     : QObject(parent)
 {
+    qRegisterMetaType<std::vector<DocumentItem*>>("std::vector<DocumentItem*>");
 }
 
 Application *Application::instance()
@@ -430,8 +567,8 @@ void Application::addDocument(Document* doc)
             emit documentPropertyChanged(doc, prop);
         });
         QObject::connect(
-                    doc, &Document::itemAdded,
-                    this, &Application::documentItemAdded);
+                    doc, &Document::itemsAdded,
+                    this, &Application::documentItemsAdded);
         QObject::connect(
                     doc, &Document::itemErased,
                     this, &Application::documentItemErased);
@@ -478,11 +615,28 @@ Application::IoResult Application::importInDocument(
         Document* doc,
         PartFormat format,
         const QString& filepath,
-        qttask::Progress* progress)
+        qttask::Progress* progress,
+        ImportInfo* info)
+{
+    return this->importInDocument(
+                doc, format, filepath, this->meshingParameters(), progress, info);
+}
+
+Application::IoResult Application::importInDocument(
+        Document* doc,
+        PartFormat format,
+        const QString& filepath,
+        const MeshingParameters& meshingParams,
+        qttask::Progress* progress,
+        ImportInfo* info)
 {
+    ImportInfo localInfo;
+    if (!info)
+        info = &localInfo;
+
     switch (format) {
-    case PartFormat::Iges: return this->importIges(doc, filepath, progress);
-    case PartFormat::Step: return this->importStep(doc, filepath, progress);
+    case PartFormat::Iges: return this->importIges(doc, filepath, meshingParams, progress, info);
+    case PartFormat::Step: return this->importStep(doc, filepath, meshingParams, progress, info);
     case PartFormat::OccBrep: return this->importOccBRep(doc, filepath, progress);
     case PartFormat::Stl: return this->importStl(doc, filepath, progress);
     case PartFormat::Unknown: break;
@@ -645,33 +799,102 @@ void Application::setStlIoLibrary(Application::StlIoLibrary lib)
     m_stlIoLibrary = lib;
 }
 
+bool Application::isConcurrentImportEnabled() const
+{
+    return m_isConcurrentImportEnabled;
+}
+
+void Application::setConcurrentImportEnabled(bool on)
+{
+    m_isConcurrentImportEnabled = on;
+}
+
+Application::MeshingParameters Application::meshingParameters() const
+{
+    std::lock_guard<std::mutex> lock(m_mutexMeshingParams);
+    return m_meshingParams;
+}
+
+void Application::setMeshingParameters(const MeshingParameters& params)
+{
+    std::lock_guard<std::mutex> lock(m_mutexMeshingParams);
+    m_meshingParams = params;
+}
+
+TessellationCache* Application::tessellationCache()
+{
+    return &m_tessellationCache;
+}
+
 Application::IoResult Application::importIges(
-        Document* doc, const QString& filepath, qttask::Progress* progress)
+        Document* doc,
+        const QString& filepath,
+        const MeshingParameters& meshingParams,
+        qttask::Progress* progress,
+        ImportInfo* info)
 {
-    IGESControl_Controller::Init();
+    const QByteArray cacheKey = Internal::tessellationCacheKey(
+                m_tessellationCache, filepath, PartFormat::Iges, meshingParams);
+    info->isFromCache = Internal::importFromTessellationCache(
+                &m_tessellationCache, cacheKey, doc, filepath, progress);
+    if (info->isFromCache)
+        return IoResult::ok();
+
     Handle_TDocStd_Document cafDoc = CafUtils::createXdeDocument();
     IFSelect_ReturnStatus err;
-    Internal::loadCafDocumentFromFile<IGESCAFControl_Reader>(
-                filepath, cafDoc, &err, progress);
+    {
+        std::unique_lock<std::mutex> lock(Internal::globalMutex, std::defer_lock);
+        if (!this->isConcurrentImportEnabled())
+            lock.lock();
+
+        Internal::loadCafDocumentFromFile<IGESCAFControl_Reader>(
+                    filepath, cafDoc, &err, progress);
+    }
     if (err != IFSelect_RetDone)
         return IoResult::error(StringUtils::rawText(err));
 
-    doc->addRootItem(Internal::createXdeDocumentItem(filepath, cafDoc));
+    if (meshingParams.enabled)
+        info->meshingTime = Internal::meshXdeDocument(cafDoc, meshingParams, progress);
+
+    XdeDocumentItem* xdeDocItem = Internal::createXdeDocumentItem(filepath, cafDoc);
+    Internal::storeInTessellationCache(&m_tessellationCache, cacheKey, xdeDocItem, progress);
+    doc->addRootItem(xdeDocItem);
     return IoResult::ok();
 }
 
 Application::IoResult Application::importStep(
-        Document* doc, const QString& filepath, qttask::Progress* progress)
+        Document* doc,
+        const QString& filepath,
+        const MeshingParameters& meshingParams,
+        qttask::Progress* progress,
+        ImportInfo* info)
 {
-    Interface_Static::SetIVal("read.stepcaf.subshapes.name", 1);
+    const QByteArray cacheKey = Internal::tessellationCacheKey(
+                m_tessellationCache, filepath, PartFormat::Step, meshingParams);
+    info->isFromCache = Internal::importFromTessellationCache(
+                &m_tessellationCache, cacheKey, doc, filepath, progress);
+    if (info->isFromCache)
+        return IoResult::ok();
+
     Handle_TDocStd_Document cafDoc = CafUtils::createXdeDocument();
     IFSelect_ReturnStatus err;
-    Internal::loadCafDocumentFromFile<STEPCAFControl_Reader>(
-                filepath, cafDoc, &err, progress);
+    {
+        std::unique_lock<std::mutex> lock(Internal::globalMutex, std::defer_lock);
+        if (!this->isConcurrentImportEnabled())
+            lock.lock();
+
+        Internal::loadCafDocumentFromFile<STEPCAFControl_Reader>(
+                    filepath, cafDoc, &err, progress);
+    }
     if (err != IFSelect_RetDone)
         return IoResult::error(StringUtils::rawText(err));
 
-    doc->addRootItem(Internal::createXdeDocumentItem(filepath, cafDoc));
+    if (meshingParams.enabled)
+        info->meshingTime = Internal::meshXdeDocument(cafDoc, meshingParams, progress);
+
+    XdeDocumentItem* xdeDocItem = Internal::createXdeDocumentItem(filepath, cafDoc);
+    Internal::storeInTessellationCache(&m_tessellationCache, cacheKey, xdeDocItem, progress);
+    doc->addRootItem(xdeDocItem);
     return IoResult::ok();
 }
 
@@ -707,19 +930,42 @@ Application::IoResult Application::importStl(
             options.func_stla_get_streamsize = &gmio_stla_infos_probe_streamsize;
             options.task_iface = Internal::gmio_qttask_create_task_iface(progress);
             int err = GMIO_ERROR_OK;
+            std::vector<DocumentItem*> vecItem;
             while (gmio_no_error(err) && !file.atEnd()) {
                 gmio_stl_mesh_creator_occpolytri meshcreator;
                 err = gmio_stl_read(&stream, &meshcreator, &options);
                 if (gmio_no_error(err)) {
                     const Handle_Poly_Triangulation& mesh = meshcreator.polytri();
-                    doc->addRootItem(Internal::createMeshItem(filepath, mesh));
+                    vecItem.push_back(Internal::createMeshItem(filepath, mesh));
                 }
             }
+
+            // Solids read before an error are kept
+            doc->addRootItems(vecItem);
             if (err != GMIO_ERROR_OK)
                 return IoResult::error(Internal::gmioErrorToQString(err));
         }
 #endif // HAVE_GMIO
     }
+    else if (this->stlIoLibrary() == StlIoLibrary::Mayo) {
+        const StlReader::ReadResult result = StlReader::readFile(filepath, progress);
+        if (!result.valid())
+            return IoResult::error(result.errorText());
+
+        std::vector<DocumentItem*> vecItem;
+        for (const StlReader::Solid& solid : result.get()) {
+            if (solid.mesh.IsNull())
+                continue;
+
+            MeshItem* meshItem = Internal::createMeshItem(filepath, solid.mesh);
+            if (!solid.name.isEmpty())
+                meshItem->propertyLabel.setValue(solid.name);
+
+            vecItem.push_back(meshItem);
+        }
+
+        doc->addRootItems(vecItem);
+    }
     else if (this->stlIoLibrary() == StlIoLibrary::OpenCascade) {
         Handle_Message_ProgressIndicator indicator = new Internal::OccProgress(progress);
         const Handle_Poly_Triangulation mesh = RWStl::ReadFile(
@@ -740,9 +986,8 @@ Application::IoResult Application::exportIges(
         qttask::Progress* progress)
 {
     std::lock_guard<std::mutex> lock(Internal::globalMutex); Q_UNUSED(lock);
+    Internal::initXdeControllers();
     Handle_Message_ProgressIndicator indicator = new Internal::OccProgress(progress);
-
-    IGESControl_Controller::Init();
     IGESCAFControl_Writer writer;
     writer.SetColorMode(true);
     writer.SetNameMode(true);
@@ -773,7 +1018,7 @@ Application::IoResult Application::exportStep(
         qttask::Progress *progress)
 {
     std::lock_guard<std::mutex> lock(Internal::globalMutex); Q_UNUSED(lock);
-    Interface_Static::SetIVal("write.stepcaf.subshapes.name", 1);
+    Internal::initXdeControllers();
     Handle_Message_ProgressIndicator indicator = new Internal::OccProgress(progress);
     STEPCAFControl_Writer writer;
     if (!indicator.IsNull())
@@ -848,6 +1093,8 @@ Application::IoResult Application::exportStl(
         return this->exportStl_gmio(appItems, options, filepath, progress);
     else if (this->stlIoLibrary() == StlIoLibrary::OpenCascade)
         return this->exportStl_OCC(appItems, options, filepath, progress);
+    else if (this->stlIoLibrary() == StlIoLibrary::Mayo)
+        return this->exportStl_Mayo(appItems, options, filepath, progress);
 
     return IoResult::error(tr("Unknown Error"));
 }
@@ -960,4 +1207,77 @@ Application::IoResult Application::exportStl_OCC(
     return IoResult::ok();
 }
 
+Application::IoResult Application::exportStl_Mayo(
+        Span<const ApplicationItem> appItems,
+        const Application::ExportOptions& options,
+        const QString& filepath,
+        qttask::Progress* progress)
+{
+#ifdef HAVE_GMIO
+    const bool isAsciiFormat = options.stlFormat == GMIO_STL_FORMAT_ASCII;
+    if (options.stlFormat != GMIO_STL_FORMAT_ASCII
+            && options.stlFormat != GMIO_STL_FORMAT_BINARY_LE)
+    {
+        return IoResult::error(tr("Format not supported"));
+    }
+#else
+    const bool isAsciiFormat = options.stlFormat == ExportOptions::StlFormat::Ascii;
+#endif
+    StlWriter writer(isAsciiFormat ? StlWriter::Format::Ascii : StlWriter::Format::Binary);
+    const StlWriter::WriteResult resOpen = writer.open(filepath);
+    if (!resOpen)
+        return IoResult::error(resOpen.errorText());
+
+    // Each item is streamed as a separate solid, shapes are never merged
+    for (int i = 0; i < appItems.size(); ++i) {
+        if (progress && progress->isAbortRequested()) {
+            // Partial file must not be mistaken for a complete export
+            writer.close();
+            QFile::remove(filepath);
+            return IoResult::error(tr("Aborted"));
+        }
+
+        const ApplicationItem& item = appItems.at(i);
+        bool isSolidBegun = false;
+        if (sameType<XdeDocumentItem>(item.documentItem())) {
+            auto xdeDocItem = static_cast<const XdeDocumentItem*>(item.documentItem());
+            if (item.isDocumentItem()) {
+                writer.beginSolid(xdeDocItem->propertyLabel.value());
+                isSolidBegun = true;
+                for (const TDF_Label& label : xdeDocItem->topLevelFreeShapes())
+                    writer.writeShape(XdeDocumentItem::shape(label));
+            }
+            else if (item.isDocumentItemNode()) {
+                const DocumentItemNode& docItemNode = item.documentItemNode();
+                const TDF_Label label = XdeDocumentItem::label(docItemNode);
+                const TreeNodeId parentId = xdeDocItem->assemblyTree().nodeParent(docItemNode.id);
+                const QString name = xdeDocItem->findLabelName(docItemNode.id);
+                writer.beginSolid(!name.isEmpty() ? name : xdeDocItem->propertyLabel.value());
+                isSolidBegun = true;
+                writer.writeShape(
+                            XdeDocumentItem::shape(label).Moved(
+                                xdeDocItem->shapeAbsoluteLocation(parentId)));
+            }
+        }
+        else if (sameType<MeshItem>(item.documentItem())) {
+            auto meshItem = static_cast<const MeshItem*>(item.documentItem());
+            writer.beginSolid(meshItem->propertyLabel.value());
+            isSolidBegun = true;
+            writer.writeTriangulation(meshItem->triangulation());
+        }
+
+        if (isSolidBegun)
+            writer.endSolid();
+
+        if (progress)
+            progress->setValue(static_cast<int>((100 * (i + 1)) / appItems.size()));
+    }
+
+    const StlWriter::WriteResult resClose = writer.close();
+    if (!resClose)
+        return IoResult::error(resClose.errorText());
+
+    return IoResult::ok();
+}
+
 } // namespace Mayo
@@ -7,14 +7,18 @@
 #pragma once
 
 #include "application_item.h"
+#include "quantity.h"
 #include "result.h"
 #include "span.h"
+#include "tessellation_cache.h"
 
 #ifdef HAVE_GMIO
 #  include <gmio_core/text_format.h>
 #  include <gmio_stl/stl_format.h>
 #endif
 #include <QtCore/QObject>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <vector>
 class QFileInfo;
@@ -59,7 +63,23 @@ public:
 
     enum class StlIoLibrary {
         Gmio,
-        OpenCascade
+        OpenCascade,
+        Mayo
+    };
+
+    // Parameters of the meshing stage run after translation of STEP/IGES files
+    struct MeshingParameters {
+        bool enabled = true;
+        // Linear deflection relative to the largest dimension of the shape
+        // bounding box, same meaning as Prs3d_Drawer::DeviationCoefficient()
+        double deviationCoefficient = 0.001;
+        QuantityAngle angularDeflection = 20 * Quantity_Degree;
+    };
+
+    // Additional informations about an import operation
+    struct ImportInfo {
+        qint64 meshingTime = -1; // Milliseconds, -1 if there was no meshing stage
+        bool isFromCache = false; // Loaded from tessellationCache()
     };
 
     // -- API
@@ -82,11 +102,34 @@ public:
     Application::StlIoLibrary stlIoLibrary() const;
     void setStlIoLibrary(Application::StlIoLibrary lib);
 
+    // STEP/IGES imports are serialized by default : OpenCascade data exchange
+    // relies on process-wide state (Interface_Static, registries of the
+    // controllers) not proven safe for concurrent use in all versions
+    bool isConcurrentImportEnabled() const;
+    void setConcurrentImportEnabled(bool on);
+
+    // Thread-safe, imports running in worker threads read a copy of the parameters
+    MeshingParameters meshingParameters() const;
+    void setMeshingParameters(const MeshingParameters& params);
+
+    // Cache of STEP/IGES imports, disabled by default
+    TessellationCache* tessellationCache();
+
     IoResult importInDocument(
             Document* doc,
             PartFormat format,
             const QString& filepath,
-            qttask::Progress* progress = nullptr);
+            qttask::Progress* progress = nullptr,
+            ImportInfo* info = nullptr);
+    // Same as above but STEP/IGES files are meshed with 'meshingParams' instead
+    // of the application's parameters
+    IoResult importInDocument(
+            Document* doc,
+            PartFormat format,
+            const QString& filepath,
+            const MeshingParameters& meshingParams,
+            qttask::Progress* progress = nullptr,
+            ImportInfo* info = nullptr);
     IoResult exportApplicationItems(
             Span<const ApplicationItem> appItems,
             PartFormat format,
@@ -101,7 +144,7 @@ signals:
     void documentAdded(Document* doc);
     void documentErased(const Document* doc);
     void documentPropertyChanged(Document* doc, Property* prop);
-    void documentItemAdded(DocumentItem* docItem);
+    void documentItemsAdded(std::vector<DocumentItem*> vecDocItem);
     void documentItemErased(const DocumentItem* docItem);
     void documentItemPropertyChanged(DocumentItem* docItem, Property* prop);
 
@@ -110,9 +153,17 @@ private:
     Application(QObject* parent = nullptr);
 
     IoResult importIges(
-            Document* doc, const QString& filepath, qttask::Progress* progress);
+            Document* doc,
+            const QString& filepath,
+            const MeshingParameters& meshingParams,
+            qttask::Progress* progress,
+            ImportInfo* info);
     IoResult importStep(
-            Document* doc, const QString& filepath, qttask::Progress* progress);
+            Document* doc,
+            const QString& filepath,
+            const MeshingParameters& meshingParams,
+            qttask::Progress* progress,
+            ImportInfo* info);
     IoResult importOccBRep(
             Document* doc, const QString& filepath, qttask::Progress* progress);
     IoResult importStl(
@@ -148,9 +199,22 @@ private:
             const ExportOptions& options,
             const QString& filepath,
             qttask::Progress* progress);
+    IoResult exportStl_Mayo(
+            Span<const ApplicationItem> appItems,
+            const ExportOptions& options,
+            const QString& filepath,
+            qttask::Progress* progress);
 
     std::vector<Document*> m_documents;
     StlIoLibrary m_stlIoLibrary = StlIoLibrary::OpenCascade;
+    MeshingParameters m_meshingParams;
+    mutable std::mutex m_mutexMeshingParams;
+    std::atomic<bool> m_isConcurrentImportEnabled = { false };
+    TessellationCache m_tessellationCache;
 };
 
 } // namespace Mayo
+
+// Items can be added to documents from import threads, signals carry their
+// own copy of the item array so they can be queued
+Q_DECLARE_METATYPE(std::vector<Mayo::DocumentItem*>)
@@ -0,0 +1,107 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "bnd_box_tree.h"
+#include <cassert>
+
+namespace Mayo {
+
+namespace Internal {
+
+static Bnd_Box unitedBox(const Bnd_Box& lhs, const Bnd_Box& rhs)
+{
+    Bnd_Box box = lhs;
+    if (!rhs.IsVoid())
+        box.Add(rhs);
+
+    return box;
+}
+
+} // namespace Internal
+
+BndBoxTree::SlotId BndBoxTree::insert(const Bnd_Box& box)
+{
+    SlotId slot = -1;
+    if (!m_vecFreeSlot.empty()) {
+        slot = m_vecFreeSlot.back();
+        m_vecFreeSlot.pop_back();
+    }
+    else {
+        if (static_cast<int>(m_vecSlotUsed.size()) == m_capacity)
+            this->grow();
+
+        slot = static_cast<SlotId>(m_vecSlotUsed.size());
+        m_vecSlotUsed.push_back(false);
+    }
+
+    m_vecSlotUsed.at(slot) = true;
+    ++m_size;
+    this->update(slot, box);
+    return slot;
+}
+
+void BndBoxTree::update(SlotId slot, const Bnd_Box& box)
+{
+    assert(m_vecSlotUsed.at(slot));
+    const int nodeIndex = this->leafIndex(slot);
+    m_vecNode.at(nodeIndex) = box;
+    this->updateAncestors(nodeIndex);
+}
+
+void BndBoxTree::erase(SlotId slot)
+{
+    if (slot < 0 || slot >= static_cast<int>(m_vecSlotUsed.size()) || !m_vecSlotUsed.at(slot))
+        return;
+
+    const int nodeIndex = this->leafIndex(slot);
+    m_vecNode.at(nodeIndex).SetVoid();
+    this->updateAncestors(nodeIndex);
+    m_vecSlotUsed.at(slot) = false;
+    m_vecFreeSlot.push_back(slot);
+    --m_size;
+}
+
+void BndBoxTree::clear()
+{
+    m_vecNode.clear();
+    m_vecSlotUsed.clear();
+    m_vecFreeSlot.clear();
+    m_capacity = 0;
+    m_size = 0;
+}
+
+const Bnd_Box& BndBoxTree::box(SlotId slot) const
+{
+    return m_vecNode.at(this->leafIndex(slot));
+}
+
+const Bnd_Box& BndBoxTree::unitedBox() const
+{
+    static const Bnd_Box voidBox;
+    return !m_vecNode.empty() ? m_vecNode.at(1) : voidBox;
+}
+
+void BndBoxTree::updateAncestors(int nodeIndex)
+{
+    for (int i = nodeIndex / 2; i >= 1; i /= 2)
+        m_vecNode.at(i) = Internal::unitedBox(m_vecNode.at(2 * i), m_vecNode.at(2 * i + 1));
+}
+
+void BndBoxTree::grow()
+{
+    // Capacity is doubled and the tree rebuilt, amortized O(1) per insertion
+    const int oldCapacity = m_capacity;
+    const std::vector<Bnd_Box> vecOldNode = std::move(m_vecNode);
+    m_capacity = oldCapacity > 0 ? 2 * oldCapacity : 16;
+    m_vecNode = std::vector<Bnd_Box>(2 * m_capacity);
+    for (int slot = 0; slot < oldCapacity; ++slot)
+        m_vecNode.at(this->leafIndex(slot)) = vecOldNode.at(oldCapacity + slot);
+
+    for (int i = m_capacity - 1; i >= 1; --i)
+        m_vecNode.at(i) = Internal::unitedBox(m_vecNode.at(2 * i), m_vecNode.at(2 * i + 1));
+}
+
+} // namespace Mayo
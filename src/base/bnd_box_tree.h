@@ -0,0 +1,45 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <Bnd_Box.hxx>
+#include <vector>
+
+namespace Mayo {
+
+// Set of bounding boxes maintaining their union
+// Boxes are the leaves of a complete binary tree whose inner nodes hold the
+// union of their children, so insertion, update and erasure are O(log n)
+class BndBoxTree {
+public:
+    using SlotId = int;
+
+    SlotId insert(const Bnd_Box& box);
+    void update(SlotId slot, const Bnd_Box& box);
+    void erase(SlotId slot);
+    void clear();
+
+    const Bnd_Box& box(SlotId slot) const;
+    const Bnd_Box& unitedBox() const;
+
+    int size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+private:
+    int leafIndex(SlotId slot) const { return m_capacity + slot; }
+    void updateAncestors(int nodeIndex);
+    void grow();
+
+    // Node i has children 2i and 2i+1, root is node 1
+    std::vector<Bnd_Box> m_vecNode;
+    std::vector<bool> m_vecSlotUsed;
+    std::vector<SlotId> m_vecFreeSlot;
+    int m_capacity = 0;
+    int m_size = 0;
+};
+
+} // namespace Mayo
@@ -10,6 +10,7 @@
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
 #include <string>
+#include <unordered_map>
 
 namespace Mayo {
 
@@ -28,6 +29,18 @@ struct BRepUtils {
 
     static int hashCode(const TopoDS_Shape& shape);
 
+    // Hashing and equality of shapes regardless of their orientation, ie same
+    // TShape and same location(see TopoDS_Shape::IsSame())
+    struct ShapeHasher {
+        size_t operator()(const TopoDS_Shape& shape) const;
+    };
+    struct ShapeIsSame {
+        bool operator()(const TopoDS_Shape& lhs, const TopoDS_Shape& rhs) const;
+    };
+
+    template<typename T>
+    using ShapeHashMap = std::unordered_map<TopoDS_Shape, T, ShapeHasher, ShapeIsSame>;
+
     static std::string shapeToString(const TopoDS_Shape& shape);
     static TopoDS_Shape shapeFromString(const std::string& str);
 };
@@ -38,6 +51,14 @@ struct BRepUtils {
 // -- Implementation
 // --
 
+inline size_t BRepUtils::ShapeHasher::operator()(const TopoDS_Shape& shape) const {
+    return static_cast<size_t>(BRepUtils::hashCode(shape));
+}
+
+inline bool BRepUtils::ShapeIsSame::operator()(const TopoDS_Shape& lhs, const TopoDS_Shape& rhs) const {
+    return lhs.IsSame(rhs);
+}
+
 template<typename FUNC>
 void BRepUtils::forEachSubShape(TopExp_Explorer& explorer, FUNC fn)
 {
@@ -10,6 +10,10 @@
 #include <TDocStd_Document.hxx>
 #include <QtCore/QString>
 #include <QtCore/QHash>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Mayo {
 
@@ -17,9 +21,46 @@ struct CafUtils {
     static QLatin1String labelTag(const TDF_Label& label);
     static QString labelAttrStdName(const TDF_Label& label);
 
+    // Identity of the label within its data framework, ie the address of the
+    // underlying TDF_LabelNode. Two labels are equal if and only if they have the
+    // same identity, which remains valid as long as the owner document is alive
+    static std::uintptr_t labelId(const TDF_Label& label);
+    static size_t labelHash(const TDF_Label& label);
+
+    struct LabelHasher {
+        size_t operator()(const TDF_Label& label) const { return labelHash(label); }
+    };
+
+    template<typename T>
+    using LabelHashMap = std::unordered_map<TDF_Label, T, LabelHasher>;
+    using LabelHashSet = std::unordered_set<TDF_Label, LabelHasher>;
+
     static Handle_TDocStd_Document createXdeDocument(const char* format = "XmlXCAF");
 };
 
+
+
+// --
+// -- Implementation
+// --
+
+inline std::uintptr_t CafUtils::labelId(const TDF_Label& label)
+{
+    // TDF_Label is a mere handle on a TDF_LabelNode object, with no public
+    // accessor to it
+    static_assert(sizeof(TDF_Label) == sizeof(std::uintptr_t), "TDF_Label layout changed");
+    std::uintptr_t id;
+    std::memcpy(&id, &label, sizeof(id));
+    return id;
+}
+
+inline size_t CafUtils::labelHash(const TDF_Label& label)
+{
+    // Low bits of a TDF_LabelNode address are always zero because of alignment
+    const std::uintptr_t id = CafUtils::labelId(label);
+    return static_cast<size_t>((id >> 3) ^ (id >> 17));
+}
+
 } // namespace Mayo
 
 namespace std {
@@ -27,7 +68,7 @@ namespace std {
 //! Specialization of C++11 std::hash<> functor for TDF_Label
 template<> struct hash<TDF_Label> {
     inline size_t operator()(const TDF_Label& lbl) const
-    { return qHash(Mayo::CafUtils::labelTag(lbl)); }
+    { return Mayo::CafUtils::labelHash(lbl); }
 };
 
 } // namespace std
@@ -74,9 +74,21 @@ const char* Document::dynTypeName() const
 
 void Document::addRootItem(DocumentItem* item)
 {
-    item->setDocument(this);
-    m_rootItems.push_back(item);
-    emit itemAdded(item);
+    this->addRootItems(Span<DocumentItem* const>(&item, 1));
+}
+
+void Document::addRootItems(Span<DocumentItem* const> spanItem)
+{
+    if (spanItem.empty())
+        return;
+
+    m_rootItems.reserve(m_rootItems.size() + spanItem.size());
+    for (DocumentItem* item : spanItem) {
+        item->setDocument(this);
+        m_rootItems.push_back(item);
+    }
+
+    emit itemsAdded(std::vector<DocumentItem*>(spanItem.begin(), spanItem.end()));
 }
 
 } // namespace Mayo
@@ -28,6 +28,8 @@ public:
     void setFilePath(const QString& filepath);
 
     void addRootItem(DocumentItem* item);
+    // Adds items all at once, signal itemsAdded() is emitted a single time
+    void addRootItems(Span<DocumentItem* const> spanItem);
     bool eraseRootItem(DocumentItem* docItem);
 
     Span<DocumentItem* const> rootItems() const;
@@ -40,7 +42,8 @@ public:
     virtual const char* dynTypeName() const;
 
 signals:
-    void itemAdded(DocumentItem* docItem);
+    // Might be emitted from a worker thread(see Application::importInDocument())
+    void itemsAdded(std::vector<DocumentItem*> vecDocItem);
     void itemErased(const DocumentItem* docItem);
     void itemPropertyChanged(DocumentItem* docItem, Property* prop);
 
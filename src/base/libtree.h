@@ -22,6 +22,10 @@ public:
     TreeNodeId nodeChildFirst(TreeNodeId id) const;
     TreeNodeId nodeChildLast(TreeNodeId id) const;
     TreeNodeId nodeParent(TreeNodeId id) const;
+    // Position of the node among the children of its parent (or among roots)
+    int nodeSiblingIndex(TreeNodeId id) const;
+    int nodeChildCount(TreeNodeId id) const;
+    TreeNodeId nodeChild(TreeNodeId id, int index) const;
     const T& nodeData(TreeNodeId id) const;
     Span<const TreeNodeId> roots() const;
 
@@ -35,6 +39,8 @@ private:
         TreeNodeId childFirst;
         TreeNodeId childLast;
         TreeNodeId parent;
+        uint32_t siblingIndex;
+        uint32_t childCount;
         T data;
     };
 
@@ -85,6 +91,32 @@ template<typename T> TreeNodeId Tree<T>::nodeParent(TreeNodeId id) const {
     return node ? node->parent : 0;
 }
 
+template<typename T> int Tree<T>::nodeSiblingIndex(TreeNodeId id) const {
+    const TreeNode* node = this->ptrNode(id);
+    return node ? node->siblingIndex : -1;
+}
+
+template<typename T> int Tree<T>::nodeChildCount(TreeNodeId id) const {
+    const TreeNode* node = this->ptrNode(id);
+    return node ? node->childCount : 0;
+}
+
+template<typename T> TreeNodeId Tree<T>::nodeChild(TreeNodeId id, int index) const {
+    const TreeNode* node = this->ptrNode(id);
+    if (!node || index < 0 || index >= static_cast<int>(node->childCount))
+        return 0;
+
+    // Children appended in a row have contiguous ids, which is the common case
+    if (node->childLast - node->childFirst + 1 == node->childCount)
+        return node->childFirst + index;
+
+    TreeNodeId it = node->childFirst;
+    for (int i = 0; i < index; ++i)
+        it = this->nodeSiblingNext(it);
+
+    return it;
+}
+
 template<typename T> const T& Tree<T>::nodeData(TreeNodeId id) const {
     static const T nullObject = {};
     const TreeNode* node = this->ptrNode(id);
@@ -116,8 +148,11 @@ TreeNodeId Tree<T>::appendChild(TreeNodeId parentId, const T& data)
             this->ptrNode(parentNode->childLast)->siblingNext = nodeId;
 
         parentNode->childLast = nodeId;
+        node->siblingIndex = parentNode->childCount;
+        ++(parentNode->childCount);
     }
     else {
+        node->siblingIndex = static_cast<uint32_t>(m_vecRoot.size());
         m_vecRoot.push_back(nodeId);
     }
 
@@ -0,0 +1,467 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mesh_lod.h"
+#include "brep_utils.h"
+
+#include <fougtools/qttools/task/progress.h>
+#include <BRep_Tool.hxx>
+#include <gp_XYZ.hxx>
+#include <TopoDS_Face.hxx>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace Mayo {
+
+namespace Internal {
+
+// Symmetric 4x4 matrix of the quadric error, upper triangle only
+struct Quadric {
+    std::array<double, 10> m = {};
+
+    static Quadric fromPlane(const gp_XYZ& n, double d) {
+        const double a = n.X();
+        const double b = n.Y();
+        const double c = n.Z();
+        return { { a*a, a*b, a*c, a*d, b*b, b*c, b*d, c*c, c*d, d*d } };
+    }
+
+    void add(const Quadric& other) {
+        for (size_t i = 0; i < m.size(); ++i)
+            m[i] += other.m[i];
+    }
+
+    double error(const gp_XYZ& p) const {
+        const double x = p.X();
+        const double y = p.Y();
+        const double z = p.Z();
+        return m[0]*x*x + 2*m[1]*x*y + 2*m[2]*x*z + 2*m[3]*x
+                + m[4]*y*y + 2*m[5]*y*z + 2*m[6]*y
+                + m[7]*z*z + 2*m[8]*z
+                + m[9];
+    }
+
+    // Point minimizing the error, fails when the 3x3 system is singular(eg
+    // planar or linear neighborhood)
+    bool optimalPoint(gp_XYZ* p) const {
+        const double a00 = m[0], a01 = m[1], a02 = m[2];
+        const double a11 = m[4], a12 = m[5], a22 = m[7];
+        const double c00 = a11*a22 - a12*a12;
+        const double c01 = a02*a12 - a01*a22;
+        const double c02 = a01*a12 - a02*a11;
+        const double det = a00*c00 + a01*c01 + a02*c02;
+        if (std::abs(det) < 1e-9)
+            return false;
+
+        const double c11 = a00*a22 - a02*a02;
+        const double c12 = a01*a02 - a00*a12;
+        const double c22 = a00*a11 - a01*a01;
+        const double b0 = -m[3];
+        const double b1 = -m[6];
+        const double b2 = -m[8];
+        p->SetCoord(
+                    (c00*b0 + c01*b1 + c02*b2) / det,
+                    (c01*b0 + c11*b1 + c12*b2) / det,
+                    (c02*b0 + c12*b1 + c22*b2) / det);
+        return true;
+    }
+};
+
+struct EdgeCollapse {
+    double cost;
+    int v0;
+    int v1;
+    uint32_t stamp0;
+    uint32_t stamp1;
+    gp_XYZ pos;
+
+    bool operator>(const EdgeCollapse& other) const { return cost > other.cost; }
+};
+
+struct PositionHasher {
+    size_t operator()(const std::array<double, 3>& coords) const {
+        const std::hash<double> hasher;
+        size_t h = hasher(coords[0]);
+        h = h * 31 + hasher(coords[1]);
+        h = h * 31 + hasher(coords[2]);
+        return h;
+    }
+};
+
+using Triangle = std::array<int, 3>;
+
+static bool triangleHasVertex(const Triangle& tri, int v)
+{
+    return tri[0] == v || tri[1] == v || tri[2] == v;
+}
+
+static gp_XYZ triangleNormal(const gp_XYZ& p0, const gp_XYZ& p1, const gp_XYZ& p2)
+{
+    return (p1 - p0).Crossed(p2 - p0);
+}
+
+} // namespace Internal
+
+Handle_Poly_Triangulation MeshLod::decimate(
+        const Handle_Poly_Triangulation& mesh, int targetTriangleCount)
+{
+    using namespace Internal;
+    if (mesh.IsNull() || mesh->NbTriangles() <= targetTriangleCount)
+        return mesh;
+
+    // Weld coincident nodes, faces of a triangle soup(eg STL) or of a BRep
+    // shape get connected this way
+    std::vector<gp_XYZ> vecPos;
+    std::vector<int> vecNodeVertex(mesh->NbNodes());
+    {
+        std::unordered_map<std::array<double, 3>, int, PositionHasher> mapPosVertex;
+        mapPosVertex.reserve(mesh->NbNodes());
+        for (int i = 1; i <= mesh->NbNodes(); ++i) {
+            const gp_XYZ pos = mesh->Node(i).XYZ();
+            auto itInsert = mapPosVertex.emplace(
+                        std::array<double, 3>{ pos.X(), pos.Y(), pos.Z() },
+                        static_cast<int>(vecPos.size()));
+            if (itInsert.second)
+                vecPos.push_back(pos);
+
+            vecNodeVertex.at(i - 1) = itInsert.first->second;
+        }
+    }
+
+    std::vector<Triangle> vecTri;
+    vecTri.reserve(mesh->NbTriangles());
+    for (int i = 1; i <= mesh->NbTriangles(); ++i) {
+        int n1, n2, n3;
+        mesh->Triangle(i).Get(n1, n2, n3);
+        const Triangle tri = {
+            vecNodeVertex.at(n1 - 1), vecNodeVertex.at(n2 - 1), vecNodeVertex.at(n3 - 1) };
+        if (tri[0] != tri[1] && tri[1] != tri[2] && tri[0] != tri[2])
+            vecTri.push_back(tri);
+    }
+
+    // Incident triangles, quadrics and edges
+    const int vertexCount = static_cast<int>(vecPos.size());
+    std::vector<std::vector<int>> vecVertexTris(vertexCount);
+    std::vector<Quadric> vecQuadric(vertexCount);
+    std::unordered_map<uint64_t, int> mapEdgeUseCount;
+    mapEdgeUseCount.reserve(vecTri.size() * 2);
+    auto fnEdgeKey = [](int v0, int v1) {
+        return (uint64_t(std::min(v0, v1)) << 32) | uint64_t(std::max(v0, v1));
+    };
+    for (size_t t = 0; t < vecTri.size(); ++t) {
+        const Triangle& tri = vecTri.at(t);
+        gp_XYZ n = triangleNormal(vecPos.at(tri[0]), vecPos.at(tri[1]), vecPos.at(tri[2]));
+        const double nLength = n.Modulus();
+        if (nLength > 0.) {
+            n /= nLength;
+            const Quadric q = Quadric::fromPlane(n, -n.Dot(vecPos.at(tri[0])));
+            for (int v : tri)
+                vecQuadric.at(v).add(q);
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            vecVertexTris.at(tri[i]).push_back(static_cast<int>(t));
+            ++mapEdgeUseCount[fnEdgeKey(tri[i], tri[(i + 1) % 3])];
+        }
+    }
+
+    // Vertices of boundary edges are locked so the outline of the mesh is kept
+    std::vector<bool> vecLocked(vertexCount, false);
+    for (const auto& mapPair : mapEdgeUseCount) {
+        if (mapPair.second == 1) {
+            vecLocked.at(int(mapPair.first >> 32)) = true;
+            vecLocked.at(int(mapPair.first & 0xFFFFFFFF)) = true;
+        }
+    }
+
+    std::vector<uint32_t> vecStamp(vertexCount, 0);
+    std::vector<bool> vecTriRemoved(vecTri.size(), false);
+    std::priority_queue<EdgeCollapse, std::vector<EdgeCollapse>, std::greater<EdgeCollapse>> queueCollapse;
+    auto fnPushEdge = [&](int v0, int v1) {
+        if (vecLocked.at(v0) || vecLocked.at(v1))
+            return;
+
+        Quadric q = vecQuadric.at(v0);
+        q.add(vecQuadric.at(v1));
+        const gp_XYZ& p0 = vecPos.at(v0);
+        const gp_XYZ& p1 = vecPos.at(v1);
+        const gp_XYZ pMid = (p0 + p1) / 2.;
+        gp_XYZ pos;
+        // Optimal point is discarded if far away from the edge(ill-conditioned system)
+        const double edgeSqrLength = (p1 - p0).SquareModulus();
+        if (!q.optimalPoint(&pos) || (pos - pMid).SquareModulus() > 4 * edgeSqrLength) {
+            pos = pMid;
+            for (const gp_XYZ& candidate : { p0, p1 }) {
+                if (q.error(candidate) < q.error(pos))
+                    pos = candidate;
+            }
+        }
+
+        queueCollapse.push({ q.error(pos), v0, v1, vecStamp.at(v0), vecStamp.at(v1), pos });
+    };
+    for (const auto& mapPair : mapEdgeUseCount)
+        fnPushEdge(int(mapPair.first >> 32), int(mapPair.first & 0xFFFFFFFF));
+
+    mapEdgeUseCount.clear();
+
+    // Moving 'v' to 'pos' must not flip any triangle kept after collapse of edge(v, vOther)
+    auto fnCausesFlip = [&](int v, int vOther, const gp_XYZ& pos) {
+        for (int t : vecVertexTris.at(v)) {
+            const Triangle& tri = vecTri.at(t);
+            if (vecTriRemoved.at(t) || triangleHasVertex(tri, vOther))
+                continue;
+
+            const gp_XYZ& p0 = vecPos.at(tri[0]);
+            const gp_XYZ& p1 = vecPos.at(tri[1]);
+            const gp_XYZ& p2 = vecPos.at(tri[2]);
+            const gp_XYZ nOld = triangleNormal(p0, p1, p2);
+            const gp_XYZ nNew = triangleNormal(
+                        tri[0] == v ? pos : p0,
+                        tri[1] == v ? pos : p1,
+                        tri[2] == v ? pos : p2);
+            if (nOld.Dot(nNew) <= 0.)
+                return true;
+        }
+
+        return false;
+    };
+
+    auto fnCollectNeighbors = [&](int v, std::vector<int>* ptrVecNeighbor) {
+        ptrVecNeighbor->clear();
+        for (int t : vecVertexTris.at(v)) {
+            if (vecTriRemoved.at(t))
+                continue;
+
+            for (int vTri : vecTri.at(t)) {
+                if (vTri != v
+                        && std::find(ptrVecNeighbor->cbegin(), ptrVecNeighbor->cend(), vTri)
+                            == ptrVecNeighbor->cend())
+                {
+                    ptrVecNeighbor->push_back(vTri);
+                }
+            }
+        }
+    };
+
+    // Link condition : vertices adjacent to both v0 and v1 must be the opposite
+    // vertices of the triangles sharing edge(v0, v1), otherwise collapse would
+    // create non-manifold edges
+    std::vector<int> vecNeighbor0;
+    std::vector<int> vecNeighbor1;
+    auto fnIsCollapseManifold = [&](int v0, int v1) {
+        int sharedTriCount = 0;
+        for (int t : vecVertexTris.at(v0)) {
+            if (!vecTriRemoved.at(t) && triangleHasVertex(vecTri.at(t), v1))
+                ++sharedTriCount;
+        }
+
+        fnCollectNeighbors(v0, &vecNeighbor0);
+        fnCollectNeighbors(v1, &vecNeighbor1);
+        int commonNeighborCount = 0;
+        for (int v : vecNeighbor0) {
+            if (std::find(vecNeighbor1.cbegin(), vecNeighbor1.cend(), v) != vecNeighbor1.cend())
+                ++commonNeighborCount;
+        }
+
+        return commonNeighborCount == sharedTriCount;
+    };
+
+    int triCount = static_cast<int>(vecTri.size());
+    std::vector<int> vecNeighbor;
+    while (triCount > targetTriangleCount && !queueCollapse.empty()) {
+        const EdgeCollapse collapse = queueCollapse.top();
+        queueCollapse.pop();
+        const int v0 = collapse.v0;
+        const int v1 = collapse.v1;
+        if (collapse.stamp0 != vecStamp.at(v0) || collapse.stamp1 != vecStamp.at(v1))
+            continue; // Outdated
+
+        if (!fnIsCollapseManifold(v0, v1))
+            continue;
+
+        if (fnCausesFlip(v0, v1, collapse.pos) || fnCausesFlip(v1, v0, collapse.pos))
+            continue;
+
+        // Collapse v1 into v0
+        vecPos.at(v0) = collapse.pos;
+        vecQuadric.at(v0).add(vecQuadric.at(v1));
+        std::vector<int>& vecTri0 = vecVertexTris.at(v0);
+        for (int t : vecVertexTris.at(v1)) {
+            if (vecTriRemoved.at(t))
+                continue;
+
+            Triangle& tri = vecTri.at(t);
+            if (triangleHasVertex(tri, v0)) {
+                vecTriRemoved.at(t) = true;
+                --triCount;
+            }
+            else {
+                std::replace(tri.begin(), tri.end(), v1, v0);
+                vecTri0.push_back(t);
+            }
+        }
+
+        vecVertexTris.at(v1) = std::vector<int>();
+        vecTri0.erase(
+                    std::remove_if(vecTri0.begin(), vecTri0.end(), [&](int t) { return vecTriRemoved.at(t); }),
+                    vecTri0.end());
+        ++vecStamp.at(v0);
+        ++vecStamp.at(v1);
+        vecLocked.at(v1) = true; // Dead vertex
+
+        // Update costs of the edges around v0
+        fnCollectNeighbors(v0, &vecNeighbor);
+        for (int v : vecNeighbor)
+            fnPushEdge(v0, v);
+    }
+
+    // Build resulting triangulation from remaining vertices and triangles
+    std::vector<int> vecVertexNode(vertexCount, 0);
+    int nodeCount = 0;
+    for (size_t t = 0; t < vecTri.size(); ++t) {
+        if (vecTriRemoved.at(t))
+            continue;
+
+        for (int v : vecTri.at(t)) {
+            if (vecVertexNode.at(v) == 0)
+                vecVertexNode.at(v) = ++nodeCount;
+        }
+    }
+
+    Handle_Poly_Triangulation result = new Poly_Triangulation(nodeCount, triCount, false);
+    for (int v = 0; v < vertexCount; ++v) {
+        if (vecVertexNode.at(v) != 0)
+            result->ChangeNode(vecVertexNode.at(v)) = gp_Pnt(vecPos.at(v));
+    }
+
+    int triIndex = 0;
+    for (size_t t = 0; t < vecTri.size(); ++t) {
+        if (vecTriRemoved.at(t))
+            continue;
+
+        const Triangle& tri = vecTri.at(t);
+        result->ChangeTriangle(++triIndex).Set(
+                    vecVertexNode.at(tri[0]), vecVertexNode.at(tri[1]), vecVertexNode.at(tri[2]));
+    }
+
+    return result;
+}
+
+std::vector<Handle_Poly_Triangulation> MeshLod::buildLevels(
+        const Handle_Poly_Triangulation& mesh,
+        int levelCount,
+        int reductionFactor,
+        qttask::Progress* progress)
+{
+    // Decimation of levels below this triangle count isn't worth it
+    constexpr int minTriangleCount = 100;
+    std::vector<Handle_Poly_Triangulation> vecLevel;
+    if (mesh.IsNull())
+        return vecLevel;
+
+    vecLevel.push_back(mesh);
+    for (int i = 1; i <= levelCount; ++i) {
+        if (progress && progress->isAbortRequested())
+            break;
+
+        // Each level is decimated from the previous one, which is faster
+        const Handle_Poly_Triangulation& previous = vecLevel.back();
+        const int targetTriangleCount = previous->NbTriangles() / std::max(reductionFactor, 2);
+        if (targetTriangleCount < minTriangleCount)
+            break;
+
+        const Handle_Poly_Triangulation level = MeshLod::decimate(previous, targetTriangleCount);
+        if (level->NbTriangles() >= previous->NbTriangles())
+            break; // Decimation is stuck(eg locked boundaries)
+
+        vecLevel.push_back(level);
+        if (progress)
+            progress->setValue((100 * i) / levelCount);
+    }
+
+    return vecLevel;
+}
+
+Handle_Poly_Triangulation MeshLod::shapeTriangulation(const TopoDS_Shape& shape)
+{
+    return MeshLod::mergeTriangulations(MeshLod::faceTriangulations(shape));
+}
+
+std::vector<MeshLod::FaceTriangulation> MeshLod::faceTriangulations(const TopoDS_Shape& shape)
+{
+    std::vector<FaceTriangulation> vecFaceTri;
+    BRepUtils::forEachSubFace(shape, [&](const TopoDS_Face& face) {
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& polyTri = BRep_Tool::Triangulation(face, loc);
+        if (!polyTri.IsNull())
+            vecFaceTri.push_back({ polyTri, loc, face.Orientation() == TopAbs_REVERSED });
+    });
+
+    return vecFaceTri;
+}
+
+Handle_Poly_Triangulation MeshLod::mergeTriangulations(Span<const FaceTriangulation> spanFaceTri)
+{
+    int nodeCount = 0;
+    int triangleCount = 0;
+    for (const FaceTriangulation& faceTri : spanFaceTri) {
+        nodeCount += faceTri.triangulation->NbNodes();
+        triangleCount += faceTri.triangulation->NbTriangles();
+    }
+
+    if (triangleCount == 0)
+        return Handle_Poly_Triangulation();
+
+    Handle_Poly_Triangulation result = new Poly_Triangulation(nodeCount, triangleCount, false);
+    int nodeOffset = 0;
+    int triangleOffset = 0;
+    for (const FaceTriangulation& faceTri : spanFaceTri) {
+        const Handle_Poly_Triangulation& polyTri = faceTri.triangulation;
+        const gp_Trsf& trsf = faceTri.location.Transformation();
+        for (int i = 1; i <= polyTri->NbNodes(); ++i)
+            result->ChangeNode(nodeOffset + i) = polyTri->Node(i).Transformed(trsf);
+
+        for (int i = 1; i <= polyTri->NbTriangles(); ++i) {
+            int n1, n2, n3;
+            polyTri->Triangle(i).Get(n1, n2, n3);
+            if (faceTri.isReversed)
+                std::swap(n2, n3);
+
+            result->ChangeTriangle(triangleOffset + i).Set(
+                        nodeOffset + n1, nodeOffset + n2, nodeOffset + n3);
+        }
+
+        nodeOffset += polyTri->NbNodes();
+        triangleOffset += polyTri->NbTriangles();
+    }
+
+    return result;
+}
+
+int MeshLod::selectLevel(
+        Span<const int> spanLevelTriangleCount,
+        double projectedArea,
+        double pixelsPerTriangle)
+{
+    if (spanLevelTriangleCount.empty())
+        return -1;
+
+    const double maxTriangleCount = projectedArea / std::max(pixelsPerTriangle, 1e-6);
+    for (int i = 0; i < spanLevelTriangleCount.size(); ++i) {
+        if (spanLevelTriangleCount.at(i) <= maxTriangleCount)
+            return i;
+    }
+
+    return static_cast<int>(spanLevelTriangleCount.size()) - 1;
+}
+
+} // namespace Mayo
@@ -0,0 +1,59 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "span.h"
+#include <Poly_Triangulation.hxx>
+#include <TopLoc_Location.hxx>
+#include <vector>
+class TopoDS_Shape;
+namespace qttask { class Progress; }
+
+namespace Mayo {
+
+// Levels of detail of triangle meshes
+struct MeshLod {
+    // Simplifies 'mesh' down to 'targetTriangleCount' triangles by quadric error
+    // metric edge collapse(Garland & Heckbert). Coincident nodes are welded first,
+    // boundary edges are preserved
+    // Returns 'mesh' if it doesn't have more triangles than targeted
+    static Handle_Poly_Triangulation decimate(
+            const Handle_Poly_Triangulation& mesh, int targetTriangleCount);
+
+    // Returns 'mesh'(level 0) followed by at most 'levelCount' decimated levels,
+    // each level having 'reductionFactor' times less triangles than the previous one
+    static std::vector<Handle_Poly_Triangulation> buildLevels(
+            const Handle_Poly_Triangulation& mesh,
+            int levelCount = 4,
+            int reductionFactor = 4,
+            qttask::Progress* progress = nullptr);
+
+    // Merges the triangulations of the faces of 'shape' into a single mesh,
+    // face locations and orientations are applied
+    static Handle_Poly_Triangulation shapeTriangulation(const TopoDS_Shape& shape);
+
+    // Triangulation of a face as found at the time it was collected
+    // Faces can be meshed again later on, so collecting them first allows to
+    // merge triangulations in another thread without reading the shape
+    struct FaceTriangulation {
+        Handle_Poly_Triangulation triangulation;
+        TopLoc_Location location;
+        bool isReversed;
+    };
+    static std::vector<FaceTriangulation> faceTriangulations(const TopoDS_Shape& shape);
+    static Handle_Poly_Triangulation mergeTriangulations(Span<const FaceTriangulation> spanFaceTri);
+
+    // Index of the finest level whose triangle count fits the area an object
+    // covers on screen, ie 'projectedArea' divided by 'pixelsPerTriangle'
+    // Coarsest level is returned if none fits
+    static int selectLevel(
+            Span<const int> spanLevelTriangleCount,
+            double projectedArea,
+            double pixelsPerTriangle = 4.);
+};
+
+} // namespace Mayo
@@ -5,11 +5,122 @@
 ****************************************************************************/
 
 #include "mesh_utils.h"
+#include <OSD_Parallel.hxx>
 #include <QtCore/QtGlobal>
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace Mayo {
 
+namespace Internal {
+
+// Triangles are reduced per chunk of fixed size, this way the summation order
+// (and so the result) doesn't depend on the number of threads
+constexpr int volumeAreaChunkSize = 64 * 1024;
+
+// Triangles of a chunk are processed per block : coordinates are first gathered
+// in contiguous arrays so the arithmetic loop can be vectorized by the compiler
+constexpr int volumeAreaBlockSize = 256;
+
+static int chunkCount(int itemCount)
+{
+    return (itemCount + volumeAreaChunkSize - 1) / volumeAreaChunkSize;
+}
+
+struct NodeBuffer {
+    void resize(int count) {
+        this->x.resize(count);
+        this->y.resize(count);
+        this->z.resize(count);
+    }
+
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+};
+
+struct KahanSum {
+    void add(double value) {
+        const double y = value - this->compensation;
+        const double t = this->sum + y;
+        this->compensation = (t - this->sum) - y;
+        this->sum = t;
+    }
+
+    double sum = 0.;
+    double compensation = 0.;
+};
+
+static double pairwiseSum(const double* values, int count)
+{
+    if (count <= 8) {
+        double sum = 0.;
+        for (int i = 0; i < count; ++i)
+            sum += values[i];
+
+        return sum;
+    }
+
+    const int half = count / 2;
+    return pairwiseSum(values, half) + pairwiseSum(values + half, count - half);
+}
+
+// Returns the sums of 6*signed_volume and 2*area of triangles [iFirst, iLast[
+static MeshUtils::VolumeArea chunkVolumeArea(
+        const NodeBuffer& nodes,
+        int nodeLower,
+        const Poly_Array1OfTriangle& vecTriangle,
+        int iFirst,
+        int iLast)
+{
+    constexpr int blockSize = volumeAreaBlockSize;
+    double x1[blockSize], y1[blockSize], z1[blockSize];
+    double x2[blockSize], y2[blockSize], z2[blockSize];
+    double x3[blockSize], y3[blockSize], z3[blockSize];
+    double blockVolume[blockSize];
+    double blockArea[blockSize];
+    KahanSum volumeSum;
+    KahanSum areaSum;
+    for (int iBlock = iFirst; iBlock < iLast; iBlock += blockSize) {
+        const int count = std::min(blockSize, iLast - iBlock);
+        for (int i = 0; i < count; ++i) {
+            int v1, v2, v3;
+            vecTriangle.Value(iBlock + i).Get(v1, v2, v3);
+            v1 -= nodeLower;
+            v2 -= nodeLower;
+            v3 -= nodeLower;
+            x1[i] = nodes.x[v1]; y1[i] = nodes.y[v1]; z1[i] = nodes.z[v1];
+            x2[i] = nodes.x[v2]; y2[i] = nodes.y[v2]; z2[i] = nodes.z[v2];
+            x3[i] = nodes.x[v3]; y3[i] = nodes.y[v3]; z3[i] = nodes.z[v3];
+        }
+
+        for (int i = 0; i < count; ++i) {
+            blockVolume[i] =
+                    x1[i] * (y2[i] * z3[i] - z2[i] * y3[i])
+                    + y1[i] * (z2[i] * x3[i] - x2[i] * z3[i])
+                    + z1[i] * (x2[i] * y3[i] - y2[i] * x3[i]);
+            const double ax = x2[i] - x1[i];
+            const double ay = y2[i] - y1[i];
+            const double az = z2[i] - z1[i];
+            const double bx = x3[i] - x1[i];
+            const double by = y3[i] - y1[i];
+            const double bz = z3[i] - z1[i];
+            const double cx = ay*bz - az*by;
+            const double cy = az*bx - ax*bz;
+            const double cz = ax*by - ay*bx;
+            blockArea[i] = std::sqrt(cx*cx + cy*cy + cz*cz);
+        }
+
+        volumeSum.add(pairwiseSum(blockVolume, count));
+        areaSum.add(pairwiseSum(blockArea, count));
+    }
+
+    return { volumeSum.sum, areaSum.sum };
+}
+
+} // namespace Internal
+
 double MeshUtils::triangleSignedVolume(
         const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ& p3)
 {
@@ -34,37 +145,127 @@ double MeshUtils::triangleArea(
 double MeshUtils::triangulationVolume(
         const Handle_Poly_Triangulation& triangulation)
 {
-    double volume = 0;
+    return MeshUtils::triangulationVolumeArea(triangulation).volume;
+}
+
+double MeshUtils::triangulationArea(
+        const Handle_Poly_Triangulation& triangulation)
+{
+    return MeshUtils::triangulationVolumeArea(triangulation).area;
+}
+
+MeshUtils::VolumeArea MeshUtils::triangulationVolumeArea(
+        const Handle_Poly_Triangulation& triangulation)
+{
+    VolumeArea result = {};
+    if (triangulation.IsNull() || triangulation->NbTriangles() <= 0)
+        return result;
+
     const TColgp_Array1OfPnt& vecNode = triangulation->Nodes();
-    // TODO Parallelize computation
-    for (const Poly_Triangle& tri : triangulation->Triangles()) {
-        int v1, v2, v3;
-        tri.Get(v1, v2, v3);
-        volume += MeshUtils::triangleSignedVolume(
-                    vecNode.Value(v1).Coord(),
-                    vecNode.Value(v2).Coord(),
-                    vecNode.Value(v3).Coord());
+    const Poly_Array1OfTriangle& vecTriangle = triangulation->Triangles();
+
+    // Gather node coordinates into structure-of-arrays buffer
+    const int nodeCount = vecNode.Length();
+    const int nodeChunkCount = Internal::chunkCount(nodeCount);
+    Internal::NodeBuffer nodes;
+    nodes.resize(nodeCount);
+    OSD_Parallel::For(0, nodeChunkCount, [&](int iChunk) {
+        const int iFirst = iChunk * Internal::volumeAreaChunkSize;
+        const int iLast = std::min(nodeCount, iFirst + Internal::volumeAreaChunkSize);
+        for (int i = iFirst; i < iLast; ++i) {
+            const gp_XYZ& coords = vecNode.Value(vecNode.Lower() + i).Coord();
+            nodes.x[i] = coords.X();
+            nodes.y[i] = coords.Y();
+            nodes.z[i] = coords.Z();
+        }
+    }, nodeChunkCount == 1);
+
+    // Reduce volume and area per chunk of triangles
+    const int triangleCount = vecTriangle.Length();
+    const int triangleChunkCount = Internal::chunkCount(triangleCount);
+    std::vector<VolumeArea> vecChunkResult(triangleChunkCount);
+    OSD_Parallel::For(0, triangleChunkCount, [&](int iChunk) {
+        const int iFirst = vecTriangle.Lower() + iChunk * Internal::volumeAreaChunkSize;
+        const int iLast = std::min(vecTriangle.Upper() + 1, iFirst + Internal::volumeAreaChunkSize);
+        vecChunkResult.at(iChunk) = Internal::chunkVolumeArea(
+                    nodes, vecNode.Lower(), vecTriangle, iFirst, iLast);
+    }, triangleChunkCount == 1);
+
+    // Sum chunk results, always in the same order
+    Internal::KahanSum volumeSum;
+    Internal::KahanSum areaSum;
+    for (const VolumeArea& chunkResult : vecChunkResult) {
+        volumeSum.add(chunkResult.volume);
+        areaSum.add(chunkResult.area);
     }
 
-    return std::abs(volume);
+    result.volume = std::abs(volumeSum.sum / 6.);
+    result.area = 0.5 * areaSum.sum;
+    return result;
 }
 
-double MeshUtils::triangulationArea(
-        const Handle_Poly_Triangulation& triangulation)
+void MeshUtils::fillPositionNormalBuffer(
+        const Handle_Poly_Triangulation& triangulation, float* buffer)
 {
-    double area = 0;
+    if (triangulation.IsNull())
+        return;
+
     const TColgp_Array1OfPnt& vecNode = triangulation->Nodes();
-    // TODO Parallelize computation
-    for (const Poly_Triangle& tri : triangulation->Triangles()) {
-        int v1, v2, v3;
-        tri.Get(v1, v2, v3);
-        area += MeshUtils::triangleArea(
-                    vecNode.Value(v1).Coord(),
-                    vecNode.Value(v2).Coord(),
-                    vecNode.Value(v3).Coord());
+    const Poly_Array1OfTriangle& vecTriangle = triangulation->Triangles();
+    const int nodeCount = vecNode.Length();
+
+    // Incident triangles of each node, stored contiguously(compressed rows)
+    std::vector<int> vecNodeTriOffset(nodeCount + 1, 0);
+    for (const Poly_Triangle& tri : vecTriangle) {
+        for (int i = 1; i <= 3; ++i)
+            ++vecNodeTriOffset.at(tri.Value(i) - vecNode.Lower() + 1);
     }
 
-    return area;
+    for (int i = 0; i < nodeCount; ++i)
+        vecNodeTriOffset.at(i + 1) += vecNodeTriOffset.at(i);
+
+    std::vector<int> vecNodeTri(vecNodeTriOffset.back());
+    {
+        std::vector<int> vecNodeTriCursor(vecNodeTriOffset.cbegin(), vecNodeTriOffset.cend() - 1);
+        for (int t = vecTriangle.Lower(); t <= vecTriangle.Upper(); ++t) {
+            const Poly_Triangle& tri = vecTriangle.Value(t);
+            for (int i = 1; i <= 3; ++i)
+                vecNodeTri.at(vecNodeTriCursor.at(tri.Value(i) - vecNode.Lower())++) = t;
+        }
+    }
+
+    // Each node only writes its own slot in the buffer
+    const int nodeChunkCount = Internal::chunkCount(nodeCount);
+    OSD_Parallel::For(0, nodeChunkCount, [&](int iChunk) {
+        const int iFirst = iChunk * Internal::volumeAreaChunkSize;
+        const int iLast = std::min(nodeCount, iFirst + Internal::volumeAreaChunkSize);
+        for (int i = iFirst; i < iLast; ++i) {
+            gp_XYZ normal;
+            for (int j = vecNodeTriOffset.at(i); j < vecNodeTriOffset.at(i + 1); ++j) {
+                int n1, n2, n3;
+                vecTriangle.Value(vecNodeTri.at(j)).Get(n1, n2, n3);
+                const gp_XYZ& p1 = vecNode.Value(n1).Coord();
+                const gp_XYZ& p2 = vecNode.Value(n2).Coord();
+                const gp_XYZ& p3 = vecNode.Value(n3).Coord();
+                normal += (p2 - p1).Crossed(p3 - p1); // Length is twice the area
+            }
+
+            const double normalLength = normal.Modulus();
+            if (normalLength > 0.)
+                normal /= normalLength;
+            else
+                normal.SetCoord(0., 0., 1.);
+
+            const gp_XYZ& coords = vecNode.Value(vecNode.Lower() + i).Coord();
+            float* ptrNodeData = buffer + 6 * static_cast<size_t>(i);
+            ptrNodeData[0] = static_cast<float>(coords.X());
+            ptrNodeData[1] = static_cast<float>(coords.Y());
+            ptrNodeData[2] = static_cast<float>(coords.Z());
+            ptrNodeData[3] = static_cast<float>(normal.X());
+            ptrNodeData[4] = static_cast<float>(normal.Y());
+            ptrNodeData[5] = static_cast<float>(normal.Z());
+        }
+    }, nodeChunkCount <= 1);
 }
 
 // Adapted from http://cs.smith.edu/~jorourke/Code/polyorient.C
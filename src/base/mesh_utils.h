@@ -20,6 +20,22 @@ struct MeshUtils {
     static double triangulationVolume(const Handle_Poly_Triangulation& triangulation);
     static double triangulationArea(const Handle_Poly_Triangulation& triangulation);
 
+    // Computes volume and area in one pass over the triangles, triangles are
+    // processed in fixed-size chunks (in parallel) so the result doesn't depend
+    // on the number of threads
+    struct VolumeArea {
+        double volume;
+        double area;
+    };
+    static VolumeArea triangulationVolumeArea(const Handle_Poly_Triangulation& triangulation);
+
+    // Writes per node the interleaved coordinates and normal {x, y, z, nx, ny, nz}
+    // into 'buffer', which must hold 6 * NbNodes() floats. Node normal is the
+    // area-weighted average of the normals of incident triangles
+    // Nodes are processed in parallel
+    static void fillPositionNormalBuffer(
+            const Handle_Poly_Triangulation& triangulation, float* buffer);
+
     enum class Orientation {
         Unknown,
         Clockwise,
@@ -0,0 +1,110 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "os_utils.h"
+
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#  include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#  include <unistd.h>
+#  include <fstream>
+#  include <string>
+#elif defined(Q_OS_MACOS)
+#  include <mach/mach.h>
+#  include <sys/resource.h>
+#  include <sys/sysctl.h>
+#endif
+
+namespace Mayo {
+
+namespace Internal {
+
+#ifdef Q_OS_LINUX
+// Value of field 'name' in /proc/self/status, assuming it's expressed in kB
+static qint64 procStatusMemoryField(const char* name)
+{
+    std::ifstream file("/proc/self/status");
+    std::string field;
+    while (file >> field) {
+        if (field == name) {
+            qint64 kb = -1;
+            file >> kb;
+            return kb >= 0 ? kb * 1024 : -1;
+        }
+    }
+
+    return -1;
+}
+#endif
+
+} // namespace Internal
+
+qint64 OsUtils::processMemoryUsage()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<qint64>(counters.WorkingSetSize);
+    return -1;
+#elif defined(Q_OS_LINUX)
+    return Internal::procStatusMemoryField("VmRSS:");
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info = {};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    const kern_return_t err = task_info(
+                mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count);
+    return err == KERN_SUCCESS ? static_cast<qint64>(info.resident_size) : -1;
+#else
+    return -1;
+#endif
+}
+
+qint64 OsUtils::processPeakMemoryUsage()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+    return -1;
+#elif defined(Q_OS_LINUX)
+    return Internal::procStatusMemoryField("VmHWM:");
+#elif defined(Q_OS_MACOS)
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<qint64>(usage.ru_maxrss); // Bytes on macOS
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+qint64 OsUtils::physicalMemorySize()
+{
+#if defined(Q_OS_WIN)
+    MEMORYSTATUSEX status = {};
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status))
+        return static_cast<qint64>(status.ullTotalPhys);
+    return -1;
+#elif defined(Q_OS_LINUX)
+    const long pageCount = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageCount > 0 && pageSize > 0)
+        return static_cast<qint64>(pageCount) * pageSize;
+    return -1;
+#elif defined(Q_OS_MACOS)
+    int64_t memSize = 0;
+    size_t len = sizeof(memSize);
+    if (sysctlbyname("hw.memsize", &memSize, &len, nullptr, 0) == 0)
+        return static_cast<qint64>(memSize);
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+} // namespace Mayo
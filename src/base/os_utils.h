@@ -0,0 +1,22 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QtGlobal>
+
+namespace Mayo {
+
+struct OsUtils {
+    // Resident memory of the current process, in bytes. Returns -1 if not available
+    static qint64 processMemoryUsage();
+    // Peak resident memory of the current process, in bytes. Returns -1 if not available
+    static qint64 processPeakMemoryUsage();
+    // Total physical memory of the system, in bytes. Returns -1 if not available
+    static qint64 physicalMemorySize();
+};
+
+} // namespace Mayo
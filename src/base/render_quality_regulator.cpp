@@ -0,0 +1,121 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "render_quality_regulator.h"
+#include <algorithm>
+
+namespace Mayo {
+
+namespace Internal {
+
+// Frames rendered at a level before it can be changed again, lets the
+// frame time settle after a change
+static const int minLevelFrameCount = 3;
+
+// Consecutive frames over target time required to lower quality, so isolated
+// slow frames(eg caused by a hiccup of the system) are ignored
+static const int lowerQualityFrameCount = 3;
+
+// Finer level is tried when frames are below this ratio of the target time,
+// as a finer level costs roughly twice as much
+static const double raiseQualityRatio = 0.5;
+
+// Margin above the minimum frame time under which frames are considered as
+// fast as they can be measured
+static const double minFrameTimeMargin = 1.25;
+
+} // namespace Internal
+
+RenderQualityRegulator::RenderQualityRegulator(int levelCount)
+{
+    this->setLevelCount(levelCount);
+}
+
+void RenderQualityRegulator::setLevelCount(int count)
+{
+    m_levelCount = std::max(count, 1);
+    m_level = std::min(m_level, m_levelCount - 1);
+    m_lastInteractionLevel = std::min(m_lastInteractionLevel, m_levelCount - 1);
+}
+
+void RenderQualityRegulator::setTargetFrameTime(double ms)
+{
+    m_targetFrameTime_ms = std::max(ms, 1.);
+}
+
+void RenderQualityRegulator::setMinFrameTime(double ms)
+{
+    m_minFrameTime_ms = std::max(ms, 0.);
+}
+
+int RenderQualityRegulator::begin()
+{
+    m_isInteracting = true;
+    m_stats = Stats();
+    const int level = std::max(m_lastInteractionLevel, 1);
+    m_level = std::min(level, m_levelCount - 1);
+    m_levelFrameCount = 0;
+    m_overTargetFrameCount = 0;
+    return m_level;
+}
+
+int RenderQualityRegulator::addFrameTime(double ms)
+{
+    if (!m_isInteracting)
+        return m_level;
+
+    const int frameCount = ++m_stats.frameCount;
+    m_stats.averageFrameTime_ms += (ms - m_stats.averageFrameTime_ms) / frameCount;
+    m_stats.maxFrameTime_ms = std::max(m_stats.maxFrameTime_ms, ms);
+
+    // Exponential moving average of the frame times at current level
+    if (m_levelFrameCount == 0)
+        m_smoothedFrameTime_ms = ms;
+    else
+        m_smoothedFrameTime_ms = 0.7 * m_smoothedFrameTime_ms + 0.3 * ms;
+
+    const double targetFrameTime_ms = this->effectiveTargetFrameTime();
+    const double raiseQualityFrameTime_ms = std::max(
+                Internal::raiseQualityRatio * targetFrameTime_ms,
+                Internal::minFrameTimeMargin * m_minFrameTime_ms);
+    m_overTargetFrameCount = ms > targetFrameTime_ms ? m_overTargetFrameCount + 1 : 0;
+    ++m_levelFrameCount;
+    if (m_levelFrameCount >= Internal::minLevelFrameCount) {
+        if (m_overTargetFrameCount >= Internal::lowerQualityFrameCount)
+            this->setLevel(m_level + 1);
+        else if (m_smoothedFrameTime_ms < raiseQualityFrameTime_ms)
+            this->setLevel(m_level - 1);
+    }
+
+    return m_level;
+}
+
+void RenderQualityRegulator::end()
+{
+    if (m_isInteracting)
+        m_lastInteractionLevel = m_level;
+
+    m_isInteracting = false;
+    m_level = 0;
+}
+
+double RenderQualityRegulator::effectiveTargetFrameTime() const
+{
+    return std::max(m_targetFrameTime_ms, Internal::minFrameTimeMargin * m_minFrameTime_ms);
+}
+
+void RenderQualityRegulator::setLevel(int level)
+{
+    level = std::max(0, std::min(level, m_levelCount - 1));
+    if (level != m_level) {
+        m_level = level;
+        m_levelFrameCount = 0;
+        m_overTargetFrameCount = 0;
+        ++m_stats.levelChangeCount;
+    }
+}
+
+} // namespace Mayo
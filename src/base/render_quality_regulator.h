@@ -0,0 +1,70 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+namespace Mayo {
+
+// Selects a rendering quality level from measured frame times, so frames keep
+// close to a target time while a view is manipulated
+// Level 0 is full quality, higher levels are cheaper to render
+class RenderQualityRegulator {
+public:
+    RenderQualityRegulator(int levelCount = 1);
+
+    int levelCount() const { return m_levelCount; }
+    void setLevelCount(int count);
+
+    double targetFrameTime() const { return m_targetFrameTime_ms; }
+    void setTargetFrameTime(double ms);
+
+    // Shortest time a frame can be measured with, eg the period of the timer
+    // pacing frames when frame times are measured between consecutive frames
+    // Target time is kept above it, and quality is raised when frames are
+    // close to it as they can't be measured any faster
+    double minFrameTime() const { return m_minFrameTime_ms; }
+    void setMinFrameTime(double ms);
+
+    int currentLevel() const { return m_level; }
+
+    // Starts an interaction at the level reached by the previous one, which
+    // is level 1 at least
+    // Returns the level to render with
+    int begin();
+    // Accounts the time taken by a frame rendered during interaction
+    // Quality is lowered after consecutive frames over target time, and raised
+    // when the average frame time is well below target
+    // Returns the level to render next frame with
+    int addFrameTime(double ms);
+    // Ends interaction, returns to full quality(level 0)
+    void end();
+
+    // Statistics of the current(or last) interaction
+    struct Stats {
+        int frameCount = 0;
+        double averageFrameTime_ms = 0.;
+        double maxFrameTime_ms = 0.;
+        int levelChangeCount = 0;
+    };
+    const Stats& stats() const { return m_stats; }
+
+private:
+    void setLevel(int level);
+    double effectiveTargetFrameTime() const;
+
+    int m_levelCount = 1;
+    double m_targetFrameTime_ms = 33.;
+    double m_minFrameTime_ms = 0.;
+    int m_level = 0;
+    int m_lastInteractionLevel = 1;
+    bool m_isInteracting = false;
+    int m_levelFrameCount = 0;
+    int m_overTargetFrameCount = 0;
+    double m_smoothedFrameTime_ms = 0.;
+    Stats m_stats;
+};
+
+} // namespace Mayo
@@ -0,0 +1,39 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "shape_display_change.h"
+
+namespace Mayo {
+
+ShapeDisplayChange::Update ShapeDisplayChange::requiredUpdate() const
+{
+    switch (this->attribute) {
+    case Attribute::Material:
+    case Attribute::Transparency:
+        return Update::Aspects;
+    case Attribute::Color:
+        // Face boundaries baked in shaded presentation don't follow the aspects
+        if (!this->hasFaceBoundaryDisplayMode && this->isFaceBoundaryShownAfter)
+            return Update::Recompute;
+
+        return Update::Aspects;
+    case Attribute::DisplayMode:
+        if (!this->hasFaceBoundaryDisplayMode
+                && this->isFaceBoundaryShownBefore != this->isFaceBoundaryShownAfter)
+        {
+            return Update::Recompute;
+        }
+
+        if (this->displayModeBefore != this->displayModeAfter)
+            return Update::SwitchDisplayMode;
+
+        return Update::None;
+    }
+
+    return Update::Recompute;
+}
+
+} // namespace Mayo
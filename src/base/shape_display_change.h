@@ -0,0 +1,41 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+namespace Mayo {
+
+// Change of a display attribute of shape presentations already computed
+// Tells if the change can be shown by updating aspects(or switching to another
+// display mode) or if presentations have to be computed again
+struct ShapeDisplayChange {
+    enum class Attribute {
+        Color,
+        Material,
+        Transparency,
+        DisplayMode
+    };
+
+    enum class Update {
+        None,
+        Aspects,
+        SwitchDisplayMode,
+        Recompute
+    };
+
+    Attribute attribute = Attribute::Color;
+    // Face boundaries are drawn in a display mode of their own, otherwise they
+    // are part of the shaded presentation
+    bool hasFaceBoundaryDisplayMode = true;
+    bool isFaceBoundaryShownBefore = false;
+    bool isFaceBoundaryShownAfter = false;
+    int displayModeBefore = 0;
+    int displayModeAfter = 0;
+
+    Update requiredUpdate() const;
+};
+
+} // namespace Mayo
@@ -0,0 +1,690 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "stl_reader.h"
+
+#include <fougtools/qttools/task/progress.h>
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QtEndian>
+
+#include <OSD_Parallel.hxx>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace Mayo {
+
+namespace Internal {
+
+constexpr int binaryStlHeaderSize = 80 + sizeof(uint32_t);
+constexpr int binaryStlFacetSize = (12 * sizeof(float)) + sizeof(uint16_t);
+
+// Count of triangles processed by a parallel task
+constexpr int triangleChunkSize = 64 * 1024;
+
+// Vertices are dispatched in partitions (on the high bits of their hash) which are
+// then merged independently and in parallel. Partition count is fixed so node
+// numbering doesn't depend on the number of threads
+constexpr int vertexPartitionBits = 6;
+constexpr int vertexPartitionCount = 1 << vertexPartitionBits;
+
+using Vec3f = std::array<float, 3>;
+
+static int chunkCount(int itemCount, int chunkSize)
+{
+    return (itemCount + chunkSize - 1) / chunkSize;
+}
+
+static uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(float));
+    return bits != 0x80000000u ? bits : 0u; // -0.f and +0.f are the same coordinate
+}
+
+static uint32_t vertexHash(const Vec3f& coords)
+{
+    uint32_t h = (floatBits(coords[0]) * 0x8da6b343u)
+            ^ (floatBits(coords[1]) * 0xd8163841u)
+            ^ (floatBits(coords[2]) * 0xcb1ab31fu);
+    // Final avalanche step of MurmurHash3
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static bool vertexEqual(const Vec3f& lhs, const Vec3f& rhs)
+{
+    return floatBits(lhs[0]) == floatBits(rhs[0])
+            && floatBits(lhs[1]) == floatBits(rhs[1])
+            && floatBits(lhs[2]) == floatBits(rhs[2]);
+}
+
+static int vertexPartition(uint32_t hash)
+{
+    return static_cast<int>(hash >> (32 - vertexPartitionBits));
+}
+
+static uint32_t nextPowerOfTwo(uint32_t value)
+{
+    uint32_t pow2 = 1;
+    while (pow2 < value)
+        pow2 <<= 1;
+
+    return pow2;
+}
+
+static float readFloatLE(const uchar* bytes)
+{
+    const uint32_t bits = qFromLittleEndian<quint32>(bytes);
+    float value;
+    std::memcpy(&value, &bits, sizeof(float));
+    return value;
+}
+
+static void setProgressValue(qttask::Progress* progress, int pct)
+{
+    if (progress)
+        progress->setValue(pct);
+}
+
+static bool isAbortRequested(const qttask::Progress* progress)
+{
+    return progress ? progress->isAbortRequested() : false;
+}
+
+// Same as StlReader::createTriangulation(), progress value is reported within
+// range [pctBegin, pctEnd]
+// 'fnVertex' is a callable int -> Vec3f giving the coordinates of a vertex, the
+// vertices of triangle 'i' are '3*i', '3*i+1' and '3*i+2'. It's called concurrently
+// and several times per vertex, so input data can be read in place
+template<typename VERTEX_FUNC>
+static Handle_Poly_Triangulation createTriangulation(
+        VERTEX_FUNC fnVertex,
+        int triangleCount,
+        qttask::Progress* progress,
+        int pctBegin,
+        int pctEnd)
+{
+    if (triangleCount <= 0 || triangleCount > INT_MAX / 3)
+        return Handle_Poly_Triangulation();
+
+    auto fnProgress = [=](int pctStage) {
+        setProgressValue(progress, pctBegin + (pctStage * (pctEnd - pctBegin)) / 100);
+    };
+
+    const int vertexCount = 3 * triangleCount;
+    constexpr int vertexChunkSize = 3 * triangleChunkSize;
+    const int vertexChunkCount = chunkCount(vertexCount, vertexChunkSize);
+    constexpr int partCount = vertexPartitionCount;
+
+    // Count vertices per chunk and per partition
+    std::vector<int> vecChunkPartCount(vertexChunkCount * partCount, 0);
+    OSD_Parallel::For(0, vertexChunkCount, [&](int iChunk) {
+        const int iFirst = iChunk * vertexChunkSize;
+        const int iLast = std::min(vertexCount, iFirst + vertexChunkSize);
+        int* partCounts = vecChunkPartCount.data() + iChunk * partCount;
+        for (int i = iFirst; i < iLast; ++i)
+            ++partCounts[vertexPartition(vertexHash(fnVertex(i)))];
+    }, vertexChunkCount == 1);
+
+    // Offsets of chunk vertices in partition-major order
+    std::vector<int> vecPartBegin(partCount + 1, 0);
+    std::vector<int> vecChunkPartOffset(vecChunkPartCount.size());
+    {
+        int offset = 0;
+        for (int iPart = 0; iPart < partCount; ++iPart) {
+            vecPartBegin.at(iPart) = offset;
+            for (int iChunk = 0; iChunk < vertexChunkCount; ++iChunk) {
+                const int id = iChunk * partCount + iPart;
+                vecChunkPartOffset.at(id) = offset;
+                offset += vecChunkPartCount.at(id);
+            }
+        }
+
+        vecPartBegin.at(partCount) = offset;
+    }
+
+    // Dispatch vertices in partitions, preserving the order of the input
+    std::vector<int> vecPartVertex(vertexCount);
+    OSD_Parallel::For(0, vertexChunkCount, [&](int iChunk) {
+        const int iFirst = iChunk * vertexChunkSize;
+        const int iLast = std::min(vertexCount, iFirst + vertexChunkSize);
+        int* partOffsets = vecChunkPartOffset.data() + iChunk * partCount;
+        for (int i = iFirst; i < iLast; ++i) {
+            const int iPart = vertexPartition(vertexHash(fnVertex(i)));
+            vecPartVertex[partOffsets[iPart]++] = i;
+        }
+    }, vertexChunkCount == 1);
+
+    if (isAbortRequested(progress))
+        return Handle_Poly_Triangulation();
+
+    fnProgress(30);
+
+    // Merge coincident vertices of each partition with an open-addressing hash
+    // table. Unique vertices of a partition are stored in vecPartUniqueVertex
+    // at the same offset as the partition in vecPartVertex
+    std::vector<int> vecVertexNode(vertexCount);
+    std::vector<int> vecPartUniqueVertex(vertexCount);
+    std::vector<int> vecPartUniqueCount(partCount, 0);
+    OSD_Parallel::For(0, partCount, [&](int iPart) {
+        const int partBegin = vecPartBegin.at(iPart);
+        const int partSize = vecPartBegin.at(iPart + 1) - partBegin;
+        if (partSize == 0)
+            return;
+
+        const uint32_t tableSize = nextPowerOfTwo(std::max(16, 2 * partSize));
+        const uint32_t tableMask = tableSize - 1;
+        std::vector<int> table(tableSize, -1);
+        int* uniqueVertices = vecPartUniqueVertex.data() + partBegin;
+        int uniqueCount = 0;
+        for (int i = partBegin; i < partBegin + partSize; ++i) {
+            const int iVertex = vecPartVertex[i];
+            const Vec3f vertex = fnVertex(iVertex);
+            uint32_t slot = vertexHash(vertex) & tableMask;
+            while (table[slot] != -1 && !vertexEqual(fnVertex(uniqueVertices[table[slot]]), vertex))
+                slot = (slot + 1) & tableMask;
+
+            if (table[slot] == -1) {
+                table[slot] = uniqueCount;
+                uniqueVertices[uniqueCount] = iVertex;
+                ++uniqueCount;
+            }
+
+            vecVertexNode[iVertex] = table[slot];
+        }
+
+        vecPartUniqueCount.at(iPart) = uniqueCount;
+    });
+
+    if (isAbortRequested(progress))
+        return Handle_Poly_Triangulation();
+
+    fnProgress(70);
+
+    // Node numbering : partition after partition
+    std::vector<int> vecPartNodeOffset(partCount, 0);
+    int nodeCount = 0;
+    for (int iPart = 0; iPart < partCount; ++iPart) {
+        vecPartNodeOffset.at(iPart) = nodeCount;
+        nodeCount += vecPartUniqueCount.at(iPart);
+    }
+
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(nodeCount, triangleCount, false);
+    OSD_Parallel::For(0, partCount, [&](int iPart) {
+        const int partBegin = vecPartBegin.at(iPart);
+        const int partEnd = vecPartBegin.at(iPart + 1);
+        const int nodeOffset = vecPartNodeOffset.at(iPart);
+        const int* uniqueVertices = vecPartUniqueVertex.data() + partBegin;
+        for (int i = 0; i < vecPartUniqueCount.at(iPart); ++i) {
+            const Vec3f vertex = fnVertex(uniqueVertices[i]);
+            mesh->ChangeNode(nodeOffset + i + 1).SetCoord(vertex[0], vertex[1], vertex[2]);
+        }
+
+        for (int i = partBegin; i < partEnd; ++i)
+            vecVertexNode[vecPartVertex[i]] += nodeOffset + 1;
+    });
+
+    const int triangleChunkCount = chunkCount(triangleCount, triangleChunkSize);
+    OSD_Parallel::For(0, triangleChunkCount, [&](int iChunk) {
+        const int iFirst = iChunk * triangleChunkSize;
+        const int iLast = std::min(triangleCount, iFirst + triangleChunkSize);
+        for (int i = iFirst; i < iLast; ++i) {
+            const int* nodes = vecVertexNode.data() + 3 * i;
+            mesh->ChangeTriangle(i + 1).Set(nodes[0], nodes[1], nodes[2]);
+        }
+    }, triangleChunkCount == 1);
+
+    fnProgress(100);
+    return mesh;
+}
+
+// Vertex callable for createTriangulation() over an array of 9*triangleCount floats
+static auto coordArrayVertexFunc(const float* coords)
+{
+    return [=](int iVertex) {
+        const float* vertex = coords + 3 * size_t(iVertex);
+        return Vec3f{{ vertex[0], vertex[1], vertex[2] }};
+    };
+}
+
+// Triangulation is built straight from the mapped file, facets are not copied
+static StlReader::ReadResult readBinary(
+        const uchar* bytes, qint64 size, qttask::Progress* progress)
+{
+    const uint32_t facetCount = qFromLittleEndian<quint32>(bytes + 80);
+    const qint64 facetsSize = qint64(facetCount) * binaryStlFacetSize;
+    if (facetCount > INT_MAX / 3 || size < Internal::binaryStlHeaderSize + facetsSize)
+        return StlReader::ReadResult::error(StlReader::tr("Invalid binary STL file"));
+
+    const int triangleCount = static_cast<int>(facetCount);
+    const uchar* facets = bytes + binaryStlHeaderSize;
+    auto fnVertex = [=](int iVertex) {
+        // Skip facet normal, it's recomputed anyway
+        const uchar* vertex =
+                facets + (size_t(iVertex / 3) * binaryStlFacetSize) + ((1 + iVertex % 3) * sizeof(Vec3f));
+        return Vec3f{{
+                readFloatLE(vertex),
+                readFloatLE(vertex + sizeof(float)),
+                readFloatLE(vertex + 2 * sizeof(float)) }};
+    };
+
+    StlReader::Solid solid;
+    if (triangleCount > 0) {
+        solid.mesh = createTriangulation(fnVertex, triangleCount, progress, 0, 100);
+        if (solid.mesh.IsNull())
+            return StlReader::ReadResult::error(StlReader::tr("Aborted"));
+    }
+
+    std::vector<StlReader::Solid> vecSolid;
+    vecSolid.push_back(std::move(solid));
+    return StlReader::ReadResult::ok(std::move(vecSolid));
+}
+
+
+// Size of the text chunks parsed in parallel. Chunk boundaries are moved right
+// after the next "endfacet" token so a chunk always contains whole facets
+constexpr qint64 asciiChunkSize = 4 * 1024 * 1024;
+
+struct AsciiSolidMarker {
+    int facetIndex; // Index of the first facet of the solid
+    QString name;
+};
+
+struct AsciiChunk {
+    std::vector<float> vecCoord;
+    std::vector<AsciiSolidMarker> vecSolidMarker; // Facet indexes are relative to the chunk
+    int facetCount = 0;
+    const char* errorPos = nullptr;
+};
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static char toLowerAscii(char c)
+{
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+// Keywords are case-insensitive, some exporters write them in upper case
+// 'keyword' is expected in lower case
+static bool isKeyword(std::string_view word, std::string_view keyword)
+{
+    return word.size() == keyword.size()
+            && std::equal(word.cbegin(), word.cend(), keyword.cbegin(), [](char lhs, char rhs) {
+                return toLowerAscii(lhs) == rhs;
+            });
+}
+
+// Case-insensitive version of std::string_view::find(), 'keyword' is expected
+// in lower case
+static size_t findKeyword(std::string_view contents, std::string_view keyword, size_t pos)
+{
+    if (pos >= contents.size())
+        return std::string_view::npos;
+
+    const auto itFound = std::search(
+                contents.cbegin() + pos, contents.cend(),
+                keyword.cbegin(), keyword.cend(),
+                [](char lhs, char rhs) { return toLowerAscii(lhs) == rhs; });
+    return itFound != contents.cend() ? itFound - contents.cbegin() : std::string_view::npos;
+}
+
+static const char* skipSpaces(const char* it, const char* end)
+{
+    while (it != end && isSpace(*it))
+        ++it;
+
+    return it;
+}
+
+static const char* findLineEnd(const char* it, const char* end)
+{
+    while (it != end && *it != '\n' && *it != '\r')
+        ++it;
+
+    return it;
+}
+
+// Locale-independent parsing of a floating point number, in the spirit of
+// std::from_chars(). Handles the formats produced by STL exporters : optional
+// sign, decimal digits, optional fraction and optional exponent
+static bool parseFloat(const char** pos, const char* end, float* value)
+{
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    constexpr int maxDigitCount = 19; // Fits in uint64_t
+
+    const char* it = skipSpaces(*pos, end);
+    bool isNegative = false;
+    if (it != end && (*it == '-' || *it == '+')) {
+        isNegative = *it == '-';
+        ++it;
+    }
+
+    uint64_t mantissa = 0;
+    int digitCount = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    for (; it != end && isDigit(*it); ++it) {
+        hasDigits = true;
+        if (digitCount < maxDigitCount) {
+            mantissa = mantissa * 10 + (*it - '0');
+            digitCount += mantissa != 0 ? 1 : 0;
+        }
+        else {
+            ++exponent;
+        }
+    }
+
+    if (it != end && *it == '.') {
+        for (++it; it != end && isDigit(*it); ++it) {
+            hasDigits = true;
+            if (digitCount < maxDigitCount) {
+                mantissa = mantissa * 10 + (*it - '0');
+                digitCount += mantissa != 0 ? 1 : 0;
+                --exponent;
+            }
+        }
+    }
+
+    if (!hasDigits)
+        return false;
+
+    if (it != end && (*it == 'e' || *it == 'E')) {
+        const char* itExp = it + 1;
+        bool isExpNegative = false;
+        if (itExp != end && (*itExp == '-' || *itExp == '+')) {
+            isExpNegative = *itExp == '-';
+            ++itExp;
+        }
+
+        if (itExp != end && isDigit(*itExp)) {
+            int exp = 0;
+            for (; itExp != end && isDigit(*itExp); ++itExp) {
+                if (exp < 10000)
+                    exp = exp * 10 + (*itExp - '0');
+            }
+
+            exponent += isExpNegative ? -exp : exp;
+            it = itExp;
+        }
+    }
+
+    if (it != end && !isSpace(*it))
+        return false;
+
+    double result = 0.;
+    if (mantissa != 0) {
+        // Fast path is exact when both mantissa and power of 10 are exactly
+        // representable as double
+        if (mantissa <= (uint64_t(1) << 53) && -22 <= exponent && exponent <= 22) {
+            result = exponent >= 0 ?
+                        double(mantissa) * pow10[exponent] :
+                        double(mantissa) / pow10[-exponent];
+        }
+        else {
+            result = double(mantissa) * std::pow(10., exponent);
+        }
+    }
+
+    *value = static_cast<float>(isNegative ? -result : result);
+    *pos = it;
+    return true;
+}
+
+static void parseAsciiChunk(const char* begin, const char* end, AsciiChunk* chunk)
+{
+    const char* it = begin;
+    int facetVertexCount = 0;
+    while (true) {
+        it = skipSpaces(it, end);
+        if (it == end)
+            break;
+
+        const char* wordBegin = it;
+        while (it != end && !isSpace(*it))
+            ++it;
+
+        const std::string_view word(wordBegin, it - wordBegin);
+        if (isKeyword(word, "vertex")) {
+            float coords[3];
+            for (float& coord : coords) {
+                if (!parseFloat(&it, end, &coord)) {
+                    chunk->errorPos = wordBegin;
+                    return;
+                }
+            }
+
+            if (facetVertexCount >= 3) {
+                chunk->errorPos = wordBegin;
+                return;
+            }
+
+            chunk->vecCoord.insert(chunk->vecCoord.end(), std::begin(coords), std::end(coords));
+            ++facetVertexCount;
+        }
+        else if (isKeyword(word, "facet")) {
+            // Skip facet normal, it's recomputed anyway
+            it = findLineEnd(it, end);
+            facetVertexCount = 0;
+        }
+        else if (isKeyword(word, "outer") || isKeyword(word, "endsolid")) {
+            it = findLineEnd(it, end);
+        }
+        else if (isKeyword(word, "endloop")) {
+        }
+        else if (isKeyword(word, "endfacet")) {
+            if (facetVertexCount != 3) {
+                chunk->errorPos = wordBegin;
+                return;
+            }
+
+            ++chunk->facetCount;
+            facetVertexCount = 0;
+        }
+        else if (isKeyword(word, "solid")) {
+            const char* lineEnd = findLineEnd(it, end);
+            const QString name = QString::fromUtf8(it, lineEnd - it).trimmed();
+            chunk->vecSolidMarker.push_back({ chunk->facetCount, name });
+            it = lineEnd;
+        }
+        else {
+            chunk->errorPos = wordBegin;
+            return;
+        }
+    }
+}
+
+static StlReader::ReadResult readAscii(
+        const uchar* bytes, qint64 size, qttask::Progress* progress)
+{
+    const char* contentsBegin = reinterpret_cast<const char*>(bytes);
+    const char* contentsEnd = contentsBegin + size;
+    const std::string_view contents(contentsBegin, size);
+
+    // Split contents in chunks
+    std::vector<const char*> vecChunkBoundary;
+    vecChunkBoundary.push_back(contentsBegin);
+    {
+        constexpr std::string_view endFacetToken = "endfacet";
+        qint64 pos = asciiChunkSize;
+        while (pos < size) {
+            const size_t posFound = findKeyword(contents, endFacetToken, pos);
+            if (posFound == std::string_view::npos)
+                break;
+
+            pos = posFound + endFacetToken.size();
+            vecChunkBoundary.push_back(contentsBegin + pos);
+            pos += asciiChunkSize;
+        }
+
+        if (vecChunkBoundary.back() != contentsEnd)
+            vecChunkBoundary.push_back(contentsEnd);
+    }
+
+    // Parse chunks
+    const int asciiChunkCount = static_cast<int>(vecChunkBoundary.size()) - 1;
+    std::vector<AsciiChunk> vecChunk(asciiChunkCount);
+    std::atomic<bool> abortRequested = {};
+    OSD_Parallel::For(0, asciiChunkCount, [&](int iChunk) {
+        if (abortRequested || isAbortRequested(progress)) {
+            abortRequested = true;
+            return;
+        }
+
+        parseAsciiChunk(
+                    vecChunkBoundary.at(iChunk),
+                    vecChunkBoundary.at(iChunk + 1),
+                    &vecChunk.at(iChunk));
+    }, asciiChunkCount == 1);
+
+    if (abortRequested)
+        return StlReader::ReadResult::error(StlReader::tr("Aborted"));
+
+    // Merge chunks, solid markers get global facet indexes
+    int facetCount = 0;
+    std::vector<AsciiSolidMarker> vecSolidMarker;
+    for (const AsciiChunk& chunk : vecChunk) {
+        if (chunk.errorPos) {
+            return StlReader::ReadResult::error(
+                        StlReader::tr("Parsing error at offset %1").arg(chunk.errorPos - contentsBegin));
+        }
+
+        if (chunk.facetCount > INT_MAX / 3 - facetCount)
+            return StlReader::ReadResult::error(StlReader::tr("Too many facets"));
+
+        for (const AsciiSolidMarker& marker : chunk.vecSolidMarker)
+            vecSolidMarker.push_back({ facetCount + marker.facetIndex, marker.name });
+
+        facetCount += chunk.facetCount;
+    }
+
+    std::vector<float> vecCoord;
+    vecCoord.reserve(9 * size_t(facetCount));
+    for (AsciiChunk& chunk : vecChunk) {
+        vecCoord.insert(vecCoord.end(), chunk.vecCoord.cbegin(), chunk.vecCoord.cend());
+        chunk.vecCoord = std::vector<float>();
+    }
+
+    if (vecSolidMarker.empty() || vecSolidMarker.front().facetIndex != 0)
+        vecSolidMarker.insert(vecSolidMarker.begin(), { 0, QString() });
+
+    setProgressValue(progress, 40);
+
+    // Create one triangulation per solid
+    std::vector<StlReader::Solid> vecSolid;
+    for (size_t i = 0; i < vecSolidMarker.size(); ++i) {
+        const int iFacetFirst = vecSolidMarker.at(i).facetIndex;
+        const int iFacetEnd =
+                i + 1 < vecSolidMarker.size() ? vecSolidMarker.at(i + 1).facetIndex : facetCount;
+        if (iFacetEnd <= iFacetFirst)
+            continue; // Empty solid
+
+        StlReader::Solid solid;
+        solid.name = vecSolidMarker.at(i).name;
+        solid.mesh = createTriangulation(
+                    coordArrayVertexFunc(vecCoord.data() + 9 * size_t(iFacetFirst)),
+                    iFacetEnd - iFacetFirst,
+                    progress,
+                    40 + (60 * qint64(iFacetFirst)) / facetCount,
+                    40 + (60 * qint64(iFacetEnd)) / facetCount);
+        if (solid.mesh.IsNull())
+            return StlReader::ReadResult::error(StlReader::tr("Aborted"));
+
+        vecSolid.push_back(std::move(solid));
+    }
+
+    return StlReader::ReadResult::ok(std::move(vecSolid));
+}
+
+} // namespace Internal
+
+StlReader::ReadResult StlReader::readFile(
+        const QString& filepath, qttask::Progress* progress)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly))
+        return ReadResult::error(file.errorString());
+
+    const qint64 fileSize = file.size();
+    const uchar* bytes = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    if (!bytes)
+        return ReadResult::error(tr("Failed to map file in memory: %1").arg(file.errorString()));
+
+    if (progress)
+        progress->setStep(tr("Reading file"));
+
+    if (StlReader::isBinaryContents(bytes, fileSize))
+        return Internal::readBinary(bytes, fileSize, progress);
+    else
+        return Internal::readAscii(bytes, fileSize, progress);
+}
+
+bool StlReader::isBinaryFile(const QString& filepath)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    uchar header[Internal::binaryStlHeaderSize];
+    if (file.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header))
+        return false;
+
+    return StlReader::isBinaryContents(header, file.size());
+}
+
+bool StlReader::isBinaryContents(const uchar* bytes, qint64 size)
+{
+    if (size < Internal::binaryStlHeaderSize)
+        return false;
+
+    // Some exporters append data after the facets, so the size can exceed the
+    // one announced by the header
+    const quint32 facetCount = qFromLittleEndian<quint32>(bytes + 80);
+    const qint64 expectedSize =
+            Internal::binaryStlHeaderSize + qint64(facetCount) * Internal::binaryStlFacetSize;
+    if (size == expectedSize)
+        return true;
+    else if (size < expectedSize)
+        return false;
+
+    // Facet count of an ASCII file is made of text bytes, so it's huge and only
+    // very large files can reach here. Binary header always has non-text bytes
+    // (at least in the facet count)
+    auto fnIsTextByte = [](uchar c) { return (c >= 0x20 && c < 0x7F) || Internal::isSpace(c); };
+    return !std::all_of(bytes, bytes + Internal::binaryStlHeaderSize, fnIsTextByte);
+}
+
+Handle_Poly_Triangulation StlReader::createTriangulation(
+        const float* coords, int triangleCount, qttask::Progress* progress)
+{
+    return Internal::createTriangulation(
+                Internal::coordArrayVertexFunc(coords), triangleCount, progress, 0, 100);
+}
+
+} // namespace Mayo
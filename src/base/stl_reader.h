@@ -0,0 +1,45 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "result.h"
+#include <QtCore/QCoreApplication>
+#include <QtCore/QString>
+#include <Poly_Triangulation.hxx>
+#include <vector>
+
+namespace qttask { class Progress; }
+
+namespace Mayo {
+
+// Native STL reader, supports binary and ASCII formats
+// The input file is memory-mapped and facets are parsed in parallel chunks.
+// Coincident vertices are merged, so resulting triangulations share nodes.
+// ASCII files can contain multiple solids, each one gives a separate Solid object
+class StlReader {
+    Q_DECLARE_TR_FUNCTIONS(Mayo::StlReader)
+public:
+    struct Solid {
+        QString name;
+        Handle_Poly_Triangulation mesh;
+    };
+
+    using ReadResult = Result<std::vector<Solid>>;
+
+    static ReadResult readFile(const QString& filepath, qttask::Progress* progress = nullptr);
+
+    static bool isBinaryFile(const QString& filepath);
+    static bool isBinaryContents(const uchar* bytes, qint64 size);
+
+    // Creates a triangulation from raw triangles where coincident vertices are
+    // merged. 'coords' is an array of 9*triangleCount floats (3 vertices per
+    // triangle)
+    static Handle_Poly_Triangulation createTriangulation(
+            const float* coords, int triangleCount, qttask::Progress* progress = nullptr);
+};
+
+} // namespace Mayo
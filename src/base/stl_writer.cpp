@@ -0,0 +1,285 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "stl_writer.h"
+
+#include <QtCore/QtEndian>
+
+#include <BRep_Tool.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#if __has_include(<charconv>)
+#  include <charconv>
+#endif
+
+namespace Mayo {
+
+namespace Internal {
+
+constexpr int stlBufferSize = 4 * 1024 * 1024;
+constexpr int binaryStlHeaderSize = 80;
+constexpr int binaryStlFacetSize = (12 * sizeof(float)) + sizeof(uint16_t);
+// Upper bound of an ASCII facet size, a float takes at most 16 characters
+constexpr int asciiStlFacetMaxSize = 512;
+
+static char* appendText(char* buffer, const char* text)
+{
+    const size_t len = std::strlen(text);
+    std::memcpy(buffer, text, len);
+    return buffer + len;
+}
+
+static char* appendFloats(char* buffer, const float* values)
+{
+    buffer = StlWriter::formatFloat(buffer, values[0]);
+    *buffer++ = ' ';
+    buffer = StlWriter::formatFloat(buffer, values[1]);
+    *buffer++ = ' ';
+    buffer = StlWriter::formatFloat(buffer, values[2]);
+    *buffer++ = '\n';
+    return buffer;
+}
+
+static char* appendFloatLE(char* buffer, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(float));
+    qToLittleEndian(bits, buffer);
+    return buffer + sizeof(uint32_t);
+}
+
+static void computeNormal(const float* coords, float* normal)
+{
+    const double u[3] = {
+        double(coords[3]) - coords[0], double(coords[4]) - coords[1], double(coords[5]) - coords[2]
+    };
+    const double v[3] = {
+        double(coords[6]) - coords[0], double(coords[7]) - coords[1], double(coords[8]) - coords[2]
+    };
+    double n[3] = {
+        u[1] * v[2] - u[2] * v[1],
+        u[2] * v[0] - u[0] * v[2],
+        u[0] * v[1] - u[1] * v[0]
+    };
+    const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    for (int i = 0; i < 3; ++i)
+        normal[i] = length > 0. ? static_cast<float>(n[i] / length) : 0.f;
+}
+
+} // namespace Internal
+
+StlWriter::StlWriter(Format format)
+    : m_format(format)
+{
+}
+
+StlWriter::~StlWriter()
+{
+    if (m_file.isOpen())
+        this->close();
+}
+
+StlWriter::WriteResult StlWriter::open(const QString& filepath)
+{
+    // Output is buffered here by large blocks, no need for QFile internal buffer
+    m_file.setFileName(filepath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+        return WriteResult::error(m_file.errorString());
+
+    m_buffer.resize(Internal::stlBufferSize);
+    m_bufferPos = 0;
+    m_triangleCount = 0;
+    m_hasError = false;
+    if (m_format == Format::Binary) {
+        // Header must not start with "solid", count of triangles is written by close()
+        char* header = m_buffer.data();
+        std::memset(header, 0, Internal::binaryStlHeaderSize + sizeof(uint32_t));
+        Internal::appendText(header, "Binary STL written by Mayo");
+        m_bufferPos = Internal::binaryStlHeaderSize + sizeof(uint32_t);
+    }
+
+    return WriteResult::ok();
+}
+
+StlWriter::WriteResult StlWriter::close()
+{
+    if (!m_file.isOpen())
+        return WriteResult::error(tr("File is not open"));
+
+    if (m_isSolidOpen)
+        this->endSolid();
+
+    this->flush();
+    if (m_format == Format::Binary && !m_hasError) {
+        if (m_triangleCount > std::numeric_limits<uint32_t>::max()) {
+            m_file.close();
+            return WriteResult::error(tr("Too many triangles for binary STL format"));
+        }
+
+        char bytesCount[sizeof(uint32_t)];
+        qToLittleEndian(static_cast<uint32_t>(m_triangleCount), bytesCount);
+        m_hasError =
+                !m_file.seek(Internal::binaryStlHeaderSize)
+                || m_file.write(bytesCount, sizeof(bytesCount)) != sizeof(bytesCount);
+    }
+
+    const QString errorText = m_file.errorString();
+    m_file.close();
+    m_buffer = std::vector<char>();
+    return !m_hasError ? WriteResult::ok() : WriteResult::error(errorText);
+}
+
+void StlWriter::beginSolid(const QString& name)
+{
+    if (m_isSolidOpen)
+        this->endSolid();
+
+    m_isSolidOpen = true;
+    if (m_format != Format::Ascii)
+        return;
+
+    m_solidName = name.toUtf8();
+    std::replace(m_solidName.begin(), m_solidName.end(), '\n', ' ');
+    std::replace(m_solidName.begin(), m_solidName.end(), '\r', ' ');
+    this->reserve(m_solidName.size() + 16);
+    char* out = m_buffer.data() + m_bufferPos;
+    out = Internal::appendText(out, "solid ");
+    std::memcpy(out, m_solidName.constData(), m_solidName.size());
+    out += m_solidName.size();
+    *out++ = '\n';
+    m_bufferPos = static_cast<int>(out - m_buffer.data());
+}
+
+void StlWriter::endSolid()
+{
+    if (!m_isSolidOpen)
+        return;
+
+    m_isSolidOpen = false;
+    if (m_format != Format::Ascii)
+        return;
+
+    this->reserve(m_solidName.size() + 16);
+    char* out = m_buffer.data() + m_bufferPos;
+    out = Internal::appendText(out, "endsolid ");
+    std::memcpy(out, m_solidName.constData(), m_solidName.size());
+    out += m_solidName.size();
+    *out++ = '\n';
+    m_bufferPos = static_cast<int>(out - m_buffer.data());
+}
+
+void StlWriter::writeTriangulation(
+        const Handle_Poly_Triangulation& mesh, const TopLoc_Location& loc, bool reversed)
+{
+    if (mesh.IsNull())
+        return;
+
+    const bool hasTransformation = !loc.IsIdentity();
+    const gp_Trsf& trsf = loc.Transformation();
+    const TColgp_Array1OfPnt& vecNode = mesh->Nodes();
+    const Poly_Array1OfTriangle& vecTriangle = mesh->Triangles();
+    for (int i = vecTriangle.Lower(); i <= vecTriangle.Upper(); ++i) {
+        int nodes[3];
+        vecTriangle.Value(i).Get(nodes[0], nodes[1], nodes[2]);
+        if (reversed)
+            std::swap(nodes[1], nodes[2]);
+
+        float coords[9];
+        for (int j = 0; j < 3; ++j) {
+            gp_Pnt pnt = vecNode.Value(nodes[j]);
+            if (hasTransformation)
+                pnt.Transform(trsf);
+
+            coords[3 * j] = static_cast<float>(pnt.X());
+            coords[3 * j + 1] = static_cast<float>(pnt.Y());
+            coords[3 * j + 2] = static_cast<float>(pnt.Z());
+        }
+
+        this->writeFacet(coords);
+    }
+}
+
+void StlWriter::writeShape(const TopoDS_Shape& shape)
+{
+    for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(expl.Current());
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& mesh = BRep_Tool::Triangulation(face, loc);
+        this->writeTriangulation(mesh, loc, face.Orientation() == TopAbs_REVERSED);
+    }
+}
+
+char* StlWriter::formatFloat(char* buffer, float value)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    return std::to_chars(buffer, buffer + 32, value).ptr;
+#else
+    // Fallback not giving the shortest form, but still round-trip
+    const int len = std::snprintf(buffer, 32, "%.9g", value);
+    // snprintf() depends on LC_NUMERIC
+    std::replace(buffer, buffer + len, ',', '.');
+    return buffer + len;
+#endif
+}
+
+void StlWriter::writeFacet(const float* coords)
+{
+    float normal[3];
+    Internal::computeNormal(coords, normal);
+    if (m_format == Format::Ascii) {
+        this->reserve(Internal::asciiStlFacetMaxSize);
+        char* out = m_buffer.data() + m_bufferPos;
+        out = Internal::appendText(out, "  facet normal ");
+        out = Internal::appendFloats(out, normal);
+        out = Internal::appendText(out, "    outer loop\n");
+        for (int i = 0; i < 3; ++i) {
+            out = Internal::appendText(out, "      vertex ");
+            out = Internal::appendFloats(out, coords + 3 * i);
+        }
+
+        out = Internal::appendText(out, "    endloop\n  endfacet\n");
+        m_bufferPos = static_cast<int>(out - m_buffer.data());
+    }
+    else {
+        this->reserve(Internal::binaryStlFacetSize);
+        char* out = m_buffer.data() + m_bufferPos;
+        for (float value : normal)
+            out = Internal::appendFloatLE(out, value);
+
+        for (int i = 0; i < 9; ++i)
+            out = Internal::appendFloatLE(out, coords[i]);
+
+        *out++ = 0; // Attribute byte count
+        *out++ = 0;
+        m_bufferPos += Internal::binaryStlFacetSize;
+    }
+
+    ++m_triangleCount;
+}
+
+void StlWriter::reserve(int size)
+{
+    if (m_bufferPos + size > static_cast<int>(m_buffer.size()))
+        this->flush();
+}
+
+void StlWriter::flush()
+{
+    if (m_bufferPos > 0 && !m_hasError)
+        m_hasError = m_file.write(m_buffer.data(), m_bufferPos) != m_bufferPos;
+
+    m_bufferPos = 0;
+}
+
+} // namespace Mayo
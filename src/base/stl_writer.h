@@ -0,0 +1,74 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "result.h"
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QString>
+#include <Poly_Triangulation.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Shape.hxx>
+#include <vector>
+
+namespace Mayo {
+
+// Native streaming STL writer
+// Facets are formatted into a large memory block which is written to the
+// output file once full, so no merged mesh or compound has to be built.
+// In ASCII format each solid gives a separate "solid" block, binary format has
+// a single implicit solid
+class StlWriter {
+    Q_DECLARE_TR_FUNCTIONS(Mayo::StlWriter)
+public:
+    enum class Format {
+        Ascii,
+        Binary
+    };
+
+    using WriteResult = Result<void>;
+
+    StlWriter(Format format);
+    ~StlWriter();
+
+    WriteResult open(const QString& filepath);
+    WriteResult close();
+
+    void beginSolid(const QString& name);
+    void endSolid();
+
+    // Writes the triangles of 'mesh' transformed by 'loc', 'reversed' flips the
+    // orientation of triangles
+    void writeTriangulation(
+            const Handle_Poly_Triangulation& mesh,
+            const TopLoc_Location& loc = TopLoc_Location(),
+            bool reversed = false);
+    // Writes the triangulation of all faces in 'shape'
+    void writeShape(const TopoDS_Shape& shape);
+
+    qint64 triangleCount() const { return m_triangleCount; }
+
+    // Formats 'value' in the shortest text form that reads back to the same
+    // float, independently of the current locale. Returns the end of text
+    static char* formatFloat(char* buffer, float value);
+
+private:
+    void writeFacet(const float* coords);
+    void reserve(int size);
+    void flush();
+
+    Format m_format;
+    QFile m_file;
+    std::vector<char> m_buffer;
+    int m_bufferPos = 0;
+    qint64 m_triangleCount = 0;
+    QByteArray m_solidName;
+    bool m_isSolidOpen = false;
+    bool m_hasError = false;
+};
+
+} // namespace Mayo
@@ -0,0 +1,672 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "tessellation_cache.h"
+
+#include "caf_utils.h"
+#include "xde_document_item.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+
+#include <BinTools.hxx>
+#include <BRep_Builder.hxx>
+#include <Standard_Failure.hxx>
+#include <Standard_Version.hxx>
+#include <TDataStd_Name.hxx>
+#include <TNaming_Builder.hxx>
+#include <TopExp.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <streambuf>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+namespace Internal {
+
+// Values are stored in native byte order, cache files are not meant to be
+// shared between machines
+const char cacheFileSuffix[] = ".mayocache";
+const char cacheFileMagic[8] = { 'M', 'A', 'Y', 'O', 'T', 'E', 'S', 'S' };
+constexpr uint32_t cacheFileVersion = 2;
+
+const XCAFDoc_ColorType cachedColorTypes[] = {
+    XCAFDoc_ColorGen, XCAFDoc_ColorSurf, XCAFDoc_ColorCurv
+};
+
+class CacheWriter {
+public:
+    CacheWriter(QByteArray* bytes)
+        : m_bytes(bytes)
+    {}
+
+    bool isValid() const { return m_isValid; }
+
+    template<typename T> void write(T value) {
+        this->writeBytes(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeBytes(const char* data, qint64 size) {
+        // QByteArray can't hold more than INT_MAX bytes
+        m_isValid = m_isValid && size <= INT_MAX - m_bytes->size();
+        if (m_isValid)
+            m_bytes->append(data, static_cast<int>(size));
+    }
+
+    void writeString(const QString& str) {
+        const QByteArray utf8 = str.toUtf8();
+        this->write<int32_t>(utf8.size());
+        this->writeBytes(utf8.constData(), utf8.size());
+    }
+
+private:
+    QByteArray* m_bytes;
+    bool m_isValid = true;
+};
+
+// Reads values from memory, all reads fail once end of data is reached
+class CacheReader {
+public:
+    CacheReader(const uchar* begin, const uchar* end)
+        : m_pos(begin), m_end(end)
+    {}
+
+    bool isValid() const { return m_isValid; }
+
+    template<typename T> T read() {
+        T value = {};
+        const uchar* bytes = this->readBytes(sizeof(T));
+        if (bytes)
+            std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+
+    const uchar* readBytes(qint64 size) {
+        m_isValid = m_isValid && size >= 0 && size <= m_end - m_pos;
+        if (!m_isValid)
+            return nullptr;
+
+        const uchar* bytes = m_pos;
+        m_pos += size;
+        return bytes;
+    }
+
+    QString readString() {
+        const int32_t size = this->read<int32_t>();
+        const uchar* utf8 = this->readBytes(size);
+        return utf8 ? QString::fromUtf8(reinterpret_cast<const char*>(utf8), size) : QString();
+    }
+
+private:
+    const uchar* m_pos;
+    const uchar* m_end;
+    bool m_isValid = true;
+};
+
+// Read-only std::streambuf over a memory block, avoids copy of shape data
+// to be read by BinTools
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const char* begin, const char* end) {
+        char* ptrBegin = const_cast<char*>(begin);
+        this->setg(ptrBegin, ptrBegin, const_cast<char*>(end));
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        if (!(which & std::ios_base::in))
+            return pos_type(off_type(-1));
+
+        char* ptrBase = this->gptr();
+        if (dir == std::ios_base::beg)
+            ptrBase = this->eback();
+        else if (dir == std::ios_base::end)
+            ptrBase = this->egptr();
+
+        char* ptrNew = ptrBase + off;
+        if (ptrNew < this->eback() || ptrNew > this->egptr())
+            return pos_type(off_type(-1));
+
+        this->setg(this->eback(), ptrNew, this->egptr());
+        return pos_type(ptrNew - this->eback());
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return this->seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+struct LabelAttributes {
+    QString name;
+    std::array<bool, 3> hasColor = {};
+    std::array<Quantity_Color, 3> color;
+};
+
+static void writeLabelAttributes(
+        CacheWriter* writer, const Handle_XCAFDoc_ColorTool& colorTool, const TDF_Label& label)
+{
+    writer->writeString(CafUtils::labelAttrStdName(label));
+    for (XCAFDoc_ColorType colorType : cachedColorTypes) {
+        Quantity_Color color;
+        const bool hasColor = colorTool->GetColor(label, colorType, color);
+        writer->write<uint8_t>(hasColor ? 1 : 0);
+        if (hasColor) {
+            double r, g, b;
+            color.Values(r, g, b, Quantity_TOC_RGB);
+            writer->write<double>(r);
+            writer->write<double>(g);
+            writer->write<double>(b);
+        }
+    }
+}
+
+static LabelAttributes readLabelAttributes(CacheReader* reader)
+{
+    LabelAttributes attrs;
+    attrs.name = reader->readString();
+    for (size_t i = 0; i < attrs.color.size(); ++i) {
+        attrs.hasColor.at(i) = reader->read<uint8_t>() != 0;
+        if (attrs.hasColor.at(i)) {
+            const double r = reader->read<double>();
+            const double g = reader->read<double>();
+            const double b = reader->read<double>();
+            attrs.color.at(i) = Quantity_Color(r, g, b, Quantity_TOC_RGB);
+        }
+    }
+
+    return attrs;
+}
+
+static void applyLabelAttributes(
+        const LabelAttributes& attrs, const Handle_XCAFDoc_ColorTool& colorTool, const TDF_Label& label)
+{
+    // XCAFDoc_ShapeTool may have automatically named the label
+    if (!attrs.name.isEmpty())
+        XdeDocumentItem::setLabelName(label, attrs.name);
+    else
+        label.ForgetAttribute(TDataStd_Name::GetID());
+
+    for (size_t i = 0; i < attrs.color.size(); ++i) {
+        if (attrs.hasColor.at(i))
+            colorTool->SetColor(label, attrs.color.at(i), cachedColorTypes[i]);
+    }
+}
+
+static void writeTrsf(CacheWriter* writer, const gp_Trsf& trsf)
+{
+    for (int row = 1; row <= 3; ++row) {
+        for (int col = 1; col <= 4; ++col)
+            writer->write<double>(trsf.Value(row, col));
+    }
+}
+
+static TopLoc_Location readLocation(CacheReader* reader)
+{
+    double v[12];
+    for (double& coeff : v)
+        coeff = reader->read<double>();
+
+    const double identity[12] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0 };
+    if (std::equal(std::begin(v), std::end(v), std::begin(identity)))
+        return TopLoc_Location();
+
+    gp_Trsf trsf;
+    trsf.SetValues(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10], v[11]);
+    return TopLoc_Location(trsf);
+}
+
+// Layout of a cache file:
+//     header: magic, version, volume, area
+//     shape data: compound of all top-level simple shapes along with the
+//                 triangulations of their faces, written by BinTools
+//     top-level labels: assemblies (with components) and simple shapes (with sub-shapes)
+static bool serializeEntry(const TessellationCache::Entry& entry, QByteArray* bytes)
+{
+    CacheWriter writer(bytes);
+    writer.writeBytes(cacheFileMagic, sizeof(cacheFileMagic));
+    writer.write<uint32_t>(cacheFileVersion);
+    writer.write<double>(entry.volume);
+    writer.write<double>(entry.area);
+
+    Handle_XCAFDoc_ShapeTool shapeTool = XCAFDoc_DocumentTool::ShapeTool(entry.cafDoc->Main());
+    Handle_XCAFDoc_ColorTool colorTool = XCAFDoc_DocumentTool::ColorTool(entry.cafDoc->Main());
+    std::vector<TDF_Label> vecTopLabel;
+    CafUtils::LabelHashMap<int> mapTopLabelIndex;
+    BRep_Builder builder;
+    TopoDS_Compound compound;
+    builder.MakeCompound(compound);
+    for (TDF_ChildIterator it(shapeTool->Label()); it.More(); it.Next()) {
+        const TDF_Label label = it.Value();
+        if (!XdeDocumentItem::isShape(label))
+            continue;
+
+        mapTopLabelIndex.emplace(label, static_cast<int>(vecTopLabel.size()));
+        vecTopLabel.push_back(label);
+        if (!XdeDocumentItem::isShapeAssembly(label)) {
+            const TopoDS_Shape shape = XdeDocumentItem::shape(label);
+            if (shape.IsNull())
+                return false;
+
+            builder.Add(compound, shape);
+        }
+    }
+
+    // Shape data
+    {
+        std::ostringstream stream(std::ios::out | std::ios::binary);
+        BinTools::Write(compound, stream);
+        const std::string shapeData = stream.str();
+        writer.write<int64_t>(shapeData.size());
+        writer.writeBytes(shapeData.data(), shapeData.size());
+    }
+
+    // Labels
+    writer.write<int32_t>(static_cast<int32_t>(vecTopLabel.size()));
+    int shapeIndex = 0;
+    for (const TDF_Label& label : vecTopLabel) {
+        const bool isAssembly = XdeDocumentItem::isShapeAssembly(label);
+        writer.write<uint8_t>(isAssembly ? 1 : 0);
+        Internal::writeLabelAttributes(&writer, colorTool, label);
+        if (isAssembly) {
+            const TDF_LabelSequence seqComponent = XdeDocumentItem::shapeComponents(label);
+            writer.write<int32_t>(seqComponent.Size());
+            for (const TDF_Label& component : seqComponent) {
+                auto itReferred = mapTopLabelIndex.find(XdeDocumentItem::shapeReferred(component));
+                writer.write<int32_t>(itReferred != mapTopLabelIndex.cend() ? itReferred->second : -1);
+                Internal::writeTrsf(
+                            &writer,
+                            XdeDocumentItem::shapeReferenceLocation(component).Transformation());
+                Internal::writeLabelAttributes(&writer, colorTool, component);
+            }
+        }
+        else {
+            const TopoDS_Shape shape = XdeDocumentItem::shape(label);
+            writer.write<int32_t>(shapeIndex++);
+            const TDF_LabelSequence seqSub = XdeDocumentItem::shapeSubs(label);
+            writer.write<int32_t>(seqSub.Size());
+            std::array<TopTools_IndexedMapOfShape, TopAbs_SHAPE> arrayMapSub;
+            for (const TDF_Label& sub : seqSub) {
+                const TopoDS_Shape subShape = XdeDocumentItem::shape(sub);
+                int subIndex = 0;
+                if (!subShape.IsNull()) {
+                    TopTools_IndexedMapOfShape& mapSub = arrayMapSub.at(subShape.ShapeType());
+                    if (mapSub.IsEmpty())
+                        TopExp::MapShapes(shape, subShape.ShapeType(), mapSub);
+
+                    subIndex = mapSub.FindIndex(subShape);
+                }
+
+                writer.write<uint8_t>(subIndex > 0 ? subShape.ShapeType() : TopAbs_SHAPE);
+                writer.write<int32_t>(subIndex);
+                writer.write<uint8_t>(subIndex > 0 ? subShape.Orientation() : TopAbs_FORWARD);
+                Internal::writeLabelAttributes(&writer, colorTool, sub);
+            }
+        }
+    }
+
+    return writer.isValid();
+}
+
+static bool deserializeEntry(const uchar* data, qint64 size, TessellationCache::Entry* entry)
+{
+    CacheReader reader(data, data + size);
+    const uchar* magic = reader.readBytes(sizeof(cacheFileMagic));
+    if (!magic || std::memcmp(magic, cacheFileMagic, sizeof(cacheFileMagic)) != 0)
+        return false;
+
+    if (reader.read<uint32_t>() != cacheFileVersion)
+        return false;
+
+    const double volume = reader.read<double>();
+    const double area = reader.read<double>();
+
+    // Shape data
+    TopoDS_Shape compound;
+    const int64_t shapeDataSize = reader.read<int64_t>();
+    const uchar* shapeData = reader.readBytes(shapeDataSize);
+    if (!shapeData)
+        return false;
+
+    {
+        const char* shapeDataBegin = reinterpret_cast<const char*>(shapeData);
+        MemoryStreamBuf streamBuf(shapeDataBegin, shapeDataBegin + shapeDataSize);
+        std::istream stream(&streamBuf);
+        BinTools::Read(compound, stream);
+    }
+
+    if (compound.IsNull())
+        return false;
+
+    std::vector<TopoDS_Shape> vecShape;
+    for (TopoDS_Iterator it(compound); it.More(); it.Next())
+        vecShape.push_back(it.Value());
+
+    // Labels
+    Handle_TDocStd_Document cafDoc = CafUtils::createXdeDocument();
+    Handle_XCAFDoc_ShapeTool shapeTool = XCAFDoc_DocumentTool::ShapeTool(cafDoc->Main());
+    Handle_XCAFDoc_ColorTool colorTool = XCAFDoc_DocumentTool::ColorTool(cafDoc->Main());
+    struct Component {
+        int referredIndex;
+        TopLoc_Location location;
+        LabelAttributes attrs;
+    };
+    struct TopLabel {
+        TDF_Label label;
+        bool isAssembly;
+        bool isAssemblyBuilt;
+        std::vector<Component> vecComponent;
+    };
+    const int32_t topLabelCount = reader.read<int32_t>();
+    if (topLabelCount < 0)
+        return false;
+
+    std::vector<TopLabel> vecTopLabel;
+    for (int32_t i = 0; i < topLabelCount && reader.isValid(); ++i) {
+        TopLabel topLabel = {};
+        topLabel.isAssembly = reader.read<uint8_t>() != 0;
+        const LabelAttributes attrs = Internal::readLabelAttributes(&reader);
+        if (topLabel.isAssembly) {
+            topLabel.label = shapeTool->NewShape();
+            const int32_t componentCount = reader.read<int32_t>();
+            for (int32_t j = 0; j < componentCount && reader.isValid(); ++j) {
+                Component component;
+                component.referredIndex = reader.read<int32_t>();
+                component.location = Internal::readLocation(&reader);
+                component.attrs = Internal::readLabelAttributes(&reader);
+                topLabel.vecComponent.push_back(std::move(component));
+            }
+        }
+        else {
+            const int32_t shapeIndex = reader.read<int32_t>();
+            if (shapeIndex < 0 || shapeIndex >= static_cast<int32_t>(vecShape.size()))
+                return false;
+
+            const TopoDS_Shape& shape = vecShape.at(shapeIndex);
+            topLabel.label = shapeTool->AddShape(shape, false, false);
+            const int32_t subCount = reader.read<int32_t>();
+            std::array<TopTools_IndexedMapOfShape, TopAbs_SHAPE> arrayMapSub;
+            for (int32_t j = 0; j < subCount && reader.isValid(); ++j) {
+                const auto subType = static_cast<TopAbs_ShapeEnum>(reader.read<uint8_t>());
+                const int32_t subIndex = reader.read<int32_t>();
+                const auto subOrientation = static_cast<TopAbs_Orientation>(reader.read<uint8_t>());
+                const LabelAttributes subAttrs = Internal::readLabelAttributes(&reader);
+                if (subIndex <= 0 || subType >= TopAbs_SHAPE)
+                    continue;
+
+                TopTools_IndexedMapOfShape& mapSub = arrayMapSub.at(subType);
+                if (mapSub.IsEmpty())
+                    TopExp::MapShapes(shape, subType, mapSub);
+
+                if (subIndex > mapSub.Extent())
+                    return false;
+
+                const TopoDS_Shape subShape = mapSub.FindKey(subIndex).Oriented(subOrientation);
+                const TDF_Label subLabel = shapeTool->AddSubShape(topLabel.label, subShape);
+                if (!subLabel.IsNull())
+                    Internal::applyLabelAttributes(subAttrs, colorTool, subLabel);
+            }
+        }
+
+        Internal::applyLabelAttributes(attrs, colorTool, topLabel.label);
+        vecTopLabel.push_back(std::move(topLabel));
+    }
+
+    if (!reader.isValid())
+        return false;
+
+    // Referred assemblies have to be built before the assemblies using them, so
+    // the located shape of components is complete
+    BRep_Builder builder;
+    std::function<void(TopLabel&)> fnBuildAssembly = [&](TopLabel& asmLabel) {
+        if (asmLabel.isAssemblyBuilt)
+            return;
+
+        asmLabel.isAssemblyBuilt = true;
+        TopoDS_Compound asmShape;
+        builder.MakeCompound(asmShape);
+        for (const Component& component : asmLabel.vecComponent) {
+            if (component.referredIndex < 0 || component.referredIndex >= topLabelCount)
+                continue;
+
+            TopLabel& referred = vecTopLabel.at(component.referredIndex);
+            if (referred.isAssembly)
+                fnBuildAssembly(referred);
+
+            const TDF_Label componentLabel =
+                    shapeTool->AddComponent(asmLabel.label, referred.label, component.location);
+            if (!componentLabel.IsNull()) {
+                Internal::applyLabelAttributes(component.attrs, colorTool, componentLabel);
+                builder.Add(asmShape, XdeDocumentItem::shape(componentLabel));
+            }
+        }
+
+        TNaming_Builder(asmLabel.label).Generated(asmShape);
+    };
+    for (TopLabel& topLabel : vecTopLabel) {
+        if (topLabel.isAssembly)
+            fnBuildAssembly(topLabel);
+    }
+
+    entry->cafDoc = cafDoc;
+    entry->volume = volume;
+    entry->area = area;
+    return true;
+}
+
+// Modification time gives the order of usage for evictEntries()
+// The entry file is opened without creating it, in case it was evicted meanwhile
+static void touchEntryFile(const QString& filePath)
+{
+    QFile file(filePath);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    const QIODevice::OpenMode mode = QIODevice::ReadWrite | QIODevice::ExistingOnly;
+#else
+    const QIODevice::OpenMode mode = QIODevice::ReadOnly; // Enough on POSIX systems
+#endif
+    if (file.open(mode))
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+}
+
+} // namespace Internal
+
+bool TessellationCache::isEnabled() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_isEnabled && !m_dirPath.isEmpty();
+}
+
+void TessellationCache::setEnabled(bool on)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isEnabled = on;
+}
+
+QString TessellationCache::directory() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dirPath;
+}
+
+void TessellationCache::setDirectory(const QString& dirPath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dirPath = dirPath;
+}
+
+qint64 TessellationCache::maxSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxSize;
+}
+
+void TessellationCache::setMaxSize(qint64 size)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxSize = size;
+    }
+
+    this->evictEntries();
+}
+
+QByteArray TessellationCache::computeKey(const QString& filepath, const QByteArray& extraData)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    // Not used for security purpose, MD5 is chosen for speed
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    const qint64 fileSize = file.size();
+    hash.addData(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+    uchar* fileData = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    if (fileData) {
+        constexpr qint64 blockSize = 64 * 1024 * 1024;
+        for (qint64 pos = 0; pos < fileSize; pos += blockSize) {
+            const qint64 len = std::min(blockSize, fileSize - pos);
+            hash.addData(reinterpret_cast<const char*>(fileData + pos), static_cast<int>(len));
+        }
+
+        file.unmap(fileData);
+    }
+    else {
+        hash.addData(&file);
+    }
+
+    hash.addData(extraData);
+    hash.addData(QByteArray::number(Internal::cacheFileVersion));
+    hash.addData(OCC_VERSION_COMPLETE);
+    return hash.result().toHex();
+}
+
+bool TessellationCache::load(const QByteArray& key, Entry* entry)
+{
+    if (key.isEmpty() || !this->isEnabled())
+        return false;
+
+    // Check existence first, opening a missing entry must not create an empty file
+    bool ok = false;
+    const QString filePath = this->entryFilePath(key);
+    QFile file(filePath);
+    if (QFileInfo::exists(filePath) && file.open(QIODevice::ReadOnly)) {
+        uchar* fileData = file.map(0, file.size());
+        if (fileData) {
+            try {
+                ok = Internal::deserializeEntry(fileData, file.size(), entry);
+            } catch (const Standard_Failure&) {
+                ok = false;
+            }
+
+            file.unmap(fileData);
+        }
+
+        file.close();
+        if (ok)
+            Internal::touchEntryFile(filePath);
+        else
+            file.remove(); // Corrupted or obsolete entry
+    }
+
+    if (ok)
+        ++m_hitCount;
+    else
+        ++m_missCount;
+
+    return ok;
+}
+
+bool TessellationCache::store(const QByteArray& key, const Entry& entry)
+{
+    if (key.isEmpty() || entry.cafDoc.IsNull() || !this->isEnabled())
+        return false;
+
+    QByteArray bytes;
+    try {
+        if (!Internal::serializeEntry(entry, &bytes))
+            return false;
+    } catch (const Standard_Failure&) {
+        return false;
+    }
+
+    if (!QDir().mkpath(this->directory()))
+        return false;
+
+    QSaveFile file(this->entryFilePath(key));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    if (file.write(bytes) != bytes.size() || !file.commit())
+        return false;
+
+    this->evictEntries();
+    return true;
+}
+
+void TessellationCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const QDir dir(m_dirPath);
+    const QStringList nameFilters = { QString("*") + Internal::cacheFileSuffix };
+    for (const QFileInfo& fileInfo : dir.entryInfoList(nameFilters, QDir::Files))
+        QFile::remove(fileInfo.absoluteFilePath());
+}
+
+TessellationCache::Statistics TessellationCache::statistics() const
+{
+    Statistics stats;
+    stats.hitCount = m_hitCount;
+    stats.missCount = m_missCount;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const QDir dir(m_dirPath);
+    const QStringList nameFilters = { QString("*") + Internal::cacheFileSuffix };
+    for (const QFileInfo& fileInfo : dir.entryInfoList(nameFilters, QDir::Files)) {
+        ++stats.entryCount;
+        stats.totalSize += fileInfo.size();
+    }
+
+    return stats;
+}
+
+QString TessellationCache::entryFilePath(const QByteArray& key) const
+{
+    return QDir(this->directory()).filePath(QString::fromLatin1(key) + Internal::cacheFileSuffix);
+}
+
+void TessellationCache::evictEntries()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_dirPath.isEmpty())
+        return;
+
+    // Most recently used entries come first
+    const QDir dir(m_dirPath);
+    const QStringList nameFilters = { QString("*") + Internal::cacheFileSuffix };
+    qint64 totalSize = 0;
+    for (const QFileInfo& fileInfo : dir.entryInfoList(nameFilters, QDir::Files, QDir::Time)) {
+        totalSize += fileInfo.size();
+        if (totalSize > m_maxSize)
+            QFile::remove(fileInfo.absoluteFilePath());
+    }
+}
+
+} // namespace Mayo
@@ -0,0 +1,71 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QString>
+#include <TDocStd_Document.hxx>
+#include <atomic>
+#include <mutex>
+
+namespace Mayo {
+
+// Persistent cache of imported XDE documents, along with the triangulation of
+// their faces
+// Entries are keyed by a hash of the source file contents and of any data
+// impacting the import (eg meshing parameters). They are stored as binary files
+// in directory(), which are memory-mapped when loaded. The least recently used
+// entries are evicted when total size exceeds maxSize()
+// Cached XDE data: assembly structure, names and colors (layers, materials and
+// validation properties are not restored)
+class TessellationCache {
+    Q_DECLARE_TR_FUNCTIONS(Mayo::TessellationCache)
+public:
+    struct Entry {
+        Handle_TDocStd_Document cafDoc;
+        double volume = 0.;
+        double area = 0.;
+    };
+
+    struct Statistics {
+        int hitCount = 0;
+        int missCount = 0;
+        int entryCount = 0;
+        qint64 totalSize = 0; // Bytes
+    };
+
+    bool isEnabled() const;
+    void setEnabled(bool on);
+
+    QString directory() const;
+    void setDirectory(const QString& dirPath);
+
+    qint64 maxSize() const; // Bytes
+    void setMaxSize(qint64 size);
+
+    static QByteArray computeKey(const QString& filepath, const QByteArray& extraData);
+
+    bool load(const QByteArray& key, Entry* entry);
+    bool store(const QByteArray& key, const Entry& entry);
+    void clear();
+
+    Statistics statistics() const;
+
+private:
+    QString entryFilePath(const QByteArray& key) const;
+    void evictEntries();
+
+    mutable std::mutex m_mutex;
+    bool m_isEnabled = false;
+    QString m_dirPath;
+    qint64 m_maxSize = 1024 * 1024 * 1024;
+    std::atomic<int> m_hitCount = {};
+    std::atomic<int> m_missCount = {};
+};
+
+} // namespace Mayo
@@ -12,13 +12,43 @@
 #include <Standard_GUID.hxx>
 #include <TDataStd_Name.hxx>
 #include <TDF_AttributeIterator.hxx>
+#include <TNaming_Builder.hxx>
 #include <XCAFDoc_Area.hxx>
 #include <XCAFDoc_Centroid.hxx>
 #include <XCAFDoc_DocumentTool.hxx>
+#include <XCAFDoc_Location.hxx>
 #include <XCAFDoc_Volume.hxx>
 
 namespace Mayo {
 
+namespace Internal {
+
+static void addShapeInstances(
+        const TDF_Label& label,
+        const TopLoc_Location& loc,
+        std::vector<XdeDocumentItem::ShapePrototype>* ptrVecPrototype,
+        CafUtils::LabelHashMap<size_t>* ptrMapPrototypeIndex)
+{
+    if (XdeDocumentItem::isShapeAssembly(label)) {
+        for (const TDF_Label& component : XdeDocumentItem::shapeComponents(label)) {
+            addShapeInstances(
+                        XdeDocumentItem::shapeReferred(component),
+                        loc * XdeDocumentItem::shapeReferenceLocation(component),
+                        ptrVecPrototype,
+                        ptrMapPrototypeIndex);
+        }
+    }
+    else {
+        auto itInsert = ptrMapPrototypeIndex->emplace(label, ptrVecPrototype->size());
+        if (itInsert.second)
+            ptrVecPrototype->push_back({ label, {} });
+
+        ptrVecPrototype->at(itInsert.first->second).vecInstanceLocation.push_back(loc);
+    }
+}
+
+} // namespace Internal
+
 XdeDocumentItem::XdeDocumentItem(const Handle_TDocStd_Document &doc)
     : m_cafDoc(doc),
       m_shapeTool(XCAFDoc_DocumentTool::ShapeTool(doc->Main())),
@@ -45,8 +75,11 @@ const Handle_XCAFDoc_ColorTool& XdeDocumentItem::colorTool() const
 void XdeDocumentItem::rebuildAssemblyTree()
 {
     m_asmTree.clear();
+    m_vecAsmNodeFetched.clear();
+    m_vecAsmNodeAbsoluteLoc.clear();
+    m_mapLabelAsmNodes.clear();
     for (const TDF_Label& rootLabel : this->topLevelFreeShapes())
-        this->deepBuildAssemblyTree(0, rootLabel);
+        this->appendAssemblyNode(0, rootLabel);
 }
 
 const Tree<TDF_Label>& XdeDocumentItem::assemblyTree() const
@@ -54,6 +87,56 @@ const Tree<TDF_Label>& XdeDocumentItem::assemblyTree() const
     return m_asmTree;
 }
 
+bool XdeDocumentItem::canFetchAssemblyNodeChildren(TreeNodeId nodeId) const
+{
+    // Label can have child labels being neither components nor sub-shapes,
+    // so TDF_Label::HasChild() can't be trusted
+    return this->assemblyNodeFetchCount(nodeId) > 0;
+}
+
+int XdeDocumentItem::assemblyNodeFetchCount(TreeNodeId nodeId) const
+{
+    if (nodeId == 0 || nodeId > m_vecAsmNodeFetched.size() || m_vecAsmNodeFetched.at(nodeId - 1))
+        return 0;
+
+    const TDF_Label& label = m_asmTree.nodeData(nodeId);
+    if (XdeDocumentItem::isShapeAssembly(label))
+        return XdeDocumentItem::shapeComponents(label).Size();
+    else if (XdeDocumentItem::isShapeSimple(label))
+        return XdeDocumentItem::shapeSubs(label).Size();
+    else if (XdeDocumentItem::isShapeReference(label))
+        return 1;
+
+    return 0;
+}
+
+void XdeDocumentItem::fetchAssemblyNodeChildren(TreeNodeId nodeId)
+{
+    if (nodeId == 0 || nodeId > m_vecAsmNodeFetched.size() || m_vecAsmNodeFetched.at(nodeId - 1))
+        return;
+
+    m_vecAsmNodeFetched.at(nodeId - 1) = true;
+    const TDF_Label label = m_asmTree.nodeData(nodeId);
+    if (XdeDocumentItem::isShapeAssembly(label)) {
+        for (const TDF_Label& child : XdeDocumentItem::shapeComponents(label))
+            this->appendAssemblyNode(nodeId, child);
+    }
+    else if (XdeDocumentItem::isShapeSimple(label)) {
+        for (const TDF_Label& child : XdeDocumentItem::shapeSubs(label))
+            this->appendAssemblyNode(nodeId, child);
+    }
+    else if (XdeDocumentItem::isShapeReference(label)) {
+        const TDF_Label referred = XdeDocumentItem::shapeReferred(label);
+        this->appendAssemblyNode(nodeId, referred);
+    }
+}
+
+void XdeDocumentItem::fetchAssemblyTree()
+{
+    for (TreeNodeId rootId : m_asmTree.roots())
+        this->deepFetchAssemblyNode(rootId);
+}
+
 TDF_LabelSequence XdeDocumentItem::topLevelFreeShapes() const
 {
     TDF_LabelSequence seq;
@@ -196,18 +279,51 @@ TDF_Label XdeDocumentItem::shapeReferred(const TDF_Label &lbl)
     return referred;
 }
 
+std::vector<XdeDocumentItem::ShapePrototype> XdeDocumentItem::shapePrototypes() const
+{
+    std::vector<ShapePrototype> vecPrototype;
+    CafUtils::LabelHashMap<size_t> mapPrototypeIndex;
+    for (const TDF_Label& label : this->topLevelFreeShapes())
+        Internal::addShapeInstances(label, TopLoc_Location(), &vecPrototype, &mapPrototypeIndex);
+
+    return vecPrototype;
+}
+
 TopLoc_Location XdeDocumentItem::shapeAbsoluteLocation(TreeNodeId nodeId) const
 {
-    TopLoc_Location absoluteLoc;
-    TreeNodeId it = nodeId;
-    while (it != 0) {
-        const TDF_Label& nodeLabel = m_asmTree.nodeData(it);
-        const TopLoc_Location nodeLoc = XdeDocumentItem::shapeReferenceLocation(nodeLabel);
-        absoluteLoc = nodeLoc * absoluteLoc;
-        it = m_asmTree.nodeParent(it);
-    }
+    if (nodeId == 0 || nodeId > m_vecAsmNodeAbsoluteLoc.size())
+        return TopLoc_Location();
+
+    return m_vecAsmNodeAbsoluteLoc.at(nodeId - 1);
+}
+
+std::vector<TopLoc_Location> XdeDocumentItem::shapeAbsoluteLocations(
+        Span<const TreeNodeId> spanNodeId) const
+{
+    std::vector<TopLoc_Location> vecLoc;
+    vecLoc.reserve(spanNodeId.size());
+    for (TreeNodeId nodeId : spanNodeId)
+        vecLoc.push_back(this->shapeAbsoluteLocation(nodeId));
+
+    return vecLoc;
+}
+
+void XdeDocumentItem::setShapeReferenceLocation(TreeNodeId nodeId, const TopLoc_Location& loc)
+{
+    const TDF_Label label = m_asmTree.nodeData(nodeId);
+    if (!XdeDocumentItem::isShapeReference(label))
+        return;
 
-    return absoluteLoc;
+    XCAFDoc_Location::Set(label, loc);
+    TNaming_Builder builder(label);
+    builder.Generated(XdeDocumentItem::shape(XdeDocumentItem::shapeReferred(label)).Located(loc));
+    // Compounds of the parent assemblies still hold the previous location
+    m_shapeTool->UpdateAssemblies();
+    auto itNodes = m_mapLabelAsmNodes.find(label);
+    if (itNodes != m_mapLabelAsmNodes.end()) {
+        for (TreeNodeId labelNodeId : itNodes->second)
+            this->updateShapeAbsoluteLocation(labelNodeId);
+    }
 }
 
 XdeDocumentItem::ValidationProperties XdeDocumentItem::validationProperties(
@@ -263,22 +379,40 @@ TDF_Label XdeDocumentItem::label(TreeNodeId nodeId) const
     return this->assemblyTree().nodeData(nodeId);
 }
 
-void XdeDocumentItem::deepBuildAssemblyTree(
-        TreeNodeId parentNode, const TDF_Label &label)
+TreeNodeId XdeDocumentItem::appendAssemblyNode(
+        TreeNodeId parentNode, const TDF_Label& label)
 {
     const TreeNodeId node = m_asmTree.appendChild(parentNode, label);
-    if (XdeDocumentItem::isShapeAssembly(label)) {
-        for (const TDF_Label& child : XdeDocumentItem::shapeComponents(label))
-            this->deepBuildAssemblyTree(node, child);
-    }
-    else if (XdeDocumentItem::isShapeSimple(label)) {
-        for (const TDF_Label& child : XdeDocumentItem::shapeSubs(label))
-            this->deepBuildAssemblyTree(node, child);
-    }
-    else if (XdeDocumentItem::isShapeReference(label)) {
-        const TDF_Label referred = XdeDocumentItem::shapeReferred(label);
-        this->deepBuildAssemblyTree(node, referred);
-    }
+    m_vecAsmNodeFetched.push_back(false);
+    // Parent node always exists before its children, so absolute locations
+    // are computed top-down
+    m_vecAsmNodeAbsoluteLoc.push_back(
+                this->shapeAbsoluteLocation(parentNode)
+                * XdeDocumentItem::shapeReferenceLocation(label));
+    m_mapLabelAsmNodes[label].push_back(node);
+    return node;
+}
+
+void XdeDocumentItem::deepFetchAssemblyNode(TreeNodeId nodeId)
+{
+    this->fetchAssemblyNodeChildren(nodeId);
+    for (auto it = m_asmTree.nodeChildFirst(nodeId); it != 0; it = m_asmTree.nodeSiblingNext(it))
+        this->deepFetchAssemblyNode(it);
+}
+
+void XdeDocumentItem::updateShapeAbsoluteLocation(TreeNodeId nodeId)
+{
+    if (nodeId == 0 || nodeId > m_vecAsmNodeAbsoluteLoc.size())
+        return;
+
+    // Only the subtree of the node is affected
+    const TreeNodeId parentId = m_asmTree.nodeParent(nodeId);
+    const TDF_Label& label = m_asmTree.nodeData(nodeId);
+    m_vecAsmNodeAbsoluteLoc.at(nodeId - 1) =
+            this->shapeAbsoluteLocation(parentId)
+            * XdeDocumentItem::shapeReferenceLocation(label);
+    for (auto it = m_asmTree.nodeChildFirst(nodeId); it != 0; it = m_asmTree.nodeSiblingNext(it))
+        this->updateShapeAbsoluteLocation(it);
 }
 
 std::unique_ptr<XdeShapePropertyOwner> XdeDocumentItem::shapeProperties(const TDF_Label& label) const
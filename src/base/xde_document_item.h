@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "caf_utils.h"
 #include "document_item.h"
 #include "libtree.h"
 #include "quantity.h"
@@ -40,8 +41,16 @@ public:
     const Handle_XCAFDoc_ShapeTool& shapeTool() const;
     const Handle_XCAFDoc_ColorTool& colorTool() const;
 
+    // Assembly tree is built lazily : only nodes of top-level free shapes are
+    // created, children of a node are created on first call to fetchAssemblyNodeChildren()
     void rebuildAssemblyTree();
     const Tree<TDF_Label>& assemblyTree() const;
+    bool canFetchAssemblyNodeChildren(TreeNodeId nodeId) const;
+    // Count of the children fetchAssemblyNodeChildren() would create, 0 if already fetched
+    int assemblyNodeFetchCount(TreeNodeId nodeId) const;
+    void fetchAssemblyNodeChildren(TreeNodeId nodeId);
+    // Fetches children of all nodes, recursively
+    void fetchAssemblyTree();
 
     TDF_LabelSequence topLevelFreeShapes() const;
     static TDF_LabelSequence shapeComponents(const TDF_Label& lbl);
@@ -65,10 +74,25 @@ public:
     bool hasShapeColor(const TDF_Label& lbl) const;
     Quantity_Color shapeColor(const TDF_Label& lbl) const;
 
+    // Absolute locations are cached per node, computed when nodes are created
     TopLoc_Location shapeAbsoluteLocation(TreeNodeId nodeId) const;
+    std::vector<TopLoc_Location> shapeAbsoluteLocations(Span<const TreeNodeId> spanNodeId) const;
     static TopLoc_Location shapeReferenceLocation(const TDF_Label& lbl);
+    // Changes location of the reference at 'nodeId' and updates absolute
+    // locations of the subtrees of all the nodes referring to the same label
+    // (a component of an assembly instanced many times has many nodes)
+    void setShapeReferenceLocation(TreeNodeId nodeId, const TopLoc_Location& loc);
     static TDF_Label shapeReferred(const TDF_Label& lbl);
 
+    // Simple shape referred one or many times in the assemblies, along with the
+    // absolute location of each of its instances
+    struct ShapePrototype {
+        TDF_Label label;
+        std::vector<TopLoc_Location> vecInstanceLocation;
+    };
+    // Prototypes of the top-level free shapes, assemblies are flattened
+    std::vector<ShapePrototype> shapePrototypes() const;
+
     static ValidationProperties validationProperties(const TDF_Label& lbl);
 
     std::unique_ptr<XdeShapePropertyOwner> shapeProperties(const TDF_Label& label) const;
@@ -81,12 +105,17 @@ public:
     TDF_Label label(TreeNodeId nodeId) const;
 
 private:
-    void deepBuildAssemblyTree(TreeNodeId parentNode, const TDF_Label& label);
+    TreeNodeId appendAssemblyNode(TreeNodeId parentNode, const TDF_Label& label);
+    void deepFetchAssemblyNode(TreeNodeId nodeId);
+    void updateShapeAbsoluteLocation(TreeNodeId nodeId);
 
     Handle_TDocStd_Document m_cafDoc;
     Handle_XCAFDoc_ShapeTool m_shapeTool;
     Handle_XCAFDoc_ColorTool m_colorTool;
     Tree<TDF_Label> m_asmTree;
+    std::vector<bool> m_vecAsmNodeFetched;
+    std::vector<TopLoc_Location> m_vecAsmNodeAbsoluteLoc;
+    CafUtils::LabelHashMap<std::vector<TreeNodeId>> m_mapLabelAsmNodes;
 };
 
 } // namespace Mayo
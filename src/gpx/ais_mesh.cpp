@@ -0,0 +1,234 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "ais_mesh.h"
+#include "../base/mesh_utils.h"
+
+#include <Graphic3d_ArrayOfPoints.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Prs3d_Drawer.hxx>
+#include <Prs3d_ShadingAspect.hxx>
+#include <Select3D_SensitiveTriangulation.hxx>
+#include <SelectMgr_EntityOwner.hxx>
+#include <Standard_Version.hxx>
+#include <vector>
+
+namespace Mayo {
+
+namespace Internal {
+
+// Buffer holds per vertex {x, y, z, nx, ny, nz} as floats, without padding
+static bool isPositionNormalLayout(const Handle_Graphic3d_Buffer& buffer)
+{
+    return buffer->NbAttributes == 2
+            && buffer->Attribute(0).Id == Graphic3d_TOA_POS
+            && buffer->Attribute(0).DataType == Graphic3d_TOD_VEC3
+            && buffer->Attribute(1).Id == Graphic3d_TOA_NORM
+            && buffer->Attribute(1).DataType == Graphic3d_TOD_VEC3
+            && buffer->Stride == static_cast<int>(6 * sizeof(float));
+}
+
+} // namespace Internal
+
+AIS_Mesh::AIS_Mesh(const Handle_Poly_Triangulation& mesh)
+    : m_mesh(mesh),
+      m_aspectWireframe(new Graphic3d_AspectFillArea3d),
+      m_aspectNodes(new Graphic3d_AspectMarker3d(Aspect_TOM_POINT, Quantity_NOC_YELLOW, 1.))
+{
+    myDrawer->SetShadingAspect(new Prs3d_ShadingAspect);
+    m_aspectShaded = myDrawer->ShadingAspect()->Aspect();
+    m_aspectShaded->SetInteriorStyle(Aspect_IS_SOLID);
+    m_aspectShaded->SetEdgeOff();
+    m_aspectWireframe->SetInteriorStyle(Aspect_IS_EMPTY);
+    m_aspectWireframe->SetEdgeOn();
+    this->SetDisplayMode(DisplayMode_Shaded);
+    this->SetHilightMode(DisplayMode_Wireframe);
+    this->updateAspects();
+}
+
+void AIS_Mesh::SetColor(const Quantity_Color& color)
+{
+    hasOwnColor = true;
+    myDrawer->SetColor(color);
+    this->updateAspects();
+}
+
+void AIS_Mesh::SetMaterial(const Graphic3d_MaterialAspect& material)
+{
+    hasOwnMaterial = true;
+    myDrawer->ShadingAspect()->SetMaterial(material);
+    this->updateAspects();
+}
+
+void AIS_Mesh::setEdgesVisible(bool on)
+{
+    m_edgesVisible = on;
+    this->updateAspects();
+}
+
+void AIS_Mesh::setNodesVisible(bool on)
+{
+    if (m_nodesVisible != on) {
+        m_nodesVisible = on;
+        this->SetToUpdate();
+    }
+}
+
+bool AIS_Mesh::AcceptDisplayMode(const int mode) const
+{
+    return mode == DisplayMode_Wireframe
+            || mode == DisplayMode_Shaded
+            || mode == DisplayMode_Shrink;
+}
+
+void AIS_Mesh::ComputeSelection(
+        const opencascade::handle<SelectMgr_Selection>& sel, const int mode)
+{
+    if (mode != 0 || m_mesh.IsNull())
+        return;
+
+    Handle_SelectMgr_EntityOwner owner = new SelectMgr_EntityOwner(this);
+    sel->Add(new Select3D_SensitiveTriangulation(owner, m_mesh, TopLoc_Location(), true));
+}
+
+void AIS_Mesh::Compute(
+        const opencascade::handle<PrsMgr_PresentationManager3d>&,
+        const opencascade::handle<Prs3d_Presentation>& pres,
+        const int mode)
+{
+    if (m_mesh.IsNull() || m_mesh->NbTriangles() <= 0)
+        return;
+
+    Handle_Graphic3d_Group group = pres->NewGroup();
+    if (mode == DisplayMode_Wireframe) {
+        group->SetGroupPrimitivesAspect(m_aspectWireframe);
+        group->AddPrimitiveArray(this->trianglesArray());
+    }
+    else if (mode == DisplayMode_Shaded) {
+        group->SetGroupPrimitivesAspect(m_aspectShaded);
+        group->AddPrimitiveArray(this->trianglesArray());
+    }
+    else if (mode == DisplayMode_Shrink) {
+        group->SetGroupPrimitivesAspect(m_aspectShaded);
+        group->AddPrimitiveArray(this->createShrinkTrianglesArray());
+    }
+
+    if (m_nodesVisible) {
+        const TColgp_Array1OfPnt& vecNode = m_mesh->Nodes();
+        Handle_Graphic3d_ArrayOfPoints arrayNodes = new Graphic3d_ArrayOfPoints(vecNode.Length());
+        for (const gp_Pnt& pnt : vecNode)
+            arrayNodes->AddVertex(pnt);
+
+        Handle_Graphic3d_Group groupNodes = pres->NewGroup();
+        groupNodes->SetGroupPrimitivesAspect(m_aspectNodes);
+        groupNodes->AddPrimitiveArray(arrayNodes);
+    }
+}
+
+const Handle_Graphic3d_ArrayOfTriangles& AIS_Mesh::trianglesArray()
+{
+    if (!m_arrayTriangles.IsNull())
+        return m_arrayTriangles;
+
+    const int nodeCount = m_mesh->NbNodes();
+    const Poly_Array1OfTriangle& vecTriangle = m_mesh->Triangles();
+    m_arrayTriangles = new Graphic3d_ArrayOfTriangles(nodeCount, 3 * vecTriangle.Length(), true);
+
+    // Vertex attributes are {position, normal}, written straight into the array
+    // buffer when its layout is the expected one
+    // Buffer is reallocated by Init(), vertices must not be accessed through
+    // the array afterwards(it may cache pointers to the former data)
+    const Handle_Graphic3d_Buffer buffer = m_arrayTriangles->Attributes();
+    const Graphic3d_Attribute attribs[] = {
+        { Graphic3d_TOA_POS, Graphic3d_TOD_VEC3 },
+        { Graphic3d_TOA_NORM, Graphic3d_TOD_VEC3 }
+    };
+    if (Internal::isPositionNormalLayout(buffer)
+            && buffer->Init(nodeCount, attribs, 2)
+            && Internal::isPositionNormalLayout(buffer)
+            && buffer->NbElements == nodeCount)
+    {
+        MeshUtils::fillPositionNormalBuffer(m_mesh, reinterpret_cast<float*>(buffer->ChangeData()));
+    }
+    else {
+        m_arrayTriangles = new Graphic3d_ArrayOfTriangles(nodeCount, 3 * vecTriangle.Length(), true);
+        std::vector<float> vecCoord(6 * nodeCount);
+        MeshUtils::fillPositionNormalBuffer(m_mesh, vecCoord.data());
+        for (int i = 0; i < nodeCount; ++i) {
+            const float* coords = vecCoord.data() + 6 * i;
+            m_arrayTriangles->AddVertex(
+                        coords[0], coords[1], coords[2], coords[3], coords[4], coords[5]);
+        }
+    }
+
+    const int nodeIdOffset = 1 - m_mesh->Nodes().Lower();
+    for (const Poly_Triangle& tri : vecTriangle) {
+        int n1, n2, n3;
+        tri.Get(n1, n2, n3);
+        m_arrayTriangles->AddEdge(n1 + nodeIdOffset);
+        m_arrayTriangles->AddEdge(n2 + nodeIdOffset);
+        m_arrayTriangles->AddEdge(n3 + nodeIdOffset);
+    }
+
+    return m_arrayTriangles;
+}
+
+Handle_Graphic3d_ArrayOfTriangles AIS_Mesh::createShrinkTrianglesArray() const
+{
+    // Each triangle is scaled towards its center, so vertices can't be shared
+    constexpr double shrinkCoeff = 0.75;
+    const TColgp_Array1OfPnt& vecNode = m_mesh->Nodes();
+    const Poly_Array1OfTriangle& vecTriangle = m_mesh->Triangles();
+    Handle_Graphic3d_ArrayOfTriangles array =
+            new Graphic3d_ArrayOfTriangles(3 * vecTriangle.Length(), 0, true);
+    for (const Poly_Triangle& tri : vecTriangle) {
+        int n1, n2, n3;
+        tri.Get(n1, n2, n3);
+        const gp_XYZ& p1 = vecNode.Value(n1).Coord();
+        const gp_XYZ& p2 = vecNode.Value(n2).Coord();
+        const gp_XYZ& p3 = vecNode.Value(n3).Coord();
+        const gp_XYZ center = (p1 + p2 + p3) / 3.;
+        gp_XYZ normal = (p2 - p1).Crossed(p3 - p1);
+        if (normal.Modulus() <= gp::Resolution())
+            normal.SetCoord(0., 0., 1.);
+
+        const gp_Dir dirNormal(normal);
+        for (const gp_XYZ* ptrPnt : { &p1, &p2, &p3 })
+            array->AddVertex(gp_Pnt(center + shrinkCoeff * (*ptrPnt - center)), dirNormal);
+    }
+
+    return array;
+}
+
+void AIS_Mesh::updateAspects()
+{
+    // Aspects are shared by the presentation groups
+    Graphic3d_MaterialAspect material = myDrawer->ShadingAspect()->Material();
+    if (this->HasColor()) {
+        material.SetColor(myDrawer->Color());
+        m_aspectShaded->SetInteriorColor(myDrawer->Color());
+        m_aspectWireframe->SetEdgeColor(myDrawer->Color());
+    }
+
+    m_aspectShaded->SetFrontMaterial(material);
+    m_aspectShaded->SetBackMaterial(material);
+
+    if (m_edgesVisible)
+        m_aspectShaded->SetEdgeOn();
+    else
+        m_aspectShaded->SetEdgeOff();
+
+#if OCC_VERSION_HEX >= 0x070400
+    // Groups refer to aspects, they just have to be notified
+    this->SynchronizeAspects();
+#else
+    // Groups hold copies of aspects, geometry arrays are kept anyway
+    if (!this->Presentations().IsEmpty())
+        this->SetToUpdate();
+#endif
+}
+
+} // namespace Mayo
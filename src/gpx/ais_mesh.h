@@ -0,0 +1,75 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <AIS_InteractiveObject.hxx>
+#include <Graphic3d_ArrayOfTriangles.hxx>
+#include <Graphic3d_AspectFillArea3d.hxx>
+#include <Graphic3d_AspectMarker3d.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <PrsMgr_PresentationManager3d.hxx>
+#include <SelectMgr_Selection.hxx>
+
+namespace Mayo {
+
+// Presentation of a Poly_Triangulation as a single array of triangles, node
+// coordinates and normals being interleaved in one buffer
+// The array is built once and shared by the wireframe and shaded modes,
+// changing color, material or edges visibility only updates aspects
+// Pending changes are applied with AIS_InteractiveContext::Update()
+class AIS_Mesh : public AIS_InteractiveObject {
+public:
+    enum DisplayMode {
+        DisplayMode_Wireframe = 0,
+        DisplayMode_Shaded = 1,
+        DisplayMode_Shrink = 2
+    };
+
+    AIS_Mesh(const Handle_Poly_Triangulation& mesh);
+
+    const Handle_Poly_Triangulation& triangulation() const { return m_mesh; }
+
+    void SetColor(const Quantity_Color& color) override;
+    void SetMaterial(const Graphic3d_MaterialAspect& material) override;
+
+    bool isEdgesVisible() const { return m_edgesVisible; }
+    void setEdgesVisible(bool on);
+
+    // Nodes are drawn with a separate array, so presentation is recomputed
+    bool isNodesVisible() const { return m_nodesVisible; }
+    void setNodesVisible(bool on);
+
+    bool AcceptDisplayMode(const int mode) const override;
+
+    void ComputeSelection(
+            const opencascade::handle<SelectMgr_Selection>& sel,
+            const int mode) override;
+
+protected:
+    void Compute(
+            const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+            const opencascade::handle<Prs3d_Presentation>& pres,
+            const int mode) override;
+
+private:
+    const Handle_Graphic3d_ArrayOfTriangles& trianglesArray();
+    Handle_Graphic3d_ArrayOfTriangles createShrinkTrianglesArray() const;
+    void updateAspects();
+
+    Handle_Poly_Triangulation m_mesh;
+    Handle_Graphic3d_ArrayOfTriangles m_arrayTriangles;
+    Handle_Graphic3d_AspectFillArea3d m_aspectShaded;
+    Handle_Graphic3d_AspectFillArea3d m_aspectWireframe;
+    Handle_Graphic3d_AspectMarker3d m_aspectNodes;
+    bool m_edgesVisible = false;
+    bool m_nodesVisible = false;
+};
+
+DEFINE_STANDARD_HANDLE(AIS_Mesh, AIS_InteractiveObject)
+
+} // namespace Mayo
@@ -59,6 +59,14 @@ std::vector<Handle_SelectMgr_EntityOwner> GpxDocumentItem::entityOwners(int /*mo
     return std::vector<Handle_SelectMgr_EntityOwner>();
 }
 
+void GpxDocumentItem::enterReducedDetail(double /*projectedArea*/)
+{
+}
+
+void GpxDocumentItem::restoreFullDetail()
+{
+}
+
 void GpxDocumentItem::onPropertyChanged(Property *prop)
 {
     if (prop == &this->propertyIsVisible) {
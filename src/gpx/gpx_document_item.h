@@ -33,6 +33,11 @@ public:
     virtual std::vector<Handle_SelectMgr_EntityOwner> entityOwners(int mode) const;
     virtual Bnd_Box boundingBox() const = 0;
 
+    // Lighter presentation while the view is manipulated, 'projectedArea' is
+    // the area(in pixels) covered on screen by the bounding box of the item
+    virtual void enterReducedDetail(double projectedArea);
+    virtual void restoreFullDetail();
+
     PropertyBool propertyIsVisible;
     PropertyEnumeration propertyMaterial;
     PropertyOccColor propertyColor;
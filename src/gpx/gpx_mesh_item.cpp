@@ -9,11 +9,6 @@
 
 #include <fougtools/occtools/qt_utils.h>
 #include <AIS_InteractiveContext.hxx>
-#include <MeshVS_DrawerAttribute.hxx>
-#include <MeshVS_Drawer.hxx>
-#include <MeshVS_Mesh.hxx>
-#include <MeshVS_MeshPrsBuilder.hxx>
-#include <XSDRAWSTLVRML_DataSource.hxx>
 
 namespace Mayo {
 
@@ -21,9 +16,11 @@ namespace Internal {
 
 Q_GLOBAL_STATIC(GpxMeshItem::DefaultValues, defaultValues)
 
-static void redisplayAndUpdateViewer(const Handle_AIS_InteractiveObject& gpx)
+// Applies pending changes of presentation, geometry is recomputed only if
+// needed(eg nodes visibility)
+static void updateAndUpdateViewer(const Handle_AIS_InteractiveObject& gpx)
 {
-    gpx->Redisplay(true); // All modes
+    gpx->GetContext()->Update(gpx, false);
     gpx->GetContext()->UpdateCurrentViewer();
 }
 
@@ -35,54 +32,32 @@ GpxMeshItem::GpxMeshItem(MeshItem *item)
       propertyShowNodes(this, tr("Show nodes")),
       m_meshItem(item)
 {
-    // Create the MeshVS_Mesh object
-    Handle_XSDRAWSTLVRML_DataSource dataSource =
-            new XSDRAWSTLVRML_DataSource(item->triangulation());
-    Handle_MeshVS_Mesh meshVisu = new MeshVS_Mesh;
-    meshVisu->SetDataSource(dataSource);
-    // meshVisu->AddBuilder(..., false); -> No selection
-    meshVisu->AddBuilder(new MeshVS_MeshPrsBuilder(meshVisu), true);
-    // -- MeshVS_DrawerAttribute
-    meshVisu->GetDrawer()->SetBoolean(
-                MeshVS_DA_ShowEdges, GpxMeshItem::defaultValues().showEdges);
-    meshVisu->GetDrawer()->SetBoolean(
-                MeshVS_DA_DisplayNodes, GpxMeshItem::defaultValues().showNodes);
-    meshVisu->GetDrawer()->SetMaterial(
-                MeshVS_DA_FrontMaterial,
-                Graphic3d_MaterialAspect(GpxMeshItem::defaultValues().material));
-    meshVisu->GetDrawer()->SetColor(
-                MeshVS_DA_InteriorColor,
-                occ::QtUtils::toOccColor(GpxMeshItem::defaultValues().color));
-    meshVisu->SetDisplayMode(MeshVS_DMF_Shading);
-    // -- Wireframe as default highlight mode
-    meshVisu->SetHilightMode(MeshVS_DMF_WireFrame);
-    meshVisu->SetMeshSelMethod(MeshVS_MSM_PRECISE);
-
+    Handle_AIS_Mesh meshVisu = new AIS_Mesh(item->triangulation());
+    meshVisu->setEdgesVisible(GpxMeshItem::defaultValues().showEdges);
+    meshVisu->setNodesVisible(GpxMeshItem::defaultValues().showNodes);
+    meshVisu->SetMaterial(Graphic3d_MaterialAspect(GpxMeshItem::defaultValues().material));
+    meshVisu->SetColor(occ::QtUtils::toOccColor(GpxMeshItem::defaultValues().color));
+    meshVisu->SetDisplayMode(AIS_Mesh::DisplayMode_Shaded);
     m_meshVisu = meshVisu;
 
     // Init properties
-    Mayo_PropertyChangedBlocker(this);
-    // -- Material
-    Graphic3d_MaterialAspect materialAspect;
-    meshVisu->GetDrawer()->GetMaterial(MeshVS_DA_FrontMaterial, materialAspect);
-    this->propertyMaterial.setValue(materialAspect.Name());
-    // -- Color
-    Quantity_Color color;
-    meshVisu->GetDrawer()->GetColor(MeshVS_DA_InteriorColor, color);
-    this->propertyColor.setValue(color);
-    // -- Display mode
-    this->propertyDisplayMode.setValue(meshVisu->DisplayMode());
-    // -- Show edges
-    bool boolVal;
-    meshVisu->GetDrawer()->GetBoolean(MeshVS_DA_ShowEdges, boolVal);
-    this->propertyShowEdges.setValue(boolVal);
-    // -- Show nodes
-    meshVisu->GetDrawer()->GetBoolean(MeshVS_DA_DisplayNodes, boolVal);
-    this->propertyShowNodes.setValue(boolVal);
+    {
+        Mayo_PropertyChangedBlocker(this);
+        this->propertyMaterial.setValue(GpxMeshItem::defaultValues().material);
+        this->propertyColor.setValue(occ::QtUtils::toOccColor(GpxMeshItem::defaultValues().color));
+        this->propertyDisplayMode.setValue(meshVisu->DisplayMode());
+        this->propertyShowEdges.setValue(meshVisu->isEdgesVisible());
+        this->propertyShowNodes.setValue(meshVisu->isNodesVisible());
+    }
+
+    this->updateLodAttributes();
+    const Handle_Poly_Triangulation mesh = item->triangulation();
+    m_lod.build(tr("Levels of detail"), [=]{ return mesh; });
 }
 
 GpxMeshItem::~GpxMeshItem()
 {
+    m_lod.clearPresentations(this->context());
     GpxUtils::AisContext_eraseObject(this->context(), m_meshVisu);
 }
 
@@ -114,6 +89,30 @@ Bnd_Box GpxMeshItem::boundingBox() const
     return GpxUtils::AisObject_boundingBox(m_meshVisu);
 }
 
+void GpxMeshItem::enterReducedDetail(double projectedArea)
+{
+    if (!this->propertyIsVisible.value() || !m_meshVisuLod.IsNull())
+        return;
+
+    m_meshVisuLod = m_lod.levelPresentation(projectedArea);
+    if (!m_meshVisuLod.IsNull()) {
+        // Level of detail isn't selectable
+        this->context()->Display(m_meshVisuLod, m_meshVisuLod->DisplayMode(), -1, false);
+        this->context()->Erase(m_meshVisu, false);
+    }
+}
+
+void GpxMeshItem::restoreFullDetail()
+{
+    if (m_meshVisuLod.IsNull())
+        return;
+
+    // Level of detail is just erased, its presentation is kept for next time
+    this->context()->Display(m_meshVisu, false);
+    this->context()->Erase(m_meshVisuLod, false);
+    m_meshVisuLod.Nullify();
+}
+
 const GpxMeshItem::DefaultValues& GpxMeshItem::defaultValues()
 {
     return *Internal::defaultValues;
@@ -126,44 +125,51 @@ void GpxMeshItem::setDefaultValues(const DefaultValues& values)
 
 void GpxMeshItem::onPropertyChanged(Property* prop)
 {
+    this->restoreFullDetail();
+    this->updateLodAttributes();
     if (prop == &this->propertyMaterial) {
         const Graphic3d_NameOfMaterial mat =
                 this->propertyMaterial.valueAs<Graphic3d_NameOfMaterial>();
-        m_meshVisu->GetDrawer()->SetMaterial(
-                    MeshVS_DA_FrontMaterial, Graphic3d_MaterialAspect(mat));
-        Internal::redisplayAndUpdateViewer(m_meshVisu);
+        m_meshVisu->SetMaterial(Graphic3d_MaterialAspect(mat));
+        Internal::updateAndUpdateViewer(m_meshVisu);
     }
     else if (prop == &this->propertyColor) {
-        m_meshVisu->GetDrawer()->SetColor(
-                    MeshVS_DA_InteriorColor, this->propertyColor.value());
-        Internal::redisplayAndUpdateViewer(m_meshVisu);
+        m_meshVisu->SetColor(this->propertyColor.value());
+        Internal::updateAndUpdateViewer(m_meshVisu);
     }
     else if (prop == &this->propertyDisplayMode) {
         this->context()->SetDisplayMode(
                     m_meshVisu, this->propertyDisplayMode.value(), true);
-        //ptrGpx->SetDisplayMode(this->propertyDisplayMode.value());
     }
     else if (prop == &this->propertyShowEdges) {
-        m_meshVisu->GetDrawer()->SetBoolean(
-                    MeshVS_DA_ShowEdges, this->propertyShowEdges.value());
-        Internal::redisplayAndUpdateViewer(m_meshVisu);
+        m_meshVisu->setEdgesVisible(this->propertyShowEdges.value());
+        Internal::updateAndUpdateViewer(m_meshVisu);
     }
     else if (prop == &this->propertyShowNodes) {
-        m_meshVisu->GetDrawer()->SetBoolean(
-                    MeshVS_DA_DisplayNodes, this->propertyShowNodes.value());
-        Internal::redisplayAndUpdateViewer(m_meshVisu);
+        m_meshVisu->setNodesVisible(this->propertyShowNodes.value());
+        Internal::updateAndUpdateViewer(m_meshVisu);
     }
 
     GpxDocumentItem::onPropertyChanged(prop);
 }
 
+void GpxMeshItem::updateLodAttributes()
+{
+    GpxMeshLod::Attributes attribs;
+    attribs.color = this->propertyColor.value();
+    attribs.material = this->propertyMaterial.valueAs<Graphic3d_NameOfMaterial>();
+    attribs.displayMode = static_cast<AIS_Mesh::DisplayMode>(this->propertyDisplayMode.value());
+    attribs.edgesVisible = this->propertyShowEdges.value();
+    m_lod.setAttributes(attribs);
+}
+
 const Enumeration &GpxMeshItem::enum_DisplayMode()
 {
     static Enumeration enumeration;
     if (enumeration.size() == 0) {
-        enumeration.addItem(MeshVS_DMF_WireFrame, tr("Wireframe"));
-        enumeration.addItem(MeshVS_DMF_Shading, tr("Shaded"));
-        enumeration.addItem(MeshVS_DMF_Shrink, tr("Shrink"));
+        enumeration.addItem(AIS_Mesh::DisplayMode_Wireframe, tr("Wireframe"));
+        enumeration.addItem(AIS_Mesh::DisplayMode_Shaded, tr("Shaded"));
+        enumeration.addItem(AIS_Mesh::DisplayMode_Shrink, tr("Shrink"));
     }
 
     return enumeration;
@@ -6,9 +6,10 @@
 
 #pragma once
 
+#include "ais_mesh.h"
 #include "gpx_document_item.h"
+#include "gpx_mesh_lod.h"
 #include "../base/mesh_item.h"
-#include <MeshVS_Mesh.hxx>
 #include <QtGui/QColor>
 
 namespace Mayo {
@@ -26,6 +27,9 @@ public:
     std::vector<Handle_SelectMgr_EntityOwner> entityOwners(int mode) const override;
     Bnd_Box boundingBox() const override;
 
+    void enterReducedDetail(double projectedArea) override;
+    void restoreFullDetail() override;
+
     PropertyEnumeration propertyDisplayMode;
     PropertyBool propertyShowEdges;
     PropertyBool propertyShowNodes;
@@ -45,8 +49,13 @@ protected:
 
 private:
     static const Enumeration& enum_DisplayMode();
+    void updateLodAttributes();
+
     MeshItem* m_meshItem = nullptr;
-    Handle_MeshVS_Mesh m_meshVisu;
+    Handle_AIS_Mesh m_meshVisu;
+    GpxMeshLod m_lod;
+    // Level of detail currently displayed instead of m_meshVisu
+    Handle_AIS_Mesh m_meshVisuLod;
 };
 
 } // namespace Mayo
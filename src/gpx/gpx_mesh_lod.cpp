@@ -0,0 +1,96 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "gpx_mesh_lod.h"
+#include "gpx_utils.h"
+#include "../base/mesh_lod.h"
+
+#include <fougtools/qttools/task/manager.h>
+#include <fougtools/qttools/task/runner_stdasync.h>
+
+namespace Mayo {
+
+void GpxMeshLod::build(const QString& taskTitle, const SourceFunction& fnSource)
+{
+    // Data is shared with the task, so it's safe to destroy 'this' while levels
+    // are being built
+    auto data = std::make_shared<Data>();
+    m_data = data;
+    m_vecLevelPrs.clear();
+    auto task = qttask::Manager::globalInstance()->newTask<qttask::StdAsync>();
+    task->setTaskTitle(taskTitle);
+    task->run([=]{
+        const Handle_Poly_Triangulation mesh = fnSource();
+        if (!mesh.IsNull() && mesh->NbTriangles() >= GpxMeshLod::minTriangleCount()) {
+            data->vecLevel = MeshLod::buildLevels(mesh, 4, 4, &task->progress());
+            data->ready.store(true, std::memory_order_release);
+        }
+    });
+}
+
+bool GpxMeshLod::isReady() const
+{
+    return m_data && m_data->ready.load(std::memory_order_acquire);
+}
+
+int GpxMeshLod::minTriangleCount()
+{
+    return 200000;
+}
+
+void GpxMeshLod::setAttributes(const Attributes& attribs)
+{
+    m_attribs = attribs;
+    for (const Handle_AIS_Mesh& prs : m_vecLevelPrs) {
+        if (!prs.IsNull())
+            GpxMeshLod::applyAttributes(prs, attribs);
+    }
+}
+
+void GpxMeshLod::clearPresentations(const Handle_AIS_InteractiveContext& ctx)
+{
+    for (const Handle_AIS_Mesh& prs : m_vecLevelPrs)
+        GpxUtils::AisContext_eraseObject(ctx, prs);
+
+    m_vecLevelPrs.clear();
+}
+
+Handle_AIS_Mesh GpxMeshLod::levelPresentation(double projectedArea)
+{
+    if (!this->isReady())
+        return Handle_AIS_Mesh();
+
+    const std::vector<Handle_Poly_Triangulation>& vecLevel = m_data->vecLevel;
+    std::vector<int> vecLevelTriangleCount;
+    vecLevelTriangleCount.reserve(vecLevel.size());
+    for (const Handle_Poly_Triangulation& level : vecLevel)
+        vecLevelTriangleCount.push_back(level->NbTriangles());
+
+    const int levelId = MeshLod::selectLevel(vecLevelTriangleCount, projectedArea);
+    if (levelId <= 0)
+        return Handle_AIS_Mesh();
+
+    // Presentations are created on first use
+    m_vecLevelPrs.resize(vecLevel.size());
+    Handle_AIS_Mesh& prs = m_vecLevelPrs.at(levelId);
+    if (prs.IsNull()) {
+        prs = new AIS_Mesh(vecLevel.at(levelId));
+        GpxMeshLod::applyAttributes(prs, m_attribs);
+    }
+
+    return prs;
+}
+
+void GpxMeshLod::applyAttributes(const Handle_AIS_Mesh& prs, const Attributes& attribs)
+{
+    // Only aspects are updated, presentations already computed are kept
+    prs->SetColor(attribs.color);
+    prs->SetMaterial(Graphic3d_MaterialAspect(attribs.material));
+    prs->setEdgesVisible(attribs.edgesVisible);
+    prs->SetDisplayMode(attribs.displayMode);
+}
+
+} // namespace Mayo
@@ -0,0 +1,65 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "ais_mesh.h"
+#include <AIS_InteractiveContext.hxx>
+#include <Graphic3d_NameOfMaterial.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Quantity_Color.hxx>
+#include <QtCore/QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Mayo {
+
+// Decimated presentations of a mesh, used in place of the full detail
+// presentation while the view is manipulated
+class GpxMeshLod {
+public:
+    using SourceFunction = std::function<Handle_Poly_Triangulation()>;
+
+    // Levels are built in a background task which first calls 'fnSource' to
+    // get the full detail mesh
+    // Nothing is built if the mesh has less than minTriangleCount() triangles
+    void build(const QString& taskTitle, const SourceFunction& fnSource);
+    bool isReady() const;
+
+    static int minTriangleCount();
+
+    // Display attributes of the presentations, those already created are
+    // updated in place by setAttributes()
+    struct Attributes {
+        Quantity_Color color;
+        Graphic3d_NameOfMaterial material = Graphic3d_NOM_PLASTIC;
+        AIS_Mesh::DisplayMode displayMode = AIS_Mesh::DisplayMode_Shaded;
+        bool edgesVisible = false;
+    };
+    void setAttributes(const Attributes& attribs);
+    // Removes from 'ctx' the presentations created so far
+    void clearPresentations(const Handle_AIS_InteractiveContext& ctx);
+
+    // Presentation of the level fitting 'projectedArea'(in pixels)
+    // Returns null if levels are not ready or if full detail fits
+    Handle_AIS_Mesh levelPresentation(double projectedArea);
+
+private:
+    static void applyAttributes(const Handle_AIS_Mesh& prs, const Attributes& attribs);
+
+    struct Data {
+        std::atomic<bool> ready = {};
+        std::vector<Handle_Poly_Triangulation> vecLevel;
+    };
+
+    std::shared_ptr<Data> m_data;
+    std::vector<Handle_AIS_Mesh> m_vecLevelPrs;
+    Attributes m_attribs;
+};
+
+} // namespace Mayo
@@ -9,6 +9,7 @@
 #include "../base/math_utils.h"
 
 #include <algorithm>
+#include <climits>
 #include <Bnd_Box.hxx>
 #include <ElSLib.hxx>
 #include <ProjLib.hxx>
@@ -66,6 +67,27 @@ gp_Pnt GpxUtils::V3dView_to3dPosition(
     return pntResult;
 }
 
+double GpxUtils::V3dView_projectedArea(const Handle_V3d_View& view, const Bnd_Box& box)
+{
+    if (box.IsVoid())
+        return 0.;
+
+    int xMin = INT_MAX;
+    int yMin = INT_MAX;
+    int xMax = INT_MIN;
+    int yMax = INT_MIN;
+    for (const gp_Pnt& pnt : BndBoxCoords::get(box).vertices()) {
+        int x, y;
+        view->Convert(pnt.X(), pnt.Y(), pnt.Z(), x, y);
+        xMin = std::min(xMin, x);
+        yMin = std::min(yMin, y);
+        xMax = std::max(xMax, x);
+        yMax = std::max(yMax, y);
+    }
+
+    return double(xMax - xMin) * double(yMax - yMin);
+}
+
 void GpxUtils::AisContext_eraseObject(
         const Handle_AIS_InteractiveContext& context,
         const Handle_AIS_InteractiveObject& object)
@@ -20,6 +20,8 @@ struct GpxUtils {
             const Handle_Graphic3d_ClipPlane& plane);
     static gp_Pnt V3dView_to3dPosition(
             const Handle_V3d_View& view, double x, double y);
+    // Area(in pixels) of the screen rectangle enclosing projected 'box'
+    static double V3dView_projectedArea(const Handle_V3d_View& view, const Bnd_Box& box);
 
     static void AisContext_eraseObject(
             const Handle_AIS_InteractiveContext& context,
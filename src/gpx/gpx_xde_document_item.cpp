@@ -6,13 +6,18 @@
 
 #include "gpx_xde_document_item.h"
 
+#include "../base/mesh_lod.h"
 #include "../base/span.h"
 #include "gpx_utils.h"
 
 #include <fougtools/occtools/qt_utils.h>
 #include <AIS_InteractiveContext.hxx>
 #include <AIS_InteractiveObject.hxx>
+#include <BRep_Builder.hxx>
+#include <BRepTools.hxx>
 #include <Graphic3d_NameOfMaterial.hxx>
+#include <Precision.hxx>
+#include <Standard_Version.hxx>
 #include <QtCore/QCoreApplication>
 #include <cassert>
 
@@ -22,8 +27,84 @@ namespace Internal {
 
 Q_GLOBAL_STATIC(GpxXdeDocumentItem::DefaultValues, defaultValues)
 
+static int aisDisplayMode(GpxXdeDocumentItem::DisplayMode mode)
+{
+    switch (mode) {
+    case GpxXdeDocumentItem::DisplayMode_Wireframe: return AIS_WireFrame;
+    case GpxXdeDocumentItem::DisplayMode_Shaded: return AIS_Shaded;
+    case GpxXdeDocumentItem::DisplayMode_ShadedWithFaceBoundary:
+#if OCC_VERSION_HEX >= 0x070400
+        return XdeShapePrs::DisplayMode_ShadedWithFaceBoundary;
+#else
+        return AIS_Shaded;
+#endif
+    }
+
+    return AIS_Shaded;
+}
+
+static Handle_XCAFPrs_AISObject createXdeGpx(const TDF_Label& label)
+{
+#if OCC_VERSION_HEX >= 0x070400
+    Handle_XCAFPrs_AISObject gpx = new XdeShapePrs(label);
+#else
+    Handle_XCAFPrs_AISObject gpx = new XCAFPrs_AISObject(label);
+    gpx->Attributes()->SetFaceBoundaryDraw(true);
+#endif
+    gpx->SetMaterial(GpxXdeDocumentItem::defaultValues().material);
+    gpx->SetDisplayMode(aisDisplayMode(GpxXdeDocumentItem::DisplayMode_ShadedWithFaceBoundary));
+    gpx->SetColor(occ::QtUtils::toOccColor(GpxXdeDocumentItem::defaultValues().color));
+    gpx->Attributes()->SetIsoOnTriangulation(true);
+    // Shape already meshed at import (see Application::MeshingParameters)
+    // so presentation just has to use the existing triangulation
+    if (BRepTools::Triangulation(XdeDocumentItem::shape(label), Precision::Infinite()))
+        gpx->Attributes()->SetAutoTriangulation(false);
+
+    return gpx;
+}
+
+// Instancing pays off only when some prototype is drawn more than once
+static bool hasSharedPrototype(const std::vector<XdeDocumentItem::ShapePrototype>& vecPrototype)
+{
+    for (const XdeDocumentItem::ShapePrototype& prototype : vecPrototype) {
+        if (prototype.vecInstanceLocation.size() > 1)
+            return true;
+    }
+
+    return false;
+}
+
 } // namespace Internal
 
+#if OCC_VERSION_HEX >= 0x070400
+XdeShapePrs::XdeShapePrs(const TDF_Label& label)
+    : XCAFPrs_AISObject(label)
+{
+}
+
+bool XdeShapePrs::AcceptDisplayMode(const int mode) const
+{
+    return mode == DisplayMode_ShadedWithFaceBoundary
+            || XCAFPrs_AISObject::AcceptDisplayMode(mode);
+}
+
+void XdeShapePrs::Compute(
+        const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+        const opencascade::handle<Prs3d_Presentation>& pres,
+        const int mode)
+{
+    if (mode == DisplayMode_ShadedWithFaceBoundary) {
+        // Drawer is shared by all the display modes
+        myDrawer->SetFaceBoundaryDraw(true);
+        XCAFPrs_AISObject::Compute(pm, pres, AIS_Shaded);
+        myDrawer->SetFaceBoundaryDraw(false);
+    }
+    else {
+        XCAFPrs_AISObject::Compute(pm, pres, mode);
+    }
+}
+#endif
+
 GpxXdeDocumentItem::GpxXdeDocumentItem(XdeDocumentItem* item)
     : propertyTransparency(this, tr("Transparency"), 0, 100, 5),
       propertyDisplayMode(this, tr("Display mode"), &enumDisplayMode()),
@@ -39,33 +120,75 @@ GpxXdeDocumentItem::GpxXdeDocumentItem(XdeDocumentItem* item)
     // shape.
     const TDF_LabelSequence seqFreeShape = item->topLevelFreeShapes();
     if (!seqFreeShape.IsEmpty()) {
-        m_vecXdeGpx.reserve(seqFreeShape.Size());
-        Mayo_PropertyChangedBlocker(this);
-        for (const TDF_Label& label : seqFreeShape) {
-            Handle_XCAFPrs_AISObject gpx = new XCAFPrs_AISObject(label);
-            gpx->SetMaterial(GpxXdeDocumentItem::defaultValues().material);
-            gpx->SetDisplayMode(AIS_Shaded);
-            gpx->SetColor(occ::QtUtils::toOccColor(GpxXdeDocumentItem::defaultValues().color));
-            gpx->Attributes()->SetFaceBoundaryDraw(true);
-            gpx->Attributes()->SetIsoOnTriangulation(true);
-            this->propertyMaterial.setValue(GpxXdeDocumentItem::defaultValues().material);
-            Quantity_Color color;
-            gpx->Color(color);
-            this->propertyColor.setValue(color);
-            this->propertyDisplayMode.setValue(DisplayMode_ShadedWithFaceBoundary);
-            this->propertyTransparency.setValue(static_cast<int>(gpx->Transparency() * 100));
-            m_vecXdeGpx.push_back(gpx);
+        std::vector<XdeDocumentItem::ShapePrototype> vecPrototype;
+        if (GpxXdeDocumentItem::defaultValues().instancing)
+            vecPrototype = item->shapePrototypes();
+
+        if (Internal::hasSharedPrototype(vecPrototype)) {
+            // Presentation of a prototype is computed once, instances are connected
+            // to it with their own transformation
+            // Note that colors assigned to components(instance level) are not
+            // honored, only those of the prototypes
+            m_gpxInstances = new AIS_MultipleConnectedInteractive;
+            m_gpxInstances->SetDisplayMode(
+                        Internal::aisDisplayMode(DisplayMode_ShadedWithFaceBoundary));
+            m_vecXdeGpx.reserve(vecPrototype.size());
+            for (const XdeDocumentItem::ShapePrototype& prototype : vecPrototype) {
+                Handle_XCAFPrs_AISObject gpx = Internal::createXdeGpx(prototype.label);
+                for (const TopLoc_Location& loc : prototype.vecInstanceLocation)
+                    m_gpxInstances->Connect(gpx, loc.Transformation());
+
+                m_vecXdeGpx.push_back(gpx);
+            }
+
+            m_vecGpx.push_back(m_gpxInstances);
+        }
+        else {
+            TopoDS_Compound shapeLod;
+            BRep_Builder builder;
+            builder.MakeCompound(shapeLod);
+            m_vecXdeGpx.reserve(seqFreeShape.Size());
+            for (const TDF_Label& label : seqFreeShape) {
+                Handle_XCAFPrs_AISObject gpx = Internal::createXdeGpx(label);
+                m_vecXdeGpx.push_back(gpx);
+                m_vecGpx.push_back(gpx);
+                builder.Add(shapeLod, XdeDocumentItem::shape(label));
+            }
+
+            // Levels of detail are decimated from the triangulations the faces
+            // have now(ie meshed at import). They are collected in this thread
+            // because faces can be meshed concurrently by the presentations
+            // when automatic triangulation is on
+            const std::vector<MeshLod::FaceTriangulation> vecFaceTri =
+                    MeshLod::faceTriangulations(shapeLod);
+            if (!vecFaceTri.empty()) {
+                m_lod.build(tr("Levels of detail"), [=]{
+                    return MeshLod::mergeTriangulations(vecFaceTri);
+                });
+            }
         }
+
+        Mayo_PropertyChangedBlocker(this);
+        const Handle_XCAFPrs_AISObject& gpx = m_vecXdeGpx.front();
+        this->propertyMaterial.setValue(GpxXdeDocumentItem::defaultValues().material);
+        Quantity_Color color;
+        gpx->Color(color);
+        this->propertyColor.setValue(color);
+        this->propertyDisplayMode.setValue(DisplayMode_ShadedWithFaceBoundary);
+        this->propertyTransparency.setValue(static_cast<int>(gpx->Transparency() * 100));
+        this->updateLodAttributes();
     }
     else { // Dummy
         Handle_XCAFPrs_AISObject gpx = new XCAFPrs_AISObject(item->cafDoc()->Main());
         m_vecXdeGpx.push_back(gpx);
+        m_vecGpx.push_back(gpx);
     }
 }
 
 GpxXdeDocumentItem::~GpxXdeDocumentItem()
 {
-    for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx)
+    m_lod.clearPresentations(this->context());
+    for (const Handle_AIS_InteractiveObject& obj : m_vecGpx)
         GpxUtils::AisContext_eraseObject(this->context(), obj);
 }
 
@@ -77,7 +200,7 @@ XdeDocumentItem *GpxXdeDocumentItem::documentItem() const
 void GpxXdeDocumentItem::setVisible(bool on)
 {
     Mayo::GpxDocumentItem::setVisible(on);
-    for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx)
+    for (const Handle_AIS_InteractiveObject& obj : m_vecGpx)
         GpxUtils::AisContext_setObjectVisible(this->context(), obj, on);
 
     if (on && !m_selectionActivated) {
@@ -90,27 +213,12 @@ void GpxXdeDocumentItem::setVisible(bool on)
         m_selectionActivated = false;
 }
 
-static int toAisShapeSelectionMode(GpxXdeDocumentItem::SelectionMode mode)
-{
-    using Gpx = GpxXdeDocumentItem;
-    switch (mode) {
-    case Gpx::SelectVertex: return AIS_Shape::SelectionMode(TopAbs_VERTEX);
-    case Gpx::SelectEdge: return AIS_Shape::SelectionMode(TopAbs_EDGE);
-    case Gpx::SelectWire: return AIS_Shape::SelectionMode(TopAbs_WIRE);
-    case Gpx::SelectFace: return AIS_Shape::SelectionMode(TopAbs_FACE);
-    case Gpx::SelectShell: return AIS_Shape::SelectionMode(TopAbs_SHELL);
-    case Gpx::SelectSolid: return AIS_Shape::SelectionMode(TopAbs_SOLID);
-    }
-
-    return AIS_Shape::SelectionMode(TopAbs_SHAPE);
-}
-
 void GpxXdeDocumentItem::activateSelection(int mode)
 {
     const auto typedMode = static_cast<SelectionMode>(mode);
     if (this->propertyIsVisible.value()) {
-        for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx)
-            this->context()->Activate(obj, toAisShapeSelectionMode(typedMode));
+        for (const Handle_AIS_InteractiveObject& obj : m_vecGpx)
+            this->context()->Activate(obj, GpxXdeDocumentItem::aisSelectionMode(typedMode));
     }
 
     m_selectionActivated = this->propertyIsVisible.value();
@@ -120,62 +228,123 @@ void GpxXdeDocumentItem::activateSelection(int mode)
 std::vector<Handle_SelectMgr_EntityOwner> GpxXdeDocumentItem::entityOwners(int mode) const
 {
     const auto typedMode = static_cast<SelectionMode>(mode);
-    const int aisMode = toAisShapeSelectionMode(typedMode);
+    const int aisMode = GpxXdeDocumentItem::aisSelectionMode(typedMode);
     std::vector<Handle_SelectMgr_EntityOwner> vecOwner;
-    for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx)
+    for (const Handle_AIS_InteractiveObject& obj : m_vecGpx)
         GpxDocumentItem::getEntityOwners(this->context(), obj, aisMode, &vecOwner);
 
     return vecOwner;
 }
 
+std::vector<Handle_AIS_InteractiveObject> GpxXdeDocumentItem::precomputableSelectionObjects() const
+{
+    std::vector<Handle_AIS_InteractiveObject> vecObject;
+    for (const Handle_AIS_InteractiveObject& obj : m_vecGpx) {
+        if (obj != m_gpxInstances)
+            vecObject.push_back(obj);
+    }
+
+    return vecObject;
+}
+
+int GpxXdeDocumentItem::aisSelectionMode(SelectionMode mode)
+{
+    switch (mode) {
+    case SelectVertex: return AIS_Shape::SelectionMode(TopAbs_VERTEX);
+    case SelectEdge: return AIS_Shape::SelectionMode(TopAbs_EDGE);
+    case SelectWire: return AIS_Shape::SelectionMode(TopAbs_WIRE);
+    case SelectFace: return AIS_Shape::SelectionMode(TopAbs_FACE);
+    case SelectShell: return AIS_Shape::SelectionMode(TopAbs_SHELL);
+    case SelectSolid: return AIS_Shape::SelectionMode(TopAbs_SOLID);
+    }
+
+    return AIS_Shape::SelectionMode(TopAbs_SHAPE);
+}
+
 Bnd_Box GpxXdeDocumentItem::boundingBox() const
 {
     Bnd_Box bndBox;
-    for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx)
+    for (const Handle_AIS_InteractiveObject& obj : m_vecGpx)
         bndBox.Add(GpxUtils::AisObject_boundingBox(obj));
 
     return bndBox;
 }
 
+void GpxXdeDocumentItem::enterReducedDetail(double projectedArea)
+{
+    if (!this->propertyIsVisible.value() || !m_gpxLod.IsNull())
+        return;
+
+    m_gpxLod = m_lod.levelPresentation(projectedArea);
+    if (!m_gpxLod.IsNull()) {
+        // Level of detail isn't selectable
+        this->context()->Display(m_gpxLod, m_gpxLod->DisplayMode(), -1, false);
+        for (const Handle_AIS_InteractiveObject& obj : m_vecGpx)
+            this->context()->Erase(obj, false);
+    }
+}
+
+void GpxXdeDocumentItem::restoreFullDetail()
+{
+    if (m_gpxLod.IsNull())
+        return;
+
+    for (const Handle_AIS_InteractiveObject& obj : m_vecGpx)
+        this->context()->Display(obj, false);
+
+    this->context()->Erase(m_gpxLod, false);
+    m_gpxLod.Nullify();
+}
+
 void GpxXdeDocumentItem::onPropertyChanged(Property* prop)
 {
+    this->restoreFullDetail();
+    this->updateLodAttributes();
+    const auto dispMode = static_cast<DisplayMode>(this->propertyDisplayMode.value());
     if (prop == &this->propertyMaterial) {
-        for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx)
+        for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx) {
             obj->SetMaterial(this->propertyMaterial.valueAs<Graphic3d_NameOfMaterial>());
+            GpxXdeDocumentItem::applyDisplayChange(
+                        this->context(), obj, ShapeDisplayChange::Attribute::Material, dispMode);
+        }
 
+        this->redisplayInstances();
         this->context()->UpdateCurrentViewer();
     }
     else if (prop == &this->propertyColor) {
-        auto dispMode = static_cast<DisplayMode>(this->propertyDisplayMode.value());
-        const bool showFaceBounds = dispMode == DisplayMode_ShadedWithFaceBoundary;
         for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx) {
             obj->SetColor(this->propertyColor.value());
-            if (showFaceBounds)
-                obj->Redisplay(true); // All modes
+            GpxXdeDocumentItem::applyDisplayChange(
+                        this->context(), obj, ShapeDisplayChange::Attribute::Color, dispMode);
         }
 
+        this->redisplayInstances();
         this->context()->UpdateCurrentViewer();
     }
     if (prop == &this->propertyTransparency) {
         const double factor = this->propertyTransparency.value() / 100.;
-        for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx)
+        for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx) {
             this->context()->SetTransparency(obj, factor, false);
+            GpxXdeDocumentItem::applyDisplayChange(
+                        this->context(), obj, ShapeDisplayChange::Attribute::Transparency, dispMode);
+        }
+
+        if (!m_gpxInstances.IsNull())
+            this->context()->SetTransparency(m_gpxInstances, factor, false);
 
         this->context()->UpdateCurrentViewer();
     }
     else if (prop == &this->propertyDisplayMode) {
-        auto dispMode = static_cast<DisplayMode>(this->propertyDisplayMode.value());
-        const AIS_DisplayMode aisDispMode =
-                dispMode == DisplayMode_Wireframe ? AIS_WireFrame : AIS_Shaded;
-        const bool showFaceBounds = dispMode == DisplayMode_ShadedWithFaceBoundary;
-        for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx) {
-            if (obj->DisplayMode() != aisDispMode)
-                this->context()->SetDisplayMode(obj, aisDispMode, false);
+        // Presentation of a display mode is kept once computed, switching
+        // back to it doesn't recompute anything
+        for (const Handle_XCAFPrs_AISObject& obj : m_vecXdeGpx)
+            GpxXdeDocumentItem::applyDisplayChange(
+                        this->context(), obj, ShapeDisplayChange::Attribute::DisplayMode, dispMode);
 
-            if (obj->Attributes()->FaceBoundaryDraw() != showFaceBounds) {
-                obj->Attributes()->SetFaceBoundaryDraw(showFaceBounds);
-                obj->Redisplay(true);
-            }
+        if (!m_gpxInstances.IsNull()) {
+            this->context()->SetDisplayMode(
+                        m_gpxInstances, Internal::aisDisplayMode(dispMode), false);
+            this->redisplayInstances();
         }
 
         this->context()->UpdateCurrentViewer();
@@ -184,6 +353,71 @@ void GpxXdeDocumentItem::onPropertyChanged(Property* prop)
     GpxDocumentItem::onPropertyChanged(prop);
 }
 
+void GpxXdeDocumentItem::applyDisplayChange(
+        const Handle_AIS_InteractiveContext& ctx,
+        const Handle_XCAFPrs_AISObject& obj,
+        ShapeDisplayChange::Attribute attribute,
+        DisplayMode dispMode)
+{
+    ShapeDisplayChange change;
+    change.attribute = attribute;
+#if OCC_VERSION_HEX >= 0x070400
+    change.hasFaceBoundaryDisplayMode = true;
+    change.isFaceBoundaryShownBefore =
+            obj->DisplayMode() == XdeShapePrs::DisplayMode_ShadedWithFaceBoundary;
+#else
+    change.hasFaceBoundaryDisplayMode = false;
+    change.isFaceBoundaryShownBefore = obj->Attributes()->FaceBoundaryDraw();
+#endif
+    change.isFaceBoundaryShownAfter = dispMode == DisplayMode_ShadedWithFaceBoundary;
+    change.displayModeBefore = obj->DisplayMode();
+    change.displayModeAfter = Internal::aisDisplayMode(dispMode);
+
+    switch (change.requiredUpdate()) {
+    case ShapeDisplayChange::Update::None:
+    case ShapeDisplayChange::Update::Aspects:
+        break;
+    case ShapeDisplayChange::Update::SwitchDisplayMode:
+        ctx->SetDisplayMode(obj, change.displayModeAfter, false);
+        break;
+    case ShapeDisplayChange::Update::Recompute:
+        if (!change.hasFaceBoundaryDisplayMode)
+            obj->Attributes()->SetFaceBoundaryDraw(change.isFaceBoundaryShownAfter);
+
+        if (change.displayModeBefore != change.displayModeAfter)
+            ctx->SetDisplayMode(obj, change.displayModeAfter, false);
+
+        obj->Redisplay(true); // All modes
+        break;
+    }
+}
+
+void GpxXdeDocumentItem::redisplayInstances()
+{
+#if OCC_VERSION_HEX < 0x070400
+    // Connected presentations have to be rebuilt to reflect changes in the prototypes
+    if (!m_gpxInstances.IsNull())
+        this->context()->Redisplay(m_gpxInstances, false, true);
+#else
+    // Aspects of the prototypes are updated in place, connected presentations
+    // show the changes as they are
+#endif
+}
+
+void GpxXdeDocumentItem::updateLodAttributes()
+{
+    // Colors of sub-shapes are not honored by levels of detail, only the main one
+    GpxMeshLod::Attributes attribs;
+    attribs.color = this->propertyColor.value();
+    attribs.material = this->propertyMaterial.valueAs<Graphic3d_NameOfMaterial>();
+    const auto dispMode = static_cast<DisplayMode>(this->propertyDisplayMode.value());
+    attribs.displayMode =
+            dispMode == DisplayMode_Wireframe ?
+                AIS_Mesh::DisplayMode_Wireframe :
+                AIS_Mesh::DisplayMode_Shaded;
+    m_lod.setAttributes(attribs);
+}
+
 const Enumeration& GpxXdeDocumentItem::enumDisplayMode()
 {
     static Enumeration enumeration;
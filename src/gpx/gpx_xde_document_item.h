@@ -7,13 +7,37 @@
 #pragma once
 
 #include "gpx_document_item.h"
+#include "gpx_mesh_lod.h"
+#include "../base/shape_display_change.h"
 #include "../base/xde_document_item.h"
+#include <AIS_MultipleConnectedInteractive.hxx>
+#include <Standard_Version.hxx>
 #include <XCAFPrs_AISObject.hxx>
 #include <QtGui/QColor>
 #include <unordered_set>
 
 namespace Mayo {
 
+#if OCC_VERSION_HEX >= 0x070400
+// Face boundaries are drawn in a display mode of their own, so showing or
+// hiding them just switches between presentations computed once
+// Color, material and transparency are synchronized in all display modes
+class XdeShapePrs : public XCAFPrs_AISObject {
+public:
+    static constexpr int DisplayMode_ShadedWithFaceBoundary = 3;
+
+    XdeShapePrs(const TDF_Label& label);
+
+    bool AcceptDisplayMode(const int mode) const override;
+
+protected:
+    void Compute(
+            const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+            const opencascade::handle<Prs3d_Presentation>& pres,
+            const int mode) override;
+};
+#endif
+
 class GpxXdeDocumentItem : public GpxDocumentItem {
     Q_DECLARE_TR_FUNCTIONS(Mayo::GpxXdeDocumentItem)
 public:
@@ -36,6 +60,16 @@ public:
     std::vector<Handle_SelectMgr_EntityOwner> entityOwners(int mode) const override;
     Bnd_Box boundingBox() const override;
 
+    // Objects whose sensitive entities can have their BVH trees built in a
+    // worker thread, once activateSelection() was called
+    // Assembly of instances is excluded as its entities are connected to the
+    // ones of the prototypes
+    std::vector<Handle_AIS_InteractiveObject> precomputableSelectionObjects() const;
+    static int aisSelectionMode(SelectionMode mode);
+
+    void enterReducedDetail(double projectedArea) override;
+    void restoreFullDetail() override;
+
     PropertyInt propertyTransparency;
     PropertyEnumeration propertyDisplayMode;
 
@@ -49,17 +83,39 @@ public:
     struct DefaultValues {
         Graphic3d_NameOfMaterial material = Graphic3d_NOM_PLASTIC;
         QColor color = Qt::gray;
+        // Parts referred many times are presented once and drawn at each of
+        // their locations
+        bool instancing = false;
     };
 
     static const DefaultValues& defaultValues();
     static void setDefaultValues(const DefaultValues& values);
 
+    // Shows in 'obj' the change of 'attribute', whose aspects were already
+    // updated, 'dispMode' being the display mode after the change
+    // Presentations are computed again only if ShapeDisplayChange requires it
+    static void applyDisplayChange(
+            const Handle_AIS_InteractiveContext& ctx,
+            const Handle_XCAFPrs_AISObject& obj,
+            ShapeDisplayChange::Attribute attribute,
+            DisplayMode dispMode);
+
 protected:
     void onPropertyChanged(Property* prop) override;
 
 private:
+    void redisplayInstances();
+    void updateLodAttributes();
+
     XdeDocumentItem* m_xdeDocItem = nullptr;
+    // Presentations of the free top-level shapes, or of the prototypes with instancing
     std::vector<Handle_XCAFPrs_AISObject> m_vecXdeGpx;
+    // Objects displayed in the AIS context
+    std::vector<Handle_AIS_InteractiveObject> m_vecGpx;
+    Handle_AIS_MultipleConnectedInteractive m_gpxInstances;
+    // Levels of detail of the free shapes merged into a single mesh
+    GpxMeshLod m_lod;
+    Handle_AIS_Mesh m_gpxLod;
     bool m_selectionActivated = false;
     std::unordered_set<SelectionMode> m_setActivatedSelectionMode;
 };
@@ -11,6 +11,8 @@
 
 namespace Mayo {
 
+// Driven by the animation timer of Qt, which also paces the camera changes
+// made by V3dViewController
 class V3dViewCameraAnimation : public QAbstractAnimation {
 public:
     V3dViewCameraAnimation(const Handle_V3d_View& view, QObject* parent = nullptr);
@@ -6,15 +6,40 @@
 
 #include "v3d_view_controller.h"
 
+#include <QtCore/QAbstractAnimation>
 #include <QtCore/QDebug>
 #include <QtCore/QRect>
 #include <V3d_View.hxx>
+#include <algorithm>
 
 namespace Mayo {
 
+// Ticks on the animation timer of Qt until stopped, so pending camera changes
+// and camera animations are rendered in the same frames
+// Clock is started by the first change queued and stopped on the first frame
+// without changes
+class V3dViewController::FrameClock : public QAbstractAnimation {
+public:
+    FrameClock(V3dViewController* controller)
+        : QAbstractAnimation(controller),
+          m_controller(controller)
+    {}
+
+    int duration() const override { return -1; }
+
+protected:
+    void updateCurrentTime(int) override {
+        m_controller->applyPendingCameraChanges();
+    }
+
+private:
+    V3dViewController* m_controller = nullptr;
+};
+
 V3dViewController::V3dViewController(const Handle_V3d_View& view, QObject* parent)
     : QObject(parent),
-      m_view(view)
+      m_view(view),
+      m_frameClock(new FrameClock(this))
 {
 }
 
@@ -25,16 +50,29 @@ V3dViewController::~V3dViewController()
 
 void V3dViewController::zoomIn()
 {
-    m_view->SetScale(m_view->Scale() * 1.1); // +10%
+    m_pendingChanges.scaleFactor *= 1.1; // +10%
+    this->onCameraChangeQueued();
     emit viewScaled();
 }
 
 void V3dViewController::zoomOut()
 {
-    m_view->SetScale(m_view->Scale() / 1.1); // -10%
+    m_pendingChanges.scaleFactor /= 1.1; // -10%
+    this->onCameraChangeQueued();
     emit viewScaled();
 }
 
+double V3dViewController::framePacingPeriod()
+{
+    // Interval of the animation timer of Qt(see QAnimationTimer)
+    return 16.;
+}
+
+const V3dViewController::FrameStats& V3dViewController::frameStats() const
+{
+    return m_frameStats;
+}
+
 void V3dViewController::startDynamicAction(DynamicAction dynAction)
 {
     if (dynAction == DynamicAction::None)
@@ -49,6 +87,10 @@ void V3dViewController::startDynamicAction(DynamicAction dynAction)
 
 void V3dViewController::stopDynamicAction()
 {
+    // Camera has to be final when the action ends
+    if (m_pendingEventCount > 0)
+        this->applyPendingCameraChanges();
+
     if (m_dynamicAction != DynamicAction::None) {
         emit dynamicActionEnded(m_dynamicAction);
         m_dynamicAction = DynamicAction::None;
@@ -96,6 +138,78 @@ void V3dViewController::windowFitAll(const QPoint& posMin, const QPoint& posMax)
         m_view->WindowFitAll(posMin.x(), posMin.y(), posMax.x(), posMax.y());
 }
 
+void V3dViewController::queueRotation(const QPoint& pos)
+{
+    // V3d_View::Rotation() is relative to the start point, only the last
+    // position matters
+    m_pendingChanges.hasRotation = true;
+    m_pendingChanges.rotationPos = pos;
+    this->onCameraChangeQueued();
+}
+
+void V3dViewController::queuePanning(int dx, int dy)
+{
+    m_pendingChanges.panDelta += QPoint(dx, dy);
+    this->onCameraChangeQueued();
+}
+
+void V3dViewController::applyPendingCameraChanges()
+{
+    if (m_pendingEventCount == 0) {
+        m_frameClock->stop();
+        m_frameIntervalTimer.invalidate();
+        return;
+    }
+
+    QElapsedTimer chronoUpdate;
+    chronoUpdate.start();
+    this->renderCameraChanges(m_pendingChanges);
+    // Interval between consecutive frames accounts for the GPU work as buffer
+    // swaps block once the GPU is behind, without stalling the pipeline
+    // First frame after an idle period has no previous frame to measure from
+    const double frameTime_ms =
+            m_frameIntervalTimer.isValid() ?
+                m_frameIntervalTimer.nsecsElapsed() / 1000000. :
+                chronoUpdate.nsecsElapsed() / 1000000.;
+    m_frameIntervalTimer.start();
+
+    const double latency_ms = m_pendingTimer.nsecsElapsed() / 1000000.;
+    ++m_frameStats.frameCount;
+    m_frameStats.coalescedEventCount += m_pendingEventCount - 1;
+    m_frameStats.lastInputLatency_ms = latency_ms;
+    m_frameStats.maxInputLatency_ms = std::max(m_frameStats.maxInputLatency_ms, latency_ms);
+
+    m_pendingChanges = CameraChanges();
+    m_pendingEventCount = 0;
+    emit frameRendered(frameTime_ms);
+}
+
+void V3dViewController::renderCameraChanges(const CameraChanges& changes)
+{
+    const bool wasImmediateUpdateOn = m_view->SetImmediateUpdate(false);
+    if (changes.hasRotation)
+        m_view->Rotation(changes.rotationPos.x(), changes.rotationPos.y());
+
+    if (!changes.panDelta.isNull())
+        m_view->Pan(changes.panDelta.x(), changes.panDelta.y());
+
+    if (changes.scaleFactor != 1.)
+        m_view->SetScale(m_view->Scale() * changes.scaleFactor);
+
+    m_view->SetImmediateUpdate(wasImmediateUpdateOn);
+    m_view->Update();
+}
+
+void V3dViewController::onCameraChangeQueued()
+{
+    if (m_pendingEventCount == 0)
+        m_pendingTimer.start();
+
+    ++m_pendingEventCount;
+    if (m_frameClock->state() != QAbstractAnimation::Running)
+        m_frameClock->start();
+}
+
 V3dViewController::DynamicAction V3dViewController::currentDynamicAction() const
 {
     return m_dynamicAction;
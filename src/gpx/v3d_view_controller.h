@@ -7,6 +7,7 @@
 #pragma once
 
 #include <V3d_View.hxx>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 #include <QtCore/QPoint>
 
@@ -38,10 +39,30 @@ public:
     void zoomIn();
     void zoomOut();
 
+    // Counters of the camera changes coming from input devices, which are
+    // accumulated and applied once per frame
+    struct FrameStats {
+        quint64 frameCount = 0;
+        // Input events merged into the frame of a later event
+        quint64 coalescedEventCount = 0;
+        // Time between the first input event of a frame and the end of its redraw
+        double lastInputLatency_ms = 0.;
+        double maxInputLatency_ms = 0.;
+    };
+    const FrameStats& frameStats() const;
+
+    // Period of the timer pacing frames, frame times can't be measured below it
+    static double framePacingPeriod();
+
 signals:
     void dynamicActionStarted(DynamicAction dynAction);
     void dynamicActionEnded(DynamicAction dynAction);
     void viewScaled();
+    // Emitted when queued camera changes were rendered, 'frameTime_ms' being
+    // the interval since the previous frame of the same interaction, so the GPU
+    // work throttling buffer swaps is accounted for
+    // First frame of an interaction reports the time of renderCameraChanges()
+    void frameRendered(double frameTime_ms);
 
     void mouseMoved(const QPoint& posMouseInView);
     void mouseClicked(Qt::MouseButton btn);
@@ -56,14 +77,42 @@ protected:
 
     void windowFitAll(const QPoint& posMin, const QPoint& posMax);
 
+    // Camera changes applied at next frame, frames being paced by Qt's
+    // animation timer which also drives V3dViewCameraAnimation
+    // Rotation has to be started with V3d_View::StartRotation()
+    void queueRotation(const QPoint& pos);
+    void queuePanning(int dx, int dy);
+    void applyPendingCameraChanges();
+
+    // Camera changes accumulated since the last frame
+    struct CameraChanges {
+        bool hasRotation = false;
+        QPoint rotationPos;
+        QPoint panDelta;
+        double scaleFactor = 1.;
+    };
+    // Applies 'changes' to the view and redraws it, called once per frame by
+    // applyPendingCameraChanges()
+    virtual void renderCameraChanges(const CameraChanges& changes);
+
     virtual AbstractRubberBand* createRubberBand() = 0;
     void drawRubberBand(const QPoint& posMin, const QPoint& posMax);
     void hideRubberBand();
 
 private:
+    class FrameClock;
+    void onCameraChangeQueued();
+
     Handle_V3d_View m_view;
     DynamicAction m_dynamicAction = DynamicAction::None;
     AbstractRubberBand* m_rubberBand = nullptr;
+
+    FrameClock* m_frameClock = nullptr;
+    CameraChanges m_pendingChanges;
+    int m_pendingEventCount = 0;
+    QElapsedTimer m_pendingTimer;
+    QElapsedTimer m_frameIntervalTimer;
+    FrameStats m_frameStats;
 };
 
 } // namespace Mayo
@@ -0,0 +1,78 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "v3d_view_quality_controller.h"
+
+namespace Mayo {
+
+V3dViewQualityController::V3dViewQualityController(const Handle_V3d_View& view, QObject* parent)
+    : QObject(parent),
+      m_view(view)
+{
+    const Graphic3d_RenderingParams& params = view->RenderingParams();
+    const int fullMsaaSampleCount =
+            params.IsAntialiasingEnabled ? params.NbMsaaSamples : 0;
+    m_vecQuality.push_back({ fullMsaaSampleCount, params.RenderResolutionScale });
+    if (fullMsaaSampleCount > 0)
+        m_vecQuality.push_back({ 0, params.RenderResolutionScale });
+
+    m_vecQuality.push_back({ 0, 0.75f * params.RenderResolutionScale });
+    m_vecQuality.push_back({ 0, 0.5f * params.RenderResolutionScale });
+    m_regulator.setLevelCount(int(m_vecQuality.size()));
+}
+
+double V3dViewQualityController::targetFrameTime() const
+{
+    return m_regulator.targetFrameTime();
+}
+
+void V3dViewQualityController::setTargetFrameTime(double ms)
+{
+    m_regulator.setTargetFrameTime(ms);
+}
+
+void V3dViewQualityController::setMinFrameTime(double ms)
+{
+    m_regulator.setMinFrameTime(ms);
+}
+
+void V3dViewQualityController::beginInteraction()
+{
+    this->applyLevel(m_regulator.begin());
+}
+
+void V3dViewQualityController::endInteraction()
+{
+    m_regulator.end();
+    this->applyLevel(0);
+}
+
+void V3dViewQualityController::addFrameTime(double ms)
+{
+    // New level is used starting with next frame
+    this->applyLevel(m_regulator.addFrameTime(ms));
+}
+
+const RenderQualityRegulator::Stats& V3dViewQualityController::stats() const
+{
+    return m_regulator.stats();
+}
+
+void V3dViewQualityController::applyLevel(int level)
+{
+    if (level == m_appliedLevel)
+        return;
+
+    // Changing these parameters reallocates the offscreen buffers of the view
+    const Quality& quality = m_vecQuality.at(level);
+    Graphic3d_RenderingParams& params = m_view->ChangeRenderingParams();
+    params.IsAntialiasingEnabled = quality.msaaSampleCount > 0;
+    params.NbMsaaSamples = quality.msaaSampleCount;
+    params.RenderResolutionScale = quality.renderScale;
+    m_appliedLevel = level;
+}
+
+} // namespace Mayo
@@ -0,0 +1,49 @@
+/****************************************************************************
+** Copyright (c) 2020, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/render_quality_regulator.h"
+#include <V3d_View.hxx>
+#include <QtCore/QObject>
+#include <vector>
+
+namespace Mayo {
+
+// Lowers MSAA and render resolution of a view while it's manipulated, so frames
+// keep close to a target time(see RenderQualityRegulator)
+// Rendering parameters of the view at construction define full quality, which
+// is restored when interaction ends
+class V3dViewQualityController : public QObject {
+public:
+    V3dViewQualityController(const Handle_V3d_View& view, QObject* parent = nullptr);
+
+    double targetFrameTime() const;
+    void setTargetFrameTime(double ms);
+    void setMinFrameTime(double ms);
+
+    void beginInteraction();
+    // Restores full quality, view has to be redrawn by the caller
+    void endInteraction();
+    void addFrameTime(double ms);
+
+    const RenderQualityRegulator::Stats& stats() const;
+
+private:
+    void applyLevel(int level);
+
+    struct Quality {
+        int msaaSampleCount;
+        float renderScale;
+    };
+
+    Handle_V3d_View m_view;
+    std::vector<Quality> m_vecQuality;
+    RenderQualityRegulator m_regulator;
+    int m_appliedLevel = 0;
+};
+
+} // namespace Mayo
@@ -11,7 +11,11 @@
 #include "../base/document.h"
 #include "gui_document.h"
 
-#include <unordered_set>
+#include <Aspect_DisplayConnection.hxx>
+#include <OpenGl_GraphicDriver.hxx>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
 
 namespace Mayo {
 
@@ -48,6 +52,9 @@ GuiApplication::~GuiApplication()
         delete pair.guiDoc;
         pair.guiDoc = nullptr;
     }
+
+    // Viewers of the documents are gone, driver can be released
+    m_gpxDriver.Nullify();
 }
 
 GuiDocument *GuiApplication::findGuiDocument(const Document *doc) const
@@ -73,6 +80,19 @@ ApplicationItemSelectionModel* GuiApplication::selectionModel() const
     return m_selectionModel;
 }
 
+const Handle_Graphic3d_GraphicDriver& GuiApplication::graphicDriver()
+{
+    if (m_gpxDriver.IsNull()) {
+        Handle_Aspect_DisplayConnection dispConnection;
+#if (!defined(Q_OS_WIN32) && (!defined(Q_OS_MAC) || defined(MACOSX_USE_GLX)))
+        dispConnection = new Aspect_DisplayConnection(std::getenv("DISPLAY"));
+#endif
+        m_gpxDriver = new OpenGl_GraphicDriver(dispConnection);
+    }
+
+    return m_gpxDriver;
+}
+
 void GuiApplication::onDocumentAdded(Document *doc)
 {
     const Doc_GuiDoc pair = { doc, new GuiDocument(doc) }; // TODO: set container widget
@@ -105,20 +125,22 @@ void GuiApplication::onApplicationItemSelectionCleared()
 void GuiApplication::onApplicationItemSelectionChanged(
         Span<ApplicationItem> selected, Span<ApplicationItem> deselected)
 {
-    std::unordered_set<GuiDocument*> setGuiDocDirty;
-    auto funcToggleItemSelected = [&](const ApplicationItem& item) {
+    // Items are toggled per document in one go, so selection can be batched
+    std::unordered_map<GuiDocument*, std::vector<ApplicationItem>> mapGuiDocItems;
+    auto funcAddItem = [&](const ApplicationItem& item) {
         GuiDocument* guiDoc = this->findGuiDocument(item.document());
-        if (guiDoc != nullptr) {
-            guiDoc->toggleItemSelected(item);
-            setGuiDocDirty.insert(guiDoc);
-        }
+        if (guiDoc != nullptr)
+            mapGuiDocItems[guiDoc].push_back(item);
     };
     for (const ApplicationItem& item : selected)
-        funcToggleItemSelected(item);
+        funcAddItem(item);
     for (const ApplicationItem& item : deselected)
-        funcToggleItemSelected(item);
-    for (GuiDocument* guiDoc : setGuiDocDirty)
+        funcAddItem(item);
+    for (const auto& mapPair : mapGuiDocItems) {
+        GuiDocument* guiDoc = mapPair.first;
+        guiDoc->toggleItemsSelected(mapPair.second);
         guiDoc->updateV3dViewer();
+    }
 }
 
 } // namespace Mayo
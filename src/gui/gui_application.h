@@ -7,6 +7,7 @@
 #pragma once
 
 #include "../base/application_item_selection_model.h"
+#include <Graphic3d_GraphicDriver.hxx>
 #include <QtCore/QObject>
 #include <vector>
 
@@ -27,6 +28,11 @@ public:
 
     ApplicationItemSelectionModel* selectionModel() const;
 
+    // Driver shared by all the documents, views created from it share their GL
+    // resources(shader programs, textures, fonts) which are then created once
+    // Driver is created on first call and released after all the documents
+    const Handle_Graphic3d_GraphicDriver& graphicDriver();
+
 signals:
     void guiDocumentAdded(GuiDocument* guiDoc);
     void guiDocumentErased(const GuiDocument* guiDoc);
@@ -49,6 +55,7 @@ private:
 
     std::vector<Doc_GuiDoc> m_vecDocGuiDoc;
     ApplicationItemSelectionModel* m_selectionModel = nullptr;
+    Handle_Graphic3d_GraphicDriver m_gpxDriver;
 };
 
 } // namespace Mayo
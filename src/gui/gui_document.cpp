@@ -8,7 +8,6 @@
 
 #include "../app/theme.h" // TODO Remove this dependency
 #include "../base/application_item.h"
-#include "../base/bnd_utils.h"
 #include "../base/brep_utils.h"
 #include "../base/document.h"
 #include "../base/document_item.h"
@@ -16,16 +15,22 @@
 #include "../gpx/gpx_document_item_factory.h"
 #include "../gpx/gpx_utils.h"
 #include "../gpx/gpx_xde_document_item.h"
+#include "gui_application.h"
 
 #include <fougtools/occtools/qt_utils.h>
+#include <fougtools/qttools/task/work_stealing_pool.h>
+#include <QtCore/QTimer>
 
 #include <AIS_Trihedron.hxx>
-#include <Aspect_DisplayConnection.hxx>
 #include <Geom_Axis2Placement.hxx>
 #include <Graphic3d_GraphicDriver.hxx>
-#include <OpenGl_GraphicDriver.hxx>
 #include <V3d_TypeOfOrientation.hxx>
+#include <Select3D_SensitiveEntity.hxx>
+#include <SelectMgr_Selection.hxx>
 #include <StdSelect_BRepOwner.hxx>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 namespace Mayo {
 
@@ -33,12 +38,7 @@ namespace Internal {
 
 static Handle_V3d_Viewer createOccViewer()
 {
-    Handle_Aspect_DisplayConnection dispConnection;
-#if (!defined(Q_OS_WIN32) && (!defined(Q_OS_MAC) || defined(MACOSX_USE_GLX)))
-    dispConnection = new Aspect_DisplayConnection(std::getenv("DISPLAY"));
-#endif
-    Handle_Graphic3d_GraphicDriver gpxDriver = new OpenGl_GraphicDriver(dispConnection);
-    Handle_V3d_Viewer viewer = new V3d_Viewer(gpxDriver);
+    Handle_V3d_Viewer viewer = new V3d_Viewer(GuiApplication::instance()->graphicDriver());
     viewer->SetDefaultViewSize(1000.);
     viewer->SetDefaultViewProj(V3d_XposYnegZpos);
     viewer->SetComputedMode(Standard_True);
@@ -81,7 +81,8 @@ GuiDocument::GuiDocument(Document* doc)
       m_v3dViewer(Internal::createOccViewer()),
       m_v3dView(m_v3dViewer->CreateView()),
       m_aisContext(new AIS_InteractiveContext(m_v3dViewer)),
-      m_aisOriginTrihedron(Internal::createOriginTrihedron())
+      m_aisOriginTrihedron(Internal::createOriginTrihedron()),
+      m_selectionJobs(std::make_shared<SelectionJobs>())
 {
     Q_ASSERT(doc != nullptr);
 
@@ -106,10 +107,26 @@ GuiDocument::GuiDocument(Document* doc)
     for (DocumentItem* docItem : doc->rootItems())
         this->mapGpxItem(docItem);
 
-    QObject::connect(doc, &Document::itemAdded, this, &GuiDocument::onItemAdded);
+    QObject::connect(doc, &Document::itemsAdded, this, &GuiDocument::onItemsAdded);
     QObject::connect(doc, &Document::itemErased, this, &GuiDocument::onItemErased);
 }
 
+// Worker jobs building BVH trees of sensitive entities, shared with the jobs so
+// they don't refer to the document
+struct GuiDocument::SelectionJobs {
+    std::mutex mutex;
+    std::condition_variable condition;
+    int pendingCount = 0;
+    std::atomic<bool> isCancelled = {};
+};
+
+GuiDocument::~GuiDocument()
+{
+    // Entities not processed yet are skipped, jobs then finish quickly
+    m_selectionJobs->isCancelled = true;
+    this->waitSelectionPrepared();
+}
+
 Document* GuiDocument::document() const
 {
     return m_document;
@@ -133,39 +150,21 @@ GpxDocumentItem* GuiDocument::findItemGpx(const DocumentItem* item) const
 
 const Bnd_Box& GuiDocument::gpxBoundingBox() const
 {
-    return m_gpxBoundingBox;
+    return m_gpxBndBoxTree.unitedBox();
 }
 
 void GuiDocument::toggleItemSelected(const ApplicationItem& appItem)
 {
-    if (appItem.document() != this->document())
-        return;
+    this->toggleItemsSelected(Span<const ApplicationItem>(&appItem, 1));
+}
 
-    if (appItem.isDocumentItemNode()) {
-        const GuiDocumentItem* guiItem = this->findGuiDocumentItem(appItem.documentItem());
-        if (guiItem && sameType<XdeDocumentItem>(appItem.documentItem())) {
-            auto xdeItem = static_cast<const XdeDocumentItem*>(appItem.documentItem());
-            const DocumentItemNode& docItemNode = appItem.documentItemNode();
-            const TopLoc_Location shapeLoc = xdeItem->shapeAbsoluteLocation(docItemNode.id);
-            const TDF_Label labelNode = XdeDocumentItem::label(docItemNode);
-            const TopoDS_Shape shape = XdeDocumentItem::shape(labelNode).Located(shapeLoc);
-            std::vector<TopoDS_Face> vecFace;
-            if (BRepUtils::moreComplex(shape.ShapeType(), TopAbs_FACE)) {
-                BRepUtils::forEachSubFace(shape, [&](const TopoDS_Face& face) {
-                    vecFace.push_back(face);
-                });
-            }
-            else if (shape.ShapeType() == TopAbs_FACE) {
-                vecFace.push_back(TopoDS::Face(shape));
-            }
+void GuiDocument::toggleItemsSelected(Span<const ApplicationItem> spanAppItem)
+{
+    ArrayGpxEntityOwner vecOwner;
+    for (const ApplicationItem& appItem : spanAppItem)
+        this->addItemEntityOwners(appItem, &vecOwner);
 
-            for (const TopoDS_Face& face : vecFace) {
-                auto brepOwner = guiItem->findBrepOwner(face);
-                if (!brepOwner.IsNull())
-                    m_aisContext->AddOrRemoveSelected(brepOwner, false);
-            }
-        }
-    }
+    this->toggleEntityOwnersSelected(vecOwner);
 }
 
 void GuiDocument::clearItemSelection()
@@ -173,6 +172,30 @@ void GuiDocument::clearItemSelection()
     m_aisContext->ClearSelected(false);
 }
 
+void GuiDocument::activateSelection(int mode)
+{
+    auto itMode = std::find(m_vecSelectionMode.cbegin(), m_vecSelectionMode.cend(), mode);
+    if (itMode != m_vecSelectionMode.cend())
+        return;
+
+    m_vecSelectionMode.push_back(mode);
+    std::vector<GpxDocumentItem*> vecGpxItem;
+    for (const GuiDocumentItem& guiItem : m_vecGuiDocumentItem) {
+        if (sameType<XdeDocumentItem>(guiItem.docItem))
+            vecGpxItem.push_back(guiItem.gpxDocItem.get());
+    }
+
+    if (!vecGpxItem.empty())
+        this->prepareSelection(vecGpxItem, mode);
+}
+
+void GuiDocument::waitSelectionPrepared() const
+{
+    SelectionJobs* jobs = m_selectionJobs.get();
+    std::unique_lock<std::mutex> lock(jobs->mutex);
+    jobs->condition.wait(lock, [=]{ return jobs->pendingCount == 0; });
+}
+
 bool GuiDocument::isOriginTrihedronVisible() const
 {
     return m_aisContext->IsDisplayed(m_aisOriginTrihedron);
@@ -191,6 +214,24 @@ void GuiDocument::updateV3dViewer()
     m_aisContext->UpdateCurrentViewer();
 }
 
+void GuiDocument::enterReducedDetail()
+{
+    for (const GuiDocumentItem& guiItem : m_vecGuiDocumentItem) {
+        const Bnd_Box box = guiItem.gpxDocItem->boundingBox();
+        guiItem.gpxDocItem->enterReducedDetail(GpxUtils::V3dView_projectedArea(m_v3dView, box));
+    }
+
+    this->updateV3dViewer();
+}
+
+void GuiDocument::restoreFullDetail()
+{
+    for (const GuiDocumentItem& guiItem : m_vecGuiDocumentItem)
+        guiItem.gpxDocItem->restoreFullDetail();
+
+    this->updateV3dViewer();
+}
+
 std::vector<Handle_SelectMgr_EntityOwner> GuiDocument::selectedEntityOwners() const
 {
     std::vector<Handle_SelectMgr_EntityOwner> vecOwner;
@@ -202,10 +243,13 @@ std::vector<Handle_SelectMgr_EntityOwner> GuiDocument::selectedEntityOwners() co
     return vecOwner;
 }
 
-void GuiDocument::onItemAdded(DocumentItem* item)
+void GuiDocument::onItemsAdded(Span<DocumentItem* const> spanItem)
 {
-    this->mapGpxItem(item);
-    emit gpxBoundingBoxChanged(m_gpxBoundingBox);
+    for (DocumentItem* item : spanItem)
+        this->mapGpxItem(item);
+
+    this->updateV3dViewer();
+    emit gpxBoundingBoxChanged(this->gpxBoundingBox());
 }
 
 void GuiDocument::onItemErased(const DocumentItem* item)
@@ -216,16 +260,10 @@ void GuiDocument::onItemErased(const DocumentItem* item)
                 [=](const GuiDocumentItem& guiItem) { return guiItem.docItem == item; });
     if (itFound != m_vecGuiDocumentItem.end()) {
         // Delete gpx item
+        m_gpxBndBoxTree.erase(itFound->bndBoxSlot);
         m_vecGuiDocumentItem.erase(itFound);
         this->updateV3dViewer();
-
-        // Recompute bounding box
-        m_gpxBoundingBox.SetVoid();
-        for (const GuiDocumentItem& guiItem : m_vecGuiDocumentItem) {
-            const Bnd_Box otherBox = guiItem.gpxDocItem->boundingBox();
-            BndUtils::add(&m_gpxBoundingBox, otherBox);
-        }
-        emit gpxBoundingBoxChanged(m_gpxBoundingBox);
+        emit gpxBoundingBoxChanged(this->gpxBoundingBox());
     }
 }
 
@@ -235,20 +273,84 @@ void GuiDocument::mapGpxItem(DocumentItem* item)
     GuiDocumentItem guiItem(item, gpxItem);
     gpxItem->setContext(m_aisContext);
     gpxItem->setVisible(true);
-    m_aisContext->UpdateCurrentViewer();
     if (sameType<XdeDocumentItem>(item)) {
-        gpxItem->activateSelection(GpxXdeDocumentItem::SelectVertex);
-        gpxItem->activateSelection(GpxXdeDocumentItem::SelectEdge);
-        gpxItem->activateSelection(GpxXdeDocumentItem::SelectWire);
-        gpxItem->activateSelection(GpxXdeDocumentItem::SelectFace);
-        gpxItem->activateSelection(GpxXdeDocumentItem::SelectShell);
-        gpxItem->activateSelection(GpxXdeDocumentItem::SelectSolid);
-        guiItem.vecGpxEntityOwner = gpxItem->entityOwners(GpxXdeDocumentItem::SelectFace);
+        for (int mode : m_vecSelectionMode)
+            this->prepareSelection(Span<GpxDocumentItem* const>(&gpxItem, 1), mode);
     }
 
-    GpxUtils::V3dView_fitAll(m_v3dView);
-    BndUtils::add(&m_gpxBoundingBox, gpxItem->boundingBox());
+    guiItem.bndBoxSlot = m_gpxBndBoxTree.insert(gpxItem->boundingBox());
     m_vecGuiDocumentItem.emplace_back(std::move(guiItem));
+    this->scheduleFitAll();
+}
+
+void GuiDocument::scheduleFitAll()
+{
+    // Items added within the same event loop iteration(eg batch import) lead
+    // to a single fit
+    if (m_isFitAllScheduled)
+        return;
+
+    m_isFitAllScheduled = true;
+    QTimer::singleShot(0, this, [=]{
+        m_isFitAllScheduled = false;
+        GpxUtils::V3dView_fitAll(m_v3dView);
+        this->updateV3dViewer();
+    });
+}
+
+void GuiDocument::prepareSelection(Span<GpxDocumentItem* const> spanGpxItem, int mode)
+{
+    // Selections are computed and registered by the AIS context in the GUI
+    // thread: computation might triangulate shapes and update drawers, which
+    // is not safe along with presentation computations
+    for (GpxDocumentItem* gpxItem : spanGpxItem)
+        gpxItem->activateSelection(mode);
+
+    // Only the BVH trees of sensitive entities are built in worker threads.
+    // Entities are not used until picking, which waits for the jobs to finish
+    using GpxXde = GpxXdeDocumentItem;
+    const int aisMode = GpxXde::aisSelectionMode(static_cast<GpxXde::SelectionMode>(mode));
+    auto ptrVecEntity = std::make_shared<std::vector<Handle_Select3D_SensitiveEntity>>();
+    for (GpxDocumentItem* gpxItem : spanGpxItem) {
+        for (const Handle_AIS_InteractiveObject& obj : static_cast<GpxXde*>(gpxItem)->precomputableSelectionObjects()) {
+            const Handle_SelectMgr_Selection& selection = obj->Selection(aisMode);
+            if (selection.IsNull())
+                continue;
+
+            using VectorSensitiveEntity = NCollection_Vector<Handle_SelectMgr_SensitiveEntity>;
+            for (VectorSensitiveEntity::Iterator it(selection->Entities()); it.More(); it.Next())
+                ptrVecEntity->push_back(it.Value()->BaseSensitive());
+        }
+    }
+
+    if (ptrVecEntity->empty())
+        return;
+
+    std::shared_ptr<SelectionJobs> jobs = m_selectionJobs;
+    {
+        std::lock_guard<std::mutex> lock(jobs->mutex);
+        ++jobs->pendingCount;
+    }
+
+    qttask::WorkStealingPool* pool = qttask::WorkStealingPool::globalInstance();
+    pool->submit([=]{
+        {
+            qttask::TaskGroup group(pool);
+            for (const Handle_Select3D_SensitiveEntity& entity : *ptrVecEntity) {
+                group.spawn([&]{
+                    if (!jobs->isCancelled)
+                        entity->BVH();
+                });
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(jobs->mutex);
+            --jobs->pendingCount;
+        }
+
+        jobs->condition.notify_all();
+    });
 }
 
 const GuiDocument::GuiDocumentItem*
@@ -261,20 +363,74 @@ GuiDocument::findGuiDocumentItem(const DocumentItem* item) const
     return nullptr;
 }
 
+GuiDocument::GuiDocumentItem* GuiDocument::findGuiDocumentItem(const DocumentItem* item)
+{
+    const auto constThis = static_cast<const GuiDocument*>(this);
+    return const_cast<GuiDocumentItem*>(constThis->findGuiDocumentItem(item));
+}
+
 GuiDocument::GuiDocumentItem::GuiDocumentItem(DocumentItem* item, GpxDocumentItem* gpx)
     : docItem(item), gpxDocItem(gpx)
 {
 }
 
+void GuiDocument::GuiDocumentItem::mapFaceOwners()
+{
+    if (this->isFaceOwnerMapped)
+        return;
+
+    // Face selection mode is activated now if not requested so far
+    this->gpxDocItem->activateSelection(GpxXdeDocumentItem::SelectFace);
+    const ArrayGpxEntityOwner vecFaceOwner =
+            this->gpxDocItem->entityOwners(GpxXdeDocumentItem::SelectFace);
+    this->mapFaceOwner.reserve(vecFaceOwner.size());
+    for (const Handle_SelectMgr_EntityOwner& owner : vecFaceOwner) {
+        auto brepOwner = Handle_StdSelect_BRepOwner::DownCast(owner);
+        if (!brepOwner.IsNull())
+            this->mapFaceOwner.emplace(brepOwner->Shape(), owner);
+    }
+
+    this->isFaceOwnerMapped = true;
+}
+
 Handle_SelectMgr_EntityOwner
 GuiDocument::GuiDocumentItem::findBrepOwner(const TopoDS_Face& face) const
 {
-    for (const Handle_SelectMgr_EntityOwner& owner : vecGpxEntityOwner) {
-        auto brepOwner = Handle_StdSelect_BRepOwner::DownCast(owner);
-        if (!brepOwner.IsNull() && brepOwner->Shape() == face)
-            return owner;
+    auto itFound = mapFaceOwner.find(face);
+    return itFound != mapFaceOwner.cend() ? itFound->second : Handle_SelectMgr_EntityOwner();
+}
+
+void GuiDocument::addItemEntityOwners(
+        const ApplicationItem& appItem, ArrayGpxEntityOwner* ptrVecOwner)
+{
+    if (appItem.document() != this->document() || !appItem.isDocumentItemNode())
+        return;
+
+    GuiDocumentItem* guiItem = this->findGuiDocumentItem(appItem.documentItem());
+    if (guiItem && sameType<XdeDocumentItem>(appItem.documentItem())) {
+        guiItem->mapFaceOwners();
+        auto xdeItem = static_cast<const XdeDocumentItem*>(appItem.documentItem());
+        const DocumentItemNode& docItemNode = appItem.documentItemNode();
+        const TopLoc_Location shapeLoc = xdeItem->shapeAbsoluteLocation(docItemNode.id);
+        const TDF_Label labelNode = XdeDocumentItem::label(docItemNode);
+        const TopoDS_Shape shape = XdeDocumentItem::shape(labelNode).Located(shapeLoc);
+        auto fnAddFaceOwner = [=](const TopoDS_Face& face) {
+            auto brepOwner = guiItem->findBrepOwner(face);
+            if (!brepOwner.IsNull())
+                ptrVecOwner->push_back(brepOwner);
+        };
+        if (BRepUtils::moreComplex(shape.ShapeType(), TopAbs_FACE))
+            BRepUtils::forEachSubFace(shape, fnAddFaceOwner);
+        else if (shape.ShapeType() == TopAbs_FACE)
+            fnAddFaceOwner(TopoDS::Face(shape));
     }
-    return Handle_SelectMgr_EntityOwner();
+}
+
+void GuiDocument::toggleEntityOwnersSelected(Span<const Handle_SelectMgr_EntityOwner> spanOwner)
+{
+    // Viewer isn't updated for each owner, but once by the caller(see updateV3dViewer())
+    for (const Handle_SelectMgr_EntityOwner& owner : spanOwner)
+        m_aisContext->AddOrRemoveSelected(owner, false);
 }
 
 } // namespace Mayo
@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include "../base/bnd_box_tree.h"
+#include "../base/brep_utils.h"
+#include "../base/span.h"
 #include "../gpx/gpx_document_item.h"
 
 #include <QtCore/QObject>
@@ -27,6 +30,7 @@ class GuiDocument : public QObject {
     Q_OBJECT
 public:
     GuiDocument(Document* doc);
+    ~GuiDocument();
 
     Document* document() const;
     const Handle_V3d_View& v3dView() const;
@@ -36,22 +40,41 @@ public:
     const Bnd_Box& gpxBoundingBox() const;
 
     std::vector<Handle_SelectMgr_EntityOwner> selectedEntityOwners() const;
+    // Viewer is not updated, updateV3dViewer() has to be called once done
     void toggleItemSelected(const ApplicationItem& appItem);
+    void toggleItemsSelected(Span<const ApplicationItem> spanAppItem);
     void clearItemSelection();
 
+    // Activates selection 'mode'(see GpxXdeDocumentItem::SelectionMode) for all
+    // the items, including those added later on
+    // Selection modes are not activated at load time but when first requested.
+    // Sensitive entities are computed in the GUI thread, their BVH trees are
+    // then built in worker threads
+    void activateSelection(int mode);
+    // Blocks until BVH trees being built are ready, to be called before picking
+    void waitSelectionPrepared() const;
+
     bool isOriginTrihedronVisible() const;
     void toggleOriginTrihedronVisibility();
 
     void updateV3dViewer();
 
+    // Switches items to levels of detail matching their size on screen, meant
+    // for the time the view is rotated or panned
+    void enterReducedDetail();
+    void restoreFullDetail();
+
 signals:
     void gpxBoundingBoxChanged(const Bnd_Box& bndBox);
 
 private:
-    void onItemAdded(DocumentItem* item);
+    void onItemsAdded(Span<DocumentItem* const> spanItem);
     void onItemErased(const DocumentItem* item);
 
     void mapGpxItem(DocumentItem* item);
+    void scheduleFitAll();
+
+    void prepareSelection(Span<GpxDocumentItem* const> spanGpxItem, int mode);
 
     using ArrayGpxEntityOwner = std::vector<Handle_SelectMgr_EntityOwner>;
     struct GuiDocumentItem {
@@ -59,10 +82,18 @@ private:
         GuiDocumentItem(DocumentItem* item, GpxDocumentItem* gpx);
         DocumentItem* docItem;
         std::unique_ptr<GpxDocumentItem> gpxDocItem;
-        ArrayGpxEntityOwner vecGpxEntityOwner;
+        BndBoxTree::SlotId bndBoxSlot = -1;
+        // Face selection owners indexed by their located face, built on first use
+        BRepUtils::ShapeHashMap<Handle_SelectMgr_EntityOwner> mapFaceOwner;
+        bool isFaceOwnerMapped = false;
+        void mapFaceOwners();
         Handle_SelectMgr_EntityOwner findBrepOwner(const TopoDS_Face& face) const;
     };
     const GuiDocumentItem* findGuiDocumentItem(const DocumentItem* item) const;
+    GuiDocumentItem* findGuiDocumentItem(const DocumentItem* item);
+
+    void addItemEntityOwners(const ApplicationItem& appItem, ArrayGpxEntityOwner* ptrVecOwner);
+    void toggleEntityOwnersSelected(Span<const Handle_SelectMgr_EntityOwner> spanOwner);
 
     Document* m_document = nullptr;
     Handle_V3d_Viewer m_v3dViewer;
@@ -70,7 +101,12 @@ private:
     Handle_AIS_InteractiveContext m_aisContext;
     Handle_AIS_InteractiveObject m_aisOriginTrihedron;
     std::vector<GuiDocumentItem> m_vecGuiDocumentItem;
-    Bnd_Box m_gpxBoundingBox;
+    // Bounding boxes of the items, their union is the document bounding box
+    BndBoxTree m_gpxBndBoxTree;
+    bool m_isFitAllScheduled = false;
+    std::vector<int> m_vecSelectionMode;
+    struct SelectionJobs;
+    std::shared_ptr<SelectionJobs> m_selectionJobs;
 };
 
 } // namespace Mayo
@@ -14,6 +14,7 @@ INCLUDEPATH += \
 HEADERS += \
     test.h \
     $$files(../src/base/*.h) \
+    $$files(../src/gpx/*.h) \
 
 SOURCES += \
     test.cpp \
@@ -21,9 +22,12 @@ SOURCES += \
     \
     ../src/3rdparty/fougtools/occtools/qt_utils.cpp \
     $$files(../src/base/*.cpp) \
+    $$files(../src/gpx/*.cpp) \
 
 include(../src/3rdparty/fougtools/qttools/task/qttools_task.pri)
 
+win*:LIBS += -lpsapi
+
 CONFIG += file_copies
 COPIES += MayoInputs
 MayoInputs.files = $$files(inputs/*.*)
@@ -32,7 +36,8 @@ MayoInputs.path = $$OUT_PWD/inputs
 # OpenCascade
 include(../opencascade.pri)
 
-LIBS += -lTKernel -lTKMath -lTKBRep -lTKGeomBase -lTKTopAlgo -lTKPrim -lTKMesh -lTKG3d
+LIBS += -lTKernel -lTKMath -lTKBRep -lTKGeomBase -lTKTopAlgo -lTKPrim -lTKMesh -lTKG2d -lTKG3d
 LIBS += -lTKXSBase -lTKIGES -lTKSTEP -lTKXDESTEP -lTKXDEIGES
 LIBS += -lTKLCAF -lTKXCAF -lTKCAF
 LIBS += -lTKSTL
+LIBS += -lTKV3d -lTKOpenGl -lTKService
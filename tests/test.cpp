@@ -6,26 +6,76 @@
 
 // Need to include this first because of MSVC conflicts with M_E, M_LOG2, ...
 #include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRepPrimAPI_MakeSphere.hxx>
 
 #include "test.h"
 #include "../src/base/application.h"
+#include "../src/base/bnd_box_tree.h"
 #include "../src/base/brep_utils.h"
+#include "../src/base/caf_utils.h"
+#include "../src/base/document.h"
+#include "../src/base/mesh_item.h"
+#include "../src/base/xde_document_item.h"
 #include "../src/base/libtree.h"
 #include "../src/base/geom_utils.h"
+#include "../src/base/mesh_lod.h"
 #include "../src/base/mesh_utils.h"
+#include "../src/base/os_utils.h"
+#include "../src/base/render_quality_regulator.h"
 #include "../src/base/result.h"
+#include "../src/base/shape_display_change.h"
+#include "../src/base/stl_reader.h"
+#include "../src/base/stl_writer.h"
 #include "../src/base/string_utils.h"
+#include "../src/base/tessellation_cache.h"
 #include "../src/base/unit.h"
 #include "../src/base/unit_system.h"
+#include "../src/gpx/gpx_xde_document_item.h"
+#include "../src/gpx/v3d_view_controller.h"
 
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_Shape.hxx>
+#include <Aspect_DisplayConnection.hxx>
+#include <BRep_Builder.hxx>
 #include <BRep_Tool.hxx>
 #include <BRepAdaptor_Curve.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTools.hxx>
 #include <GCPnts_TangentialDeflection.hxx>
+#include <OpenGl_GraphicDriver.hxx>
+#include <OSD_Path.hxx>
+#include <Precision.hxx>
+#include <RWStl.hxx>
+#include <Select3D_SensitiveEntity.hxx>
+#include <SelectMgr_Selection.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <V3d_Viewer.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#include <fougtools/qttools/task/manager.h>
+#include <fougtools/qttools/task/runner_scheduler.h>
+#include <fougtools/qttools/task/runner_work_stealing_pool.h>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThread>
 #include <QtCore/QtDebug>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <utility>
 #include <iostream>
 #include <sstream>
@@ -36,6 +86,10 @@ Q_DECLARE_METATYPE(Mayo::Application::PartFormat)
 // For MeshUtils_orientation_test()
 Q_DECLARE_METATYPE(std::vector<gp_Pnt2d>)
 Q_DECLARE_METATYPE(Mayo::MeshUtils::Orientation)
+// For StlReader_benchmark()
+Q_DECLARE_METATYPE(Mayo::Application::StlIoLibrary)
+// For StlWriter_test()
+Q_DECLARE_METATYPE(Mayo::StlWriter::Format)
 
 namespace Mayo {
 
@@ -70,6 +124,246 @@ void Test::Application_test_data()
     QTest::newRow("cube.stlb") << "inputs/cube.stlb" << Application::PartFormat::Stl;
 }
 
+void Test::Application_concurrentImport_test()
+{
+    QFETCH(QString, filePath);
+    QFETCH(Application::PartFormat, partFormat);
+    QFETCH(int, importCount);
+
+    struct ImportInfo {
+        int rootItemCount;
+        double volume;
+        double area;
+        int freeShapeCount;
+    };
+
+    auto fnImport = [=](Document* doc) {
+        const Application::IoResult res =
+                Application::instance()->importInDocument(doc, partFormat, filePath);
+        ImportInfo info = {};
+        if (!res.valid() || doc->rootItems().size() != 1)
+            return info;
+
+        auto xdeDocItem = dynamic_cast<const XdeDocumentItem*>(doc->rootItems().at(0));
+        info.rootItemCount = static_cast<int>(doc->rootItems().size());
+        info.volume = xdeDocItem->propertyVolume.quantity().value();
+        info.area = xdeDocItem->propertyArea.quantity().value();
+        info.freeShapeCount = xdeDocItem->topLevelFreeShapes().Size();
+        return info;
+    };
+
+    // Reference serial import
+    const std::unique_ptr<Document> docSerial(new Document(nullptr));
+    const ImportInfo infoSerial = fnImport(docSerial.get());
+    QCOMPARE(infoSerial.rootItemCount, 1);
+
+    // Concurrent imports, documents are created in the main thread
+    auto app = Application::instance();
+    const bool wasConcurrentImportEnabled = app->isConcurrentImportEnabled();
+    app->setConcurrentImportEnabled(true);
+    std::vector<std::unique_ptr<Document>> vecDoc;
+    std::vector<std::future<ImportInfo>> vecFuture;
+    for (int i = 0; i < importCount; ++i)
+        vecDoc.emplace_back(new Document(nullptr));
+
+    for (const std::unique_ptr<Document>& doc : vecDoc)
+        vecFuture.push_back(std::async(std::launch::async, fnImport, doc.get()));
+
+    std::vector<ImportInfo> vecInfo;
+    for (std::future<ImportInfo>& future : vecFuture)
+        vecInfo.push_back(future.get());
+
+    app->setConcurrentImportEnabled(wasConcurrentImportEnabled);
+    for (const ImportInfo& info : vecInfo) {
+        QCOMPARE(info.rootItemCount, infoSerial.rootItemCount);
+        QCOMPARE(info.freeShapeCount, infoSerial.freeShapeCount);
+        QCOMPARE(info.volume, infoSerial.volume);
+        QCOMPARE(info.area, infoSerial.area);
+    }
+}
+
+void Test::Application_concurrentImport_test_data()
+{
+    QTest::addColumn<QString>("filePath");
+    QTest::addColumn<Application::PartFormat>("partFormat");
+    QTest::addColumn<int>("importCount");
+
+    QTest::newRow("cube.step") << "inputs/cube.step" << Application::PartFormat::Step << 8;
+    QTest::newRow("cube.iges") << "inputs/cube.iges" << Application::PartFormat::Iges << 8;
+}
+
+void Test::Application_meshingAtImport_test()
+{
+    QFETCH(QString, filePath);
+    QFETCH(Application::PartFormat, partFormat);
+    QFETCH(bool, meshingEnabled);
+
+    auto app = Application::instance();
+    const Application::MeshingParameters defaultParams = app->meshingParameters();
+    Application::MeshingParameters params = defaultParams;
+    params.enabled = meshingEnabled;
+    app->setMeshingParameters(params);
+
+    const std::unique_ptr<Document> doc(new Document(nullptr));
+    Application::ImportInfo info;
+    const Application::IoResult res =
+            app->importInDocument(doc.get(), partFormat, filePath, nullptr, &info);
+    app->setMeshingParameters(defaultParams);
+    QVERIFY(res.valid());
+    QCOMPARE(static_cast<int>(doc->rootItems().size()), 1);
+
+    auto xdeDocItem = dynamic_cast<const XdeDocumentItem*>(doc->rootItems().at(0));
+    QVERIFY(xdeDocItem != nullptr);
+    const TDF_LabelSequence seqFreeShape = xdeDocItem->topLevelFreeShapes();
+    QVERIFY(seqFreeShape.Size() > 0);
+    for (int i = 1; i <= seqFreeShape.Size(); ++i) {
+        const TopoDS_Shape shape = XdeDocumentItem::shape(seqFreeShape.Value(i));
+        QCOMPARE(BRepTools::Triangulation(shape, Precision::Infinite()), meshingEnabled);
+    }
+
+    if (meshingEnabled)
+        QVERIFY(info.meshingTime >= 0);
+    else
+        QCOMPARE(info.meshingTime, qint64(-1));
+}
+
+void Test::Application_meshingAtImport_test_data()
+{
+    QTest::addColumn<QString>("filePath");
+    QTest::addColumn<Application::PartFormat>("partFormat");
+    QTest::addColumn<bool>("meshingEnabled");
+
+    QTest::newRow("cube.step") << "inputs/cube.step" << Application::PartFormat::Step << true;
+    QTest::newRow("cube.iges") << "inputs/cube.iges" << Application::PartFormat::Iges << true;
+    QTest::newRow("cube.step-no_meshing") << "inputs/cube.step" << Application::PartFormat::Step << false;
+}
+
+namespace Internal {
+
+static Bnd_Box createBndBox(const gp_Pnt& pntMin, double size)
+{
+    Bnd_Box box;
+    box.Add(pntMin);
+    box.Add(pntMin.Translated(gp_Vec(size, size, size)));
+    return box;
+}
+
+static bool isSameBndBox(const Bnd_Box& lhs, const Bnd_Box& rhs)
+{
+    if (lhs.IsVoid() || rhs.IsVoid())
+        return lhs.IsVoid() == rhs.IsVoid();
+
+    return lhs.CornerMin().IsEqual(rhs.CornerMin(), Precision::Confusion())
+            && lhs.CornerMax().IsEqual(rhs.CornerMax(), Precision::Confusion());
+}
+
+} // namespace Internal
+
+void Test::BndBoxTree_test()
+{
+    BndBoxTree tree;
+    QVERIFY(tree.empty());
+    QVERIFY(tree.unitedBox().IsVoid());
+
+    // Insert boxes along X axis, and check against union computed from scratch
+    std::vector<BndBoxTree::SlotId> vecSlot;
+    std::vector<Bnd_Box> vecBox;
+    for (int i = 0; i < 100; ++i) {
+        vecBox.push_back(Internal::createBndBox(gp_Pnt(i * 10, (i % 7) * 3, -(i % 5)), 5));
+        vecSlot.push_back(tree.insert(vecBox.back()));
+    }
+
+    QCOMPARE(tree.size(), 100);
+    auto fnUnitedBox = [&]{
+        Bnd_Box box;
+        for (size_t i = 0; i < vecSlot.size(); ++i) {
+            if (vecSlot.at(i) >= 0)
+                box.Add(vecBox.at(i));
+        }
+
+        return box;
+    };
+    QVERIFY(Internal::isSameBndBox(tree.unitedBox(), fnUnitedBox()));
+
+    // Erase the first and last boxes
+    for (size_t i : { size_t(0), vecSlot.size() - 1 }) {
+        tree.erase(vecSlot.at(i));
+        vecSlot.at(i) = -1;
+        QVERIFY(Internal::isSameBndBox(tree.unitedBox(), fnUnitedBox()));
+    }
+
+    QCOMPARE(tree.size(), 98);
+
+    // Update a box
+    vecBox.at(50) = Internal::createBndBox(gp_Pnt(-100, -100, -100), 1);
+    tree.update(vecSlot.at(50), vecBox.at(50));
+    QVERIFY(Internal::isSameBndBox(tree.box(vecSlot.at(50)), vecBox.at(50)));
+    QVERIFY(Internal::isSameBndBox(tree.unitedBox(), fnUnitedBox()));
+
+    // Erased slot is reused
+    const BndBoxTree::SlotId slot = tree.insert(Internal::createBndBox(gp_Pnt(0, 0, 0), 1));
+    QVERIFY(slot == 0 || slot == 99);
+    tree.erase(slot);
+
+    // Erase all
+    for (BndBoxTree::SlotId& slotId : vecSlot) {
+        tree.erase(slotId);
+        slotId = -1;
+    }
+
+    QVERIFY(tree.empty());
+    QVERIFY(tree.unitedBox().IsVoid());
+}
+
+void Test::BndBoxTree_benchmark()
+{
+    QFETCH(bool, useTree);
+
+    // Erase then re-insert each box of a document containing many items
+    const int boxCount = 1000;
+    std::vector<Bnd_Box> vecBox;
+    for (int i = 0; i < boxCount; ++i)
+        vecBox.push_back(Internal::createBndBox(gp_Pnt(i, 2 * i, 3 * i), 10));
+
+    BndBoxTree tree;
+    std::vector<BndBoxTree::SlotId> vecSlot;
+    for (const Bnd_Box& box : vecBox)
+        vecSlot.push_back(tree.insert(box));
+
+    std::vector<bool> vecErased(boxCount, false);
+    Bnd_Box unitedBox;
+    QBENCHMARK {
+        for (int i = 0; i < boxCount; ++i) {
+            if (useTree) {
+                tree.erase(vecSlot.at(i));
+                unitedBox = tree.unitedBox();
+                vecSlot.at(i) = tree.insert(vecBox.at(i));
+            }
+            else {
+                // Union recomputed from scratch, as before BndBoxTree
+                vecErased.at(i) = true;
+                unitedBox.SetVoid();
+                for (int j = 0; j < boxCount; ++j) {
+                    if (!vecErased.at(j))
+                        unitedBox.Add(vecBox.at(j));
+                }
+
+                vecErased.at(i) = false;
+            }
+        }
+    }
+
+    QVERIFY(!unitedBox.IsVoid());
+}
+
+void Test::BndBoxTree_benchmark_data()
+{
+    QTest::addColumn<bool>("useTree");
+
+    QTest::newRow("full_recompute") << false;
+    QTest::newRow("tree") << true;
+}
+
 void Test::BRepUtils_test()
 {
     QVERIFY(BRepUtils::moreComplex(TopAbs_COMPOUND, TopAbs_SOLID));
@@ -86,11 +380,318 @@ void Test::BRepUtils_test()
         QVERIFY(BRepUtils::hashCode(shapeBase) >= 0);
         QCOMPARE(BRepUtils::hashCode(shapeBase), BRepUtils::hashCode(shapeCopy));
     }
+
+    {
+        const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(25, 25, 25);
+        gp_Trsf trsf;
+        trsf.SetTranslation(gp_Vec(50, 0, 0));
+        const TopoDS_Shape shapeBoxMoved = shapeBox.Moved(TopLoc_Location(trsf));
+        BRepUtils::ShapeHashMap<int> mapFaceIndex;
+        BRepUtils::forEachSubFace(shapeBox, [&](const TopoDS_Face& face) {
+            mapFaceIndex.emplace(face, static_cast<int>(mapFaceIndex.size()));
+        });
+        QCOMPARE(mapFaceIndex.size(), size_t(6));
+        int faceIndex = 0;
+        BRepUtils::forEachSubFace(shapeBox, [&](const TopoDS_Face& face) {
+            // Orientation doesn't matter, location does
+            QCOMPARE(mapFaceIndex.at(face.Reversed()), faceIndex++);
+            QVERIFY(mapFaceIndex.find(face.Moved(TopLoc_Location(trsf))) == mapFaceIndex.cend());
+        });
+        BRepUtils::forEachSubFace(shapeBoxMoved, [&](const TopoDS_Face& face) {
+            QVERIFY(mapFaceIndex.find(face) == mapFaceIndex.cend());
+        });
+    }
+}
+
+namespace Internal {
+
+// Compound of 'boxCount' located instances of the same box, faces only differ
+// by their location
+static TopoDS_Shape createBoxInstances(int boxCount)
+{
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(1, 1, 1);
+    BRep_Builder builder;
+    TopoDS_Compound compound;
+    builder.MakeCompound(compound);
+    for (int i = 0; i < boxCount; ++i) {
+        gp_Trsf trsf;
+        trsf.SetTranslation(gp_Vec(2 * i, 0, 0));
+        builder.Add(compound, shapeBox.Moved(TopLoc_Location(trsf)));
+    }
+
+    return compound;
+}
+
+} // namespace Internal
+
+void Test::BRepUtils_faceIndex_benchmark()
+{
+    QFETCH(int, faceCount);
+    QFETCH(bool, useLinearScan);
+
+    // Selection of a model tree node maps each of its faces to the selection
+    // owner of the face
+    const TopoDS_Shape shape = Internal::createBoxInstances(faceCount / 6);
+    std::vector<TopoDS_Face> vecFace;
+    BRepUtils::forEachSubFace(shape, [&](const TopoDS_Face& face) { vecFace.push_back(face); });
+    BRepUtils::ShapeHashMap<int> mapFaceIndex;
+    for (const TopoDS_Face& face : vecFace)
+        mapFaceIndex.emplace(face, static_cast<int>(mapFaceIndex.size()));
+
+    int foundCount = 0;
+    QBENCHMARK {
+        foundCount = 0;
+        for (const TopoDS_Face& face : vecFace) {
+            if (useLinearScan) {
+                auto itFound = std::find_if(
+                            vecFace.cbegin(), vecFace.cend(), [&](const TopoDS_Face& other) {
+                    return other.IsSame(face);
+                });
+                foundCount += itFound != vecFace.cend() ? 1 : 0;
+            }
+            else {
+                foundCount += mapFaceIndex.find(face) != mapFaceIndex.cend() ? 1 : 0;
+            }
+        }
+    }
+
+    QCOMPARE(foundCount, faceCount);
+}
+
+void Test::BRepUtils_faceIndex_benchmark_data()
+{
+    QTest::addColumn<int>("faceCount");
+    QTest::addColumn<bool>("useLinearScan");
+
+    QTest::newRow("linear_scan_600") << 600 << true;
+    QTest::newRow("linear_scan_6000") << 6000 << true;
+    QTest::newRow("hashed_600") << 600 << false;
+    QTest::newRow("hashed_6000") << 6000 << false;
+    QTest::newRow("hashed_60000") << 60000 << false;
+}
+
+namespace Internal {
+
+// Driver isn't initialized(no GL context), viewers created from it have no
+// view : presentations are computed but never rendered
+static Handle_Graphic3d_GraphicDriver createHeadlessGraphicDriver()
+{
+    return new OpenGl_GraphicDriver(Handle_Aspect_DisplayConnection(), false);
+}
+
+static Handle_AIS_InteractiveContext createHeadlessAisContext()
+{
+    Handle_V3d_Viewer viewer = new V3d_Viewer(Internal::createHeadlessGraphicDriver());
+    return new AIS_InteractiveContext(viewer);
+}
+
+} // namespace Internal
+
+void Test::AisContext_selectionActivation_benchmark()
+{
+    QFETCH(int, faceCount);
+
+    // Same as GuiDocument::prepareSelection() : selection mode is activated in
+    // the calling thread, then BVH trees of sensitive entities are built in
+    // the global WorkStealingPool
+    Handle_AIS_InteractiveContext ctx = Internal::createHeadlessAisContext();
+    const TopoDS_Shape shape = Internal::createBoxInstances(faceCount / 6);
+    BRepMesh_IncrementalMesh mesher(shape, 0.1);
+    Handle_AIS_Shape aisShape = new AIS_Shape(shape);
+    ctx->Display(aisShape, AIS_Shaded, -1, false);
+    const int faceSelectionMode = AIS_Shape::SelectionMode(TopAbs_FACE);
+
+    const qint64 memUsageBefore = OsUtils::processMemoryUsage();
+    qint64 activationTime_ms = 0;
+    qint64 bvhTime_ms = 0;
+    QBENCHMARK_ONCE {
+        QElapsedTimer chrono;
+        chrono.start();
+        ctx->Activate(aisShape, faceSelectionMode);
+        activationTime_ms = chrono.elapsed();
+
+        std::vector<Handle_Select3D_SensitiveEntity> vecEntity;
+        const Handle_SelectMgr_Selection& selection = aisShape->Selection(faceSelectionMode);
+        using VectorSensitiveEntity = NCollection_Vector<Handle_SelectMgr_SensitiveEntity>;
+        for (VectorSensitiveEntity::Iterator it(selection->Entities()); it.More(); it.Next())
+            vecEntity.push_back(it.Value()->BaseSensitive());
+
+        qttask::WorkStealingPool* pool = qttask::WorkStealingPool::globalInstance();
+        qttask::TaskGroup group(pool);
+        for (const Handle_Select3D_SensitiveEntity& entity : vecEntity)
+            group.spawn([&]{ entity->BVH(); });
+
+        group.wait();
+        bvhTime_ms = chrono.elapsed() - activationTime_ms;
+    }
+
+    QCOMPARE(aisShape->Selection(faceSelectionMode)->Entities().Size(), faceCount);
+    const qint64 memUsageAfter = OsUtils::processMemoryUsage();
+    qInfo() << "Faces:" << faceCount
+            << "Activation(ms):" << activationTime_ms
+            << "BVH(ms):" << bvhTime_ms;
+    if (memUsageBefore > 0 && memUsageAfter > 0)
+        qInfo() << "Memory(KB):" << (memUsageAfter - memUsageBefore) / 1024;
+}
+
+void Test::AisContext_selectionActivation_benchmark_data()
+{
+    QTest::addColumn<int>("faceCount");
+
+    QTest::newRow("faces_600") << 600;
+    QTest::newRow("faces_6000") << 6000;
+    QTest::newRow("faces_60000") << 60000;
+}
+
+void Test::AisContext_toggleSelection_benchmark()
+{
+    QFETCH(int, faceCount);
+
+    // Only the selection and highlight presentations are measured, not rendering
+    Handle_AIS_InteractiveContext ctx = Internal::createHeadlessAisContext();
+    const TopoDS_Shape shape = Internal::createBoxInstances(faceCount / 6);
+    BRepMesh_IncrementalMesh mesher(shape, 0.1);
+    Handle_AIS_Shape aisShape = new AIS_Shape(shape);
+    ctx->Display(aisShape, AIS_Shaded, -1, false);
+    const int faceSelectionMode = AIS_Shape::SelectionMode(TopAbs_FACE);
+    ctx->Activate(aisShape, faceSelectionMode);
+    opencascade::handle<SelectMgr_IndexedMapOfOwner> mapOwner;
+    ctx->EntityOwners(mapOwner, aisShape, faceSelectionMode);
+    QCOMPARE(mapOwner->Extent(), faceCount);
+
+    // Same as GuiDocument::toggleItemsSelected() followed by GuiDocument::updateV3dViewer()
+    auto fnToggleSelected = [&]{
+        for (auto it = mapOwner->cbegin(); it != mapOwner->cend(); ++it)
+            ctx->AddOrRemoveSelected(*it, false);
+
+        ctx->UpdateCurrentViewer();
+    };
+    QBENCHMARK {
+        fnToggleSelected();
+        QCOMPARE(ctx->NbSelected(), faceCount);
+        fnToggleSelected();
+        QCOMPARE(ctx->NbSelected(), 0);
+    }
+}
+
+void Test::AisContext_toggleSelection_benchmark_data()
+{
+    QTest::addColumn<int>("faceCount");
+
+    QTest::newRow("faces_600") << 600;
+    QTest::newRow("faces_6000") << 6000;
+    QTest::newRow("faces_60000") << 60000;
+}
+
+namespace Internal {
+
+// Creates 'count' labels below the main label of a new XDE document
+static std::vector<TDF_Label> createLabels(const Handle_TDocStd_Document& doc, int count)
+{
+    std::vector<TDF_Label> vecLabel;
+    vecLabel.reserve(count);
+    const TDF_Label labelRoot = doc->Main().FindChild(100, true);
+    for (int i = 1; i <= count; ++i) {
+        // Two levels to get entries of different lengths
+        const TDF_Label label = labelRoot.FindChild(i, true);
+        vecLabel.push_back(label);
+        if (i % 10 == 0)
+            vecLabel.push_back(label.FindChild(i, true));
+    }
+
+    return vecLabel;
+}
+
+// Former std::hash<TDF_Label> specialization, formats the label entry
+struct LabelEntryHasher {
+    size_t operator()(const TDF_Label& label) const { return qHash(CafUtils::labelTag(label)); }
+};
+
+template<typename HASHER>
+static int labelHashMapLookupCount(const std::vector<TDF_Label>& vecLabel)
+{
+    std::unordered_map<TDF_Label, int, HASHER> mapLabelIndex;
+    for (const TDF_Label& label : vecLabel)
+        mapLabelIndex.emplace(label, static_cast<int>(mapLabelIndex.size()));
+
+    int count = 0;
+    for (const TDF_Label& label : vecLabel)
+        count += mapLabelIndex.find(label) != mapLabelIndex.cend() ? 1 : 0;
+
+    return count;
 }
 
+} // namespace Internal
+
 void Test::CafUtils_test()
 {
-    // TODO Add CafUtils::labelTag() test for multi-threaded safety
+    const Handle_TDocStd_Document doc = CafUtils::createXdeDocument();
+    const std::vector<TDF_Label> vecLabel = Internal::createLabels(doc, 1000);
+
+    // Identity and hash are consistent with TDF_Label equality
+    CafUtils::LabelHashSet setLabel;
+    for (const TDF_Label& label : vecLabel) {
+        const TDF_Label labelCopy = label.Father().FindChild(label.Tag(), false);
+        QCOMPARE(CafUtils::labelId(labelCopy), CafUtils::labelId(label));
+        QCOMPARE(CafUtils::labelHash(labelCopy), CafUtils::labelHash(label));
+        QCOMPARE(std::hash<TDF_Label>()(labelCopy), CafUtils::labelHash(label));
+        QVERIFY(setLabel.insert(label).second);
+        QVERIFY(!setLabel.insert(labelCopy).second);
+    }
+
+    QCOMPARE(setLabel.size(), vecLabel.size());
+    QCOMPARE(CafUtils::labelId(TDF_Label()), std::uintptr_t(0));
+
+    // CafUtils::labelTag() returns a view on a per-thread buffer, check it can
+    // be used concurrently
+    std::vector<QString> vecExpectedTag;
+    for (const TDF_Label& label : vecLabel)
+        vecExpectedTag.push_back(CafUtils::labelTag(label));
+
+    auto fnCheckTags = [&](int offset) {
+        int mismatchCount = 0;
+        for (int pass = 0; pass < 20; ++pass) {
+            for (size_t i = 0; i < vecLabel.size(); ++i) {
+                const size_t j = (i + offset) % vecLabel.size();
+                if (CafUtils::labelTag(vecLabel.at(j)) != vecExpectedTag.at(j))
+                    ++mismatchCount;
+            }
+        }
+
+        return mismatchCount;
+    };
+
+    std::vector<std::future<int>> vecFuture;
+    for (int i = 0; i < 8; ++i)
+        vecFuture.push_back(std::async(std::launch::async, fnCheckTags, i * 97));
+
+    for (std::future<int>& future : vecFuture)
+        QCOMPARE(future.get(), 0);
+}
+
+void Test::CafUtils_labelHash_benchmark()
+{
+    QFETCH(bool, useLabelEntry);
+
+    const Handle_TDocStd_Document doc = CafUtils::createXdeDocument();
+    const std::vector<TDF_Label> vecLabel = Internal::createLabels(doc, 50000);
+    int lookupCount = 0;
+    QBENCHMARK {
+        if (useLabelEntry)
+            lookupCount = Internal::labelHashMapLookupCount<Internal::LabelEntryHasher>(vecLabel);
+        else
+            lookupCount = Internal::labelHashMapLookupCount<CafUtils::LabelHasher>(vecLabel);
+    }
+
+    QCOMPARE(lookupCount, static_cast<int>(vecLabel.size()));
+}
+
+void Test::CafUtils_labelHash_benchmark_data()
+{
+    QTest::addColumn<bool>("useLabelEntry");
+
+    QTest::newRow("label_entry") << true;
+    QTest::newRow("label_node") << false;
 }
 
 void Test::MeshUtils_orientation_test()
@@ -170,25 +771,15 @@ void Test::MeshUtils_orientation_test_data()
     }
 }
 
-void Test::MeshUtils_test()
-{
-    // Create box
-    QFETCH(double, boxDx);
-    QFETCH(double, boxDy);
-    QFETCH(double, boxDz);
-    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(boxDx, boxDy, boxDz);
-
-    // Mesh box
-    {
-        BRepMesh_IncrementalMesh mesher(shapeBox, 0.1);
-        mesher.Perform();
-        QVERIFY(mesher.IsDone());
-    }
+namespace Internal {
 
+// Merges all face triangulations of 'shape' into one
+static Handle_Poly_Triangulation mergedTriangulation(const TopoDS_Shape& shape)
+{
     // Count nodes and triangles
     int countNode = 0;
     int countTriangle = 0;
-    BRepUtils::forEachSubFace(shapeBox, [&](const TopoDS_Face& face) {
+    BRepUtils::forEachSubFace(shape, [&](const TopoDS_Face& face) {
         TopLoc_Location loc;
         const Handle_Poly_Triangulation& polyTri = BRep_Tool::Triangulation(face, loc);
         if (!polyTri.IsNull()) {
@@ -198,22 +789,22 @@ void Test::MeshUtils_test()
     });
 
     // Merge all face triangulations into one
-    Handle_Poly_Triangulation polyTriBox =
+    Handle_Poly_Triangulation polyTriMerged =
             new Poly_Triangulation(countNode, countTriangle, false);
     {
         int idNodeOffset = 0;
         int idTriangleOffset = 0;
-        BRepUtils::forEachSubFace(shapeBox, [&](const TopoDS_Face& face) {
+        BRepUtils::forEachSubFace(shape, [&](const TopoDS_Face& face) {
             TopLoc_Location loc;
             const Handle_Poly_Triangulation& polyTri = BRep_Tool::Triangulation(face, loc);
             if (!polyTri.IsNull()) {
                 for (int i = 1; i <= polyTri->NbNodes(); ++i)
-                    polyTriBox->ChangeNode(idNodeOffset + i) = polyTri->Node(i);
+                    polyTriMerged->ChangeNode(idNodeOffset + i) = polyTri->Node(i);
 
                 for (int i = 1; i <= polyTri->NbTriangles(); ++i) {
                     int n1, n2, n3;
                     polyTri->Triangle(i).Get(n1, n2, n3);
-                    polyTriBox->ChangeTriangle(idTriangleOffset + i).Set(
+                    polyTriMerged->ChangeTriangle(idTriangleOffset + i).Set(
                                 idNodeOffset + n1, idNodeOffset + n2, idNodeOffset + n3);
                 }
 
@@ -223,74 +814,537 @@ void Test::MeshUtils_test()
         });
     }
 
-    // Checks
-    QCOMPARE(MeshUtils::triangulationVolume(polyTriBox),
-             double(boxDx * boxDy * boxDz));
-    QCOMPARE(MeshUtils::triangulationArea(polyTriBox),
-             double(2 * boxDx * boxDy + 2 * boxDy * boxDz + 2 * boxDx * boxDz));
+    return polyTriMerged;
 }
 
-void Test::MeshUtils_test_data()
+// Reference implementation of MeshUtils::triangulationVolumeArea(), scalar loop
+// over the triangles
+static MeshUtils::VolumeArea scalarTriangulationVolumeArea(
+        const Handle_Poly_Triangulation& triangulation)
 {
-    QTest::addColumn<double>("boxDx");
-    QTest::addColumn<double>("boxDy");
-    QTest::addColumn<double>("boxDz");
+    double volume = 0;
+    double area = 0;
+    const TColgp_Array1OfPnt& vecNode = triangulation->Nodes();
+    for (const Poly_Triangle& tri : triangulation->Triangles()) {
+        int v1, v2, v3;
+        tri.Get(v1, v2, v3);
+        const gp_XYZ& p1 = vecNode.Value(v1).Coord();
+        const gp_XYZ& p2 = vecNode.Value(v2).Coord();
+        const gp_XYZ& p3 = vecNode.Value(v3).Coord();
+        volume += MeshUtils::triangleSignedVolume(p1, p2, p3);
+        area += MeshUtils::triangleArea(p1, p2, p3);
+    }
 
-    QTest::newRow("case1") << 10. << 15. << 20.;
-    QTest::newRow("case2") << 0.1 << 0.25 << 0.044;
-    QTest::newRow("case3") << 1e5 << 1e6 << 1e7;
-    QTest::newRow("case4") << 40. << 50. << 70.;
+    return { std::abs(volume), area };
 }
 
-void Test::Quantity_test()
+} // namespace Internal
+
+void Test::Document_addRootItems_test()
 {
-    const QuantityArea area = (10 * Quantity_Millimeter) * (5 * Quantity_Centimeter);
-    QCOMPARE(area.value(), 500.);
-    QCOMPARE((Quantity_Millimeter / 5.).value(), 1/5.);
-}
+    // GuiDocument updates the 3D viewer once per itemsAdded() emission
+    const std::unique_ptr<Document> doc(new Document(nullptr));
+    int signalCount = 0;
+    int signalItemCount = 0;
+    QObject::connect(doc.get(), &Document::itemsAdded, [&](Span<DocumentItem* const> spanItem) {
+        ++signalCount;
+        signalItemCount += static_cast<int>(spanItem.size());
+    });
 
-namespace Result_test {
+    // Single item
+    doc->addRootItem(new MeshItem);
+    QCOMPARE(signalCount, 1);
+    QCOMPARE(signalItemCount, 1);
 
-struct Data {
-    static std::ostream* data_ostr;
+    // Batch
+    const std::vector<DocumentItem*> vecItem = { new MeshItem, new MeshItem, new MeshItem };
+    doc->addRootItems(vecItem);
+    QCOMPARE(signalCount, 2);
+    QCOMPARE(signalItemCount, 4);
+    QCOMPARE(static_cast<int>(doc->rootItems().size()), 4);
+    for (DocumentItem* item : vecItem)
+        QCOMPARE(item->document(), doc.get());
 
-    Data() {
-        *data_ostr << 0;
-    }
-    Data(const Data& other) : foo(other.foo) {
-        *data_ostr << 1;
-    }
-    Data(Data&& other) {
-        foo = std::move(other.foo);
-        *data_ostr << 2;
-    }
-    Data& operator=(const Data& other) {
-        this->foo = other.foo;
-        *data_ostr << 3;
-        return *this;
+    doc->addRootItems(std::vector<DocumentItem*>());
+    QCOMPARE(signalCount, 2);
+
+    // Import of a multi-solid STL file, solids are added at once
+    const QString filePath = QDir::temp().filePath("mayo_test_batch_multisolid.stla");
+    {
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        for (const char* solidName : { "first", "second", "third" }) {
+            file.write(QByteArray("solid ") + solidName + "\n"
+                       "facet normal 0 0 1\n"
+                       "outer loop\n"
+                       "vertex 0 0 0\n"
+                       "vertex 1 0 0\n"
+                       "vertex 0 1 0\n"
+                       "endloop\n"
+                       "endfacet\n"
+                       "endsolid " + solidName + "\n");
+        }
     }
-    Data& operator=(Data&& other) {
-        this->foo = std::move(other.foo);
-        *data_ostr << 4;
-        return *this;
+
+    Application* app = Application::instance();
+    const Application::StlIoLibrary stlIoLibrary = app->stlIoLibrary();
+    app->setStlIoLibrary(Application::StlIoLibrary::Mayo);
+    const std::unique_ptr<Document> docImport(new Document(nullptr));
+    int importSignalCount = 0;
+    QObject::connect(docImport.get(), &Document::itemsAdded, [&]{ ++importSignalCount; });
+    const Application::IoResult res =
+            app->importInDocument(docImport.get(), Application::PartFormat::Stl, filePath);
+    app->setStlIoLibrary(stlIoLibrary);
+    QFile::remove(filePath);
+    QVERIFY(res.valid());
+    QCOMPARE(static_cast<int>(docImport->rootItems().size()), 3);
+    QCOMPARE(importSignalCount, 1);
+}
+
+namespace Internal {
+
+#if OCC_VERSION_HEX >= 0x070400
+class ComputeCountXdeShapePrs : public XdeShapePrs {
+public:
+    ComputeCountXdeShapePrs(const TDF_Label& label)
+        : XdeShapePrs(label)
+    {}
+
+    int computeCount = 0;
+
+protected:
+    void Compute(
+            const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+            const opencascade::handle<Prs3d_Presentation>& pres,
+            const int mode) override
+    {
+        ++this->computeCount;
+        XdeShapePrs::Compute(pm, pres, mode);
     }
-    QString foo;
 };
-std::ostream* Data::data_ostr = nullptr;
+#endif
 
-} // Result_test
+} // namespace Internal
 
-void Test::Result_test()
+void Test::GpxXdeDocumentItem_displayChange_test()
 {
-    using Result = Result<Result_test::Data>;
-    {
-        std::ostringstream sstr;
-        Result::Data::data_ostr = &sstr;
-        const Result res = Result::error("error_description");
-        QVERIFY(res.errorText() == "error_description");
-        QVERIFY(!res.valid());
-        QCOMPARE(sstr.str().c_str(), "02");
-    }
+#if OCC_VERSION_HEX >= 0x070400
+    using Attribute = ShapeDisplayChange::Attribute;
+    Handle_TDocStd_Document doc = CafUtils::createXdeDocument();
+    Handle_XCAFDoc_ShapeTool shapeTool = XCAFDoc_DocumentTool::ShapeTool(doc->Main());
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 10, 10);
+    BRepMesh_IncrementalMesh mesher(shapeBox, 0.1);
+    const TDF_Label labelBox = shapeTool->AddShape(shapeBox, false);
+
+    Handle_AIS_InteractiveContext ctx = Internal::createHeadlessAisContext();
+    opencascade::handle<Internal::ComputeCountXdeShapePrs> gpx =
+            new Internal::ComputeCountXdeShapePrs(labelBox);
+    gpx->SetDisplayMode(XdeShapePrs::DisplayMode_ShadedWithFaceBoundary);
+    ctx->Display(gpx, false);
+    QCOMPARE(gpx->computeCount, 1);
+
+    // Pending recomputations are done by AIS_InteractiveContext::Update()
+    auto fnApplyChange = [&](Attribute attr, GpxXdeDocumentItem::DisplayMode dispMode) {
+        GpxXdeDocumentItem::applyDisplayChange(ctx, gpx, attr, dispMode);
+        ctx->Update(gpx, false);
+        ctx->UpdateCurrentViewer();
+    };
+
+    const auto dispModeFaceBounds = GpxXdeDocumentItem::DisplayMode_ShadedWithFaceBoundary;
+    gpx->SetColor(Quantity_NOC_RED);
+    fnApplyChange(Attribute::Color, dispModeFaceBounds);
+    QCOMPARE(gpx->computeCount, 1);
+    gpx->SetMaterial(Graphic3d_NOM_GOLD);
+    fnApplyChange(Attribute::Material, dispModeFaceBounds);
+    QCOMPARE(gpx->computeCount, 1);
+    ctx->SetTransparency(gpx, 0.5, false);
+    fnApplyChange(Attribute::Transparency, dispModeFaceBounds);
+    QCOMPARE(gpx->computeCount, 1);
+
+    // Each display mode is computed once, when first shown
+    fnApplyChange(Attribute::DisplayMode, GpxXdeDocumentItem::DisplayMode_Shaded);
+    QCOMPARE(gpx->computeCount, 2);
+    QCOMPARE(gpx->DisplayMode(), int(AIS_Shaded));
+    fnApplyChange(Attribute::DisplayMode, dispModeFaceBounds);
+    QCOMPARE(gpx->computeCount, 2);
+    fnApplyChange(Attribute::DisplayMode, GpxXdeDocumentItem::DisplayMode_Shaded);
+    QCOMPARE(gpx->computeCount, 2);
+
+    // Aspects changes apply to the presentations of all display modes
+    gpx->SetColor(Quantity_NOC_BLUE1);
+    fnApplyChange(Attribute::Color, GpxXdeDocumentItem::DisplayMode_Shaded);
+    fnApplyChange(Attribute::DisplayMode, dispModeFaceBounds);
+    QCOMPARE(gpx->computeCount, 2);
+#else
+    QSKIP("Face boundaries have no display mode of their own with OpenCascade < 7.4");
+#endif
+}
+
+void Test::MeshLod_test()
+{
+    const TopoDS_Shape shapeSphere = BRepPrimAPI_MakeSphere(100.);
+    {
+        BRepMesh_IncrementalMesh mesher(shapeSphere, 0.05);
+        mesher.Perform();
+        QVERIFY(mesher.IsDone());
+    }
+
+    const Handle_Poly_Triangulation polyTri = MeshLod::shapeTriangulation(shapeSphere);
+    QVERIFY(!polyTri.IsNull());
+    QCOMPARE(polyTri->NbTriangles(), Internal::mergedTriangulation(shapeSphere)->NbTriangles());
+    const double volume = MeshUtils::triangulationVolume(polyTri);
+
+    // Collected face triangulations are not affected by later meshing of the shape
+    {
+        const TopoDS_Shape shapeCylinder = BRepPrimAPI_MakeCylinder(10., 20.);
+        BRepMesh_IncrementalMesh mesherCoarse(shapeCylinder, 1.);
+        const std::vector<MeshLod::FaceTriangulation> vecFaceTri =
+                MeshLod::faceTriangulations(shapeCylinder);
+        QCOMPARE(static_cast<int>(vecFaceTri.size()), 3);
+        const int triangleCount = MeshLod::mergeTriangulations(vecFaceTri)->NbTriangles();
+        BRepMesh_IncrementalMesh mesherFine(shapeCylinder, 0.01, false, 0.05);
+        QVERIFY(MeshLod::shapeTriangulation(shapeCylinder)->NbTriangles() > triangleCount);
+        QCOMPARE(MeshLod::mergeTriangulations(vecFaceTri)->NbTriangles(), triangleCount);
+    }
+
+    auto fnCheckTriangulation = [](const Handle_Poly_Triangulation& mesh) {
+        for (int i = 1; i <= mesh->NbTriangles(); ++i) {
+            int n1, n2, n3;
+            mesh->Triangle(i).Get(n1, n2, n3);
+            for (int n : { n1, n2, n3 }) {
+                if (n < 1 || n > mesh->NbNodes())
+                    return false;
+            }
+
+            if (n1 == n2 || n2 == n3 || n1 == n3)
+                return false;
+        }
+
+        return true;
+    };
+
+    // Decimation
+    QVERIFY(MeshLod::decimate(polyTri, polyTri->NbTriangles()) == polyTri);
+    const int targetTriangleCount = polyTri->NbTriangles() / 4;
+    const Handle_Poly_Triangulation polyTriDecimated = MeshLod::decimate(polyTri, targetTriangleCount);
+    QVERIFY(polyTriDecimated->NbTriangles() <= targetTriangleCount);
+    QVERIFY(polyTriDecimated->NbTriangles() > 0);
+    QVERIFY(fnCheckTriangulation(polyTriDecimated));
+    const double volumeDecimated = MeshUtils::triangulationVolume(polyTriDecimated);
+    QVERIFY(std::abs(volumeDecimated - volume) <= 0.01 * std::abs(volume));
+
+    // Levels
+    const std::vector<Handle_Poly_Triangulation> vecLevel = MeshLod::buildLevels(polyTri, 3, 4);
+    QVERIFY(!vecLevel.empty());
+    QVERIFY(vecLevel.front() == polyTri);
+    QVERIFY(vecLevel.size() <= 4);
+    for (size_t i = 1; i < vecLevel.size(); ++i) {
+        QVERIFY(vecLevel.at(i)->NbTriangles() < vecLevel.at(i - 1)->NbTriangles());
+        QVERIFY(fnCheckTriangulation(vecLevel.at(i)));
+    }
+
+    QVERIFY(MeshLod::buildLevels(Handle_Poly_Triangulation(), 3, 4).empty());
+
+    // Level selection
+    const std::vector<int> vecLevelTriangleCount = { 1000, 250, 60 };
+    QCOMPARE(MeshLod::selectLevel(vecLevelTriangleCount, 1e6, 4.), 0);
+    QCOMPARE(MeshLod::selectLevel(vecLevelTriangleCount, 4000., 4.), 0);
+    QCOMPARE(MeshLod::selectLevel(vecLevelTriangleCount, 1000., 4.), 1);
+    QCOMPARE(MeshLod::selectLevel(vecLevelTriangleCount, 240., 4.), 2);
+    QCOMPARE(MeshLod::selectLevel(vecLevelTriangleCount, 0., 4.), 2);
+    QCOMPARE(MeshLod::selectLevel(std::vector<int>(), 1000., 4.), -1);
+}
+
+void Test::MeshUtils_test()
+{
+    // Create box
+    QFETCH(double, boxDx);
+    QFETCH(double, boxDy);
+    QFETCH(double, boxDz);
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(boxDx, boxDy, boxDz);
+
+    // Mesh box
+    {
+        BRepMesh_IncrementalMesh mesher(shapeBox, 0.1);
+        mesher.Perform();
+        QVERIFY(mesher.IsDone());
+    }
+
+    const Handle_Poly_Triangulation polyTriBox = Internal::mergedTriangulation(shapeBox);
+
+    // Checks
+    QCOMPARE(MeshUtils::triangulationVolume(polyTriBox),
+             double(boxDx * boxDy * boxDz));
+    QCOMPARE(MeshUtils::triangulationArea(polyTriBox),
+             double(2 * boxDx * boxDy + 2 * boxDy * boxDz + 2 * boxDx * boxDz));
+}
+
+void Test::MeshUtils_volumeArea_benchmark()
+{
+    QFETCH(bool, useScalarLoop);
+
+    const TopoDS_Shape shapeSphere = BRepPrimAPI_MakeSphere(100.);
+    {
+        BRepMesh_IncrementalMesh mesher(shapeSphere, 0.001);
+        mesher.Perform();
+        QVERIFY(mesher.IsDone());
+    }
+
+    const Handle_Poly_Triangulation polyTri = Internal::mergedTriangulation(shapeSphere);
+    const MeshUtils::VolumeArea expected = Internal::scalarTriangulationVolumeArea(polyTri);
+    MeshUtils::VolumeArea actual = {};
+    QBENCHMARK {
+        if (useScalarLoop)
+            actual = Internal::scalarTriangulationVolumeArea(polyTri);
+        else
+            actual = MeshUtils::triangulationVolumeArea(polyTri);
+    }
+
+    QVERIFY(std::abs(actual.volume - expected.volume) <= 1e-9 * expected.volume);
+    QVERIFY(std::abs(actual.area - expected.area) <= 1e-9 * expected.area);
+    if (!useScalarLoop) {
+        // Result must be exactly the same from one call to another
+        const MeshUtils::VolumeArea actualAgain = MeshUtils::triangulationVolumeArea(polyTri);
+        QCOMPARE(actualAgain.volume, actual.volume);
+        QCOMPARE(actualAgain.area, actual.area);
+    }
+}
+
+void Test::MeshUtils_volumeArea_benchmark_data()
+{
+    QTest::addColumn<bool>("useScalarLoop");
+
+    QTest::newRow("scalar_loop") << true;
+    QTest::newRow("kernel") << false;
+}
+
+void Test::MeshUtils_test_data()
+{
+    QTest::addColumn<double>("boxDx");
+    QTest::addColumn<double>("boxDy");
+    QTest::addColumn<double>("boxDz");
+
+    QTest::newRow("case1") << 10. << 15. << 20.;
+    QTest::newRow("case2") << 0.1 << 0.25 << 0.044;
+    QTest::newRow("case3") << 1e5 << 1e6 << 1e7;
+    QTest::newRow("case4") << 40. << 50. << 70.;
+}
+
+void Test::MeshUtils_positionNormalBuffer_test()
+{
+    auto fnNodeData = [](const std::vector<float>& buffer, int i) {
+        const float* ptr = buffer.data() + 6 * i;
+        return std::make_pair(gp_XYZ(ptr[0], ptr[1], ptr[2]), gp_XYZ(ptr[3], ptr[4], ptr[5]));
+    };
+
+    // Nodes of a box are not shared by faces, their normals are the face normals
+    {
+        const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30);
+        BRepMesh_IncrementalMesh mesher(shapeBox, 0.1);
+        mesher.Perform();
+        QVERIFY(mesher.IsDone());
+        const Handle_Poly_Triangulation polyTri = Internal::mergedTriangulation(shapeBox);
+        std::vector<float> buffer(6 * polyTri->NbNodes());
+        MeshUtils::fillPositionNormalBuffer(polyTri, buffer.data());
+        for (int i = 0; i < polyTri->NbNodes(); ++i) {
+            const auto nodeData = fnNodeData(buffer, i);
+            QVERIFY(nodeData.first.IsEqual(polyTri->Node(i + 1).XYZ(), 1e-5));
+            const gp_XYZ& n = nodeData.second;
+            QVERIFY(std::abs(n.Modulus() - 1.) < 1e-5);
+            const double maxComponent = std::max({ std::abs(n.X()), std::abs(n.Y()), std::abs(n.Z()) });
+            QVERIFY(std::abs(maxComponent - 1.) < 1e-5);
+        }
+    }
+
+    // Normals of sphere nodes are radial
+    {
+        const TopoDS_Shape shapeSphere = BRepPrimAPI_MakeSphere(100.);
+        BRepMesh_IncrementalMesh mesher(shapeSphere, 0.05);
+        mesher.Perform();
+        QVERIFY(mesher.IsDone());
+        const Handle_Poly_Triangulation polyTri = Internal::mergedTriangulation(shapeSphere);
+        std::vector<float> buffer(6 * polyTri->NbNodes());
+        MeshUtils::fillPositionNormalBuffer(polyTri, buffer.data());
+        for (int i = 0; i < polyTri->NbNodes(); ++i) {
+            const auto nodeData = fnNodeData(buffer, i);
+            const gp_XYZ dirRadial = nodeData.first.Normalized();
+            QVERIFY(std::abs(nodeData.second.Dot(dirRadial)) > 0.99);
+        }
+    }
+}
+
+void Test::MeshUtils_positionNormalBuffer_benchmark()
+{
+    // Vertex buffer of the mesh presentation(see AIS_Mesh)
+    const TopoDS_Shape shapeSphere = BRepPrimAPI_MakeSphere(100.);
+    {
+        BRepMesh_IncrementalMesh mesher(shapeSphere, 0.001);
+        mesher.Perform();
+        QVERIFY(mesher.IsDone());
+    }
+
+    const Handle_Poly_Triangulation polyTri = Internal::mergedTriangulation(shapeSphere);
+    const qint64 peakMemUsageBefore = OsUtils::processPeakMemoryUsage();
+    std::vector<float> buffer(6 * polyTri->NbNodes());
+    QBENCHMARK {
+        MeshUtils::fillPositionNormalBuffer(polyTri, buffer.data());
+    }
+
+    const qint64 peakMemUsageAfter = OsUtils::processPeakMemoryUsage();
+    if (peakMemUsageBefore > 0 && peakMemUsageAfter > 0) {
+        qInfo() << "Triangles:" << polyTri->NbTriangles()
+                << "Buffer(KB):" << (buffer.size() * sizeof(float)) / 1024
+                << "Peak memory increase(KB):" << (peakMemUsageAfter - peakMemUsageBefore) / 1024;
+    }
+}
+
+void Test::OsUtils_test()
+{
+#if defined(Q_OS_WIN) || defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+    const qint64 memUsage = OsUtils::processMemoryUsage();
+    QVERIFY(memUsage > 0);
+    QVERIFY(OsUtils::processPeakMemoryUsage() >= memUsage);
+    QVERIFY(OsUtils::physicalMemorySize() >= memUsage);
+#else
+    QSKIP("Process memory usage not supported on this platform");
+#endif
+}
+
+void Test::Quantity_test()
+{
+    const QuantityArea area = (10 * Quantity_Millimeter) * (5 * Quantity_Centimeter);
+    QCOMPARE(area.value(), 500.);
+    QCOMPARE((Quantity_Millimeter / 5.).value(), 1/5.);
+}
+
+void Test::RenderQualityRegulator_test()
+{
+    RenderQualityRegulator regulator(4);
+    regulator.setTargetFrameTime(20.);
+    QCOMPARE(regulator.currentLevel(), 0);
+
+    // Frames over target lower quality down to the coarsest level
+    QCOMPARE(regulator.begin(), 1);
+    for (int i = 0; i < 20; ++i)
+        regulator.addFrameTime(100.);
+
+    QCOMPARE(regulator.currentLevel(), 3);
+    QCOMPARE(regulator.stats().frameCount, 20);
+    QCOMPARE(regulator.stats().averageFrameTime_ms, 100.);
+    QCOMPARE(regulator.stats().levelChangeCount, 2);
+
+    // Fast frames raise quality to a middle level
+    regulator.end();
+    QCOMPARE(regulator.currentLevel(), 0);
+    QCOMPARE(regulator.begin(), 3);
+    for (int i = 0; i < 6; ++i)
+        regulator.addFrameTime(5.);
+
+    QCOMPARE(regulator.currentLevel(), 1);
+
+    // Isolated slow frames don't lower quality, even when they push the
+    // average over target
+    for (int i = 0; i < 3; ++i)
+        regulator.addFrameTime(15.);
+
+    for (int i = 0; i < 3; ++i) {
+        regulator.addFrameTime(60.);
+        QCOMPARE(regulator.currentLevel(), 1);
+        regulator.addFrameTime(15.);
+        QCOMPARE(regulator.currentLevel(), 1);
+    }
+
+    QCOMPARE(regulator.stats().maxFrameTime_ms, 60.);
+
+    // Consecutive slow frames do
+    regulator.addFrameTime(60.);
+    regulator.addFrameTime(60.);
+    QCOMPARE(regulator.currentLevel(), 1);
+    regulator.addFrameTime(60.);
+    QCOMPARE(regulator.currentLevel(), 2);
+
+    // Fast frames raise quality up to full quality
+    for (int i = 0; i < 20; ++i)
+        regulator.addFrameTime(5.);
+
+    QCOMPARE(regulator.currentLevel(), 0);
+    regulator.end();
+
+    // Interaction starts with reduced quality at least
+    QCOMPARE(regulator.begin(), 1);
+    regulator.end();
+
+    // Frame times are ignored out of interaction
+    QCOMPARE(regulator.addFrameTime(100.), 0);
+    QCOMPARE(regulator.stats().frameCount, 0);
+
+    // Single level can't be reduced
+    RenderQualityRegulator regulatorSingleLevel;
+    QCOMPARE(regulatorSingleLevel.begin(), 0);
+    QCOMPARE(regulatorSingleLevel.addFrameTime(100.), 0);
+
+    // Frames paced by a timer can't be measured below its period: frames close
+    // to it raise quality, and target time is kept above it
+    RenderQualityRegulator regulatorPaced(4);
+    regulatorPaced.setTargetFrameTime(10.);
+    regulatorPaced.setMinFrameTime(16.);
+    QCOMPARE(regulatorPaced.begin(), 1);
+    for (int i = 0; i < 6; ++i)
+        regulatorPaced.addFrameTime(18.);
+
+    QCOMPARE(regulatorPaced.currentLevel(), 0);
+    regulatorPaced.end();
+
+    regulatorPaced.setTargetFrameTime(33.);
+    QCOMPARE(regulatorPaced.begin(), 1);
+    for (int i = 0; i < 6; ++i)
+        regulatorPaced.addFrameTime(25.);
+
+    QCOMPARE(regulatorPaced.currentLevel(), 1);
+}
+
+namespace Result_test {
+
+struct Data {
+    static std::ostream* data_ostr;
+
+    Data() {
+        *data_ostr << 0;
+    }
+    Data(const Data& other) : foo(other.foo) {
+        *data_ostr << 1;
+    }
+    Data(Data&& other) {
+        foo = std::move(other.foo);
+        *data_ostr << 2;
+    }
+    Data& operator=(const Data& other) {
+        this->foo = other.foo;
+        *data_ostr << 3;
+        return *this;
+    }
+    Data& operator=(Data&& other) {
+        this->foo = std::move(other.foo);
+        *data_ostr << 4;
+        return *this;
+    }
+    QString foo;
+};
+std::ostream* Data::data_ostr = nullptr;
+
+} // Result_test
+
+void Test::Result_test()
+{
+    using Result = Result<Result_test::Data>;
+    {
+        std::ostringstream sstr;
+        Result::Data::data_ostr = &sstr;
+        const Result res = Result::error("error_description");
+        QVERIFY(res.errorText() == "error_description");
+        QVERIFY(!res.valid());
+        QCOMPARE(sstr.str().c_str(), "02");
+    }
     {
         std::ostringstream sstr;
         Result::Data::data_ostr = &sstr;
@@ -303,6 +1357,380 @@ void Test::Result_test()
     }
 }
 
+void Test::ShapeDisplayChange_test()
+{
+    using Attribute = ShapeDisplayChange::Attribute;
+    using Update = ShapeDisplayChange::Update;
+    const int dispModeWireframe = 0;
+    const int dispModeShaded = 1;
+    const int dispModeShadedWithFaceBoundary = 3;
+
+    // Face boundaries drawn in a display mode of their own
+    {
+        ShapeDisplayChange change;
+        change.hasFaceBoundaryDisplayMode = true;
+        change.isFaceBoundaryShownBefore = true;
+        change.isFaceBoundaryShownAfter = true;
+        change.displayModeBefore = dispModeShadedWithFaceBoundary;
+        change.displayModeAfter = dispModeShadedWithFaceBoundary;
+        for (Attribute attr : { Attribute::Color, Attribute::Material, Attribute::Transparency }) {
+            change.attribute = attr;
+            QCOMPARE(change.requiredUpdate(), Update::Aspects);
+        }
+
+        change.attribute = Attribute::DisplayMode;
+        QCOMPARE(change.requiredUpdate(), Update::None);
+        change.isFaceBoundaryShownAfter = false;
+        change.displayModeAfter = dispModeShaded;
+        QCOMPARE(change.requiredUpdate(), Update::SwitchDisplayMode);
+        change.displayModeAfter = dispModeWireframe;
+        QCOMPARE(change.requiredUpdate(), Update::SwitchDisplayMode);
+    }
+
+    // Face boundaries part of the shaded presentation
+    {
+        ShapeDisplayChange change;
+        change.hasFaceBoundaryDisplayMode = false;
+        change.isFaceBoundaryShownBefore = true;
+        change.isFaceBoundaryShownAfter = true;
+        change.displayModeBefore = dispModeShaded;
+        change.displayModeAfter = dispModeShaded;
+        change.attribute = Attribute::Color;
+        QCOMPARE(change.requiredUpdate(), Update::Recompute);
+        change.attribute = Attribute::Material;
+        QCOMPARE(change.requiredUpdate(), Update::Aspects);
+        change.attribute = Attribute::Transparency;
+        QCOMPARE(change.requiredUpdate(), Update::Aspects);
+
+        change.attribute = Attribute::DisplayMode;
+        change.isFaceBoundaryShownAfter = false;
+        QCOMPARE(change.requiredUpdate(), Update::Recompute);
+
+        change.isFaceBoundaryShownBefore = false;
+        change.attribute = Attribute::Color;
+        QCOMPARE(change.requiredUpdate(), Update::Aspects);
+        change.attribute = Attribute::DisplayMode;
+        change.displayModeAfter = dispModeWireframe;
+        QCOMPARE(change.requiredUpdate(), Update::SwitchDisplayMode);
+    }
+}
+
+namespace Internal {
+
+// Writes a binary STL file of a planar grid made of 'gridSize'x'gridSize' quads
+static bool writeBinaryStlGrid(const QString& filepath, int gridSize)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    const QByteArray header(80, ' ');
+    stream.writeRawData(header.constData(), header.size());
+    stream << quint32(2 * gridSize * gridSize);
+    auto fnWriteFacet = [&](int x1, int y1, int x2, int y2, int x3, int y3) {
+        stream << 0.f << 0.f << 1.f;
+        stream << float(x1) << float(y1) << 0.f;
+        stream << float(x2) << float(y2) << 0.f;
+        stream << float(x3) << float(y3) << 0.f;
+        stream << quint16(0);
+    };
+    for (int i = 0; i < gridSize; ++i) {
+        for (int j = 0; j < gridSize; ++j) {
+            fnWriteFacet(i, j, i + 1, j, i + 1, j + 1);
+            fnWriteFacet(i, j, i + 1, j + 1, i, j + 1);
+        }
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+} // namespace Internal
+
+void Test::StlReader_test()
+{
+    QFETCH(QString, filePath);
+
+    const Handle_Poly_Triangulation meshOcc = RWStl::ReadFile(
+                OSD_Path(filePath.toLocal8Bit().constData()), Handle_Message_ProgressIndicator());
+    QVERIFY(!meshOcc.IsNull());
+
+    const StlReader::ReadResult result = StlReader::readFile(filePath);
+    QVERIFY(result.valid());
+    QCOMPARE(result.get().size(), size_t(1));
+    const Handle_Poly_Triangulation& mesh = result.get().front().mesh;
+    QVERIFY(!mesh.IsNull());
+    QCOMPARE(mesh->NbTriangles(), meshOcc->NbTriangles());
+    QCOMPARE(mesh->NbNodes(), meshOcc->NbNodes());
+    QCOMPARE(MeshUtils::triangulationVolume(mesh), MeshUtils::triangulationVolume(meshOcc));
+    QCOMPARE(MeshUtils::triangulationArea(mesh), MeshUtils::triangulationArea(meshOcc));
+}
+
+void Test::StlReader_test_data()
+{
+    QTest::addColumn<QString>("filePath");
+
+    QTest::newRow("cube.stla") << "inputs/cube.stla";
+    QTest::newRow("cube.stlb") << "inputs/cube.stlb";
+}
+
+void Test::StlReader_asciiMultiSolid_test()
+{
+    const QString filePath = QDir::temp().filePath("mayo_test_multisolid.stla");
+    {
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(
+            "solid first part\n"
+            "  facet normal 0 0 1\n"
+            "    outer loop\n"
+            "      vertex 0 0 0\n"
+            "      vertex 1.5e+01 0 0\n"
+            "      vertex 15. 1E1 -0\n"
+            "    endloop\n"
+            "  endfacet\n"
+            "  facet normal 0 0 1\n"
+            "    outer loop\n"
+            "      vertex 0 0 0\n"
+            "      vertex 15 10 0\n"
+            "      vertex 0 +10 0\n"
+            "    endloop\n"
+            "  endfacet\n"
+            "endsolid first part\n"
+            // Keywords are case-insensitive
+            "SOLID second\n"
+            "FACET NORMAL 0 0 1\n"
+            "OUTER LOOP\n"
+            "VERTEX -0.5 -.5 2.5e-1\n"
+            "Vertex 0.5 -0.5 0.25\n"
+            "vertex 0 0.5 0.25\n"
+            "EndLoop\n"
+            "ENDFACET\n"
+            "ENDSOLID second\n");
+    }
+
+    const StlReader::ReadResult result = StlReader::readFile(filePath);
+    QVERIFY(result.valid());
+    const std::vector<StlReader::Solid>& vecSolid = result.get();
+    QCOMPARE(vecSolid.size(), size_t(2));
+    QCOMPARE(vecSolid.at(0).name, QString("first part"));
+    QCOMPARE(vecSolid.at(0).mesh->NbTriangles(), 2);
+    QCOMPARE(vecSolid.at(0).mesh->NbNodes(), 4);
+    QCOMPARE(MeshUtils::triangulationArea(vecSolid.at(0).mesh), 150.);
+    QCOMPARE(vecSolid.at(1).name, QString("second"));
+    QCOMPARE(vecSolid.at(1).mesh->NbTriangles(), 1);
+    QCOMPARE(vecSolid.at(1).mesh->NbNodes(), 3);
+    QCOMPARE(MeshUtils::triangulationArea(vecSolid.at(1).mesh), 0.5);
+
+    // Invalid contents
+    {
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write("solid\nfacet normal 0 0 1\nouter loop\nvertex 0 0 0\nvertex 1 0 0\nendloop\nendfacet\nendsolid\n");
+    }
+
+    QVERIFY(!StlReader::readFile(filePath).valid());
+}
+
+void Test::StlReader_binaryTrailingData_test()
+{
+    QFile fileCube("inputs/cube.stlb");
+    QVERIFY(fileCube.open(QIODevice::ReadOnly));
+    const QByteArray bytesCube = fileCube.readAll();
+    const StlReader::ReadResult resultCube = StlReader::readFile(fileCube.fileName());
+    QVERIFY(resultCube.valid());
+
+    // Data appended after the facets is ignored
+    const QString filePath = QDir::temp().filePath("mayo_test_trailing.stlb");
+    {
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(bytesCube);
+        file.write("trailing data");
+    }
+
+    QVERIFY(StlReader::isBinaryFile(filePath));
+    const StlReader::ReadResult result = StlReader::readFile(filePath);
+    QVERIFY(result.valid());
+    QCOMPARE(result.get().size(), size_t(1));
+    const Handle_Poly_Triangulation& mesh = result.get().front().mesh;
+    const Handle_Poly_Triangulation& meshCube = resultCube.get().front().mesh;
+    QCOMPARE(mesh->NbTriangles(), meshCube->NbTriangles());
+    QCOMPARE(mesh->NbNodes(), meshCube->NbNodes());
+
+    // Truncated contents
+    {
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(bytesCube.left(bytesCube.size() - 1));
+    }
+
+    QVERIFY(!StlReader::isBinaryFile(filePath));
+}
+
+void Test::StlReader_benchmark()
+{
+    QFETCH(Application::StlIoLibrary, stlIoLibrary);
+
+    // Grid size can be increased with environment variable to benchmark on
+    // large files, eg MAYO_BENCH_STL_GRID_SIZE=5000 produces a 2.5GB file
+    int gridSize = qEnvironmentVariableIntValue("MAYO_BENCH_STL_GRID_SIZE");
+    if (gridSize <= 0)
+        gridSize = 500;
+
+    const QString filePath = QDir::temp().filePath("mayo_bench_grid.stlb");
+    if (!QFile::exists(filePath) || !StlReader::isBinaryFile(filePath)
+            || QFileInfo(filePath).size() != (84 + 50 * 2 * qint64(gridSize) * gridSize))
+    {
+        QVERIFY(Internal::writeBinaryStlGrid(filePath, gridSize));
+    }
+
+    Handle_Poly_Triangulation mesh;
+    QBENCHMARK {
+        if (stlIoLibrary == Application::StlIoLibrary::Mayo) {
+            const StlReader::ReadResult result = StlReader::readFile(filePath);
+            QVERIFY(result.valid());
+            mesh = result.get().front().mesh;
+        }
+        else if (stlIoLibrary == Application::StlIoLibrary::OpenCascade) {
+            mesh = RWStl::ReadFile(
+                        OSD_Path(filePath.toLocal8Bit().constData()),
+                        Handle_Message_ProgressIndicator());
+        }
+    }
+
+    QVERIFY(!mesh.IsNull());
+    QCOMPARE(mesh->NbTriangles(), 2 * gridSize * gridSize);
+    QCOMPARE(mesh->NbNodes(), (gridSize + 1) * (gridSize + 1));
+}
+
+void Test::StlReader_benchmark_data()
+{
+    QTest::addColumn<Application::StlIoLibrary>("stlIoLibrary");
+
+    // TODO Add gmio once the tests are built with HAVE_GMIO
+    QTest::newRow("OpenCascade") << Application::StlIoLibrary::OpenCascade;
+    QTest::newRow("Mayo") << Application::StlIoLibrary::Mayo;
+}
+
+void Test::StlWriter_test()
+{
+    QFETCH(StlWriter::Format, format);
+
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30);
+    BRepMesh_IncrementalMesh mesher(shapeBox, 0.1);
+    QVERIFY(mesher.IsDone());
+
+    const QString filePath = QDir::temp().filePath("mayo_test_writer.stl");
+    StlWriter writer(format);
+    QVERIFY(writer.open(filePath).valid());
+    writer.beginSolid("first box");
+    writer.writeShape(shapeBox);
+    writer.endSolid();
+    writer.beginSolid("second box");
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec(100, 0, 0));
+    writer.writeShape(shapeBox.Moved(TopLoc_Location(trsf)));
+    writer.endSolid();
+    QVERIFY(writer.close().valid());
+    QCOMPARE(writer.triangleCount(), qint64(24));
+
+    const StlReader::ReadResult result = StlReader::readFile(filePath);
+    QVERIFY(result.valid());
+    const std::vector<StlReader::Solid>& vecSolid = result.get();
+    if (format == StlWriter::Format::Ascii) {
+        QCOMPARE(vecSolid.size(), size_t(2));
+        QCOMPARE(vecSolid.at(0).name, QString("first box"));
+        QCOMPARE(vecSolid.at(1).name, QString("second box"));
+        for (const StlReader::Solid& solid : vecSolid) {
+            QCOMPARE(solid.mesh->NbTriangles(), 12);
+            QCOMPARE(MeshUtils::triangulationArea(solid.mesh), 2200.);
+            QCOMPARE(MeshUtils::triangulationVolume(solid.mesh), 6000.);
+        }
+    }
+    else {
+        // Binary format has a single implicit solid
+        QCOMPARE(vecSolid.size(), size_t(1));
+        QCOMPARE(vecSolid.front().mesh->NbTriangles(), 24);
+        QCOMPARE(MeshUtils::triangulationArea(vecSolid.front().mesh), 4400.);
+        QCOMPARE(MeshUtils::triangulationVolume(vecSolid.front().mesh), 12000.);
+    }
+
+    // Formatted floats must read back to the same values
+    for (float value : { 0.f, -0.5f, 0.1f, 1e-7f, 123456.789f, 3.4e38f, -1.17549435e-38f }) {
+        char buffer[32] = {};
+        StlWriter::formatFloat(buffer, value);
+        QCOMPARE(std::strtof(buffer, nullptr), value);
+    }
+}
+
+void Test::StlWriter_test_data()
+{
+    QTest::addColumn<StlWriter::Format>("format");
+
+    QTest::newRow("ascii") << StlWriter::Format::Ascii;
+    QTest::newRow("binary") << StlWriter::Format::Binary;
+}
+
+void Test::StlWriter_benchmark()
+{
+    QFETCH(Application::StlIoLibrary, stlIoLibrary);
+    QFETCH(StlWriter::Format, format);
+
+    int gridSize = qEnvironmentVariableIntValue("MAYO_BENCH_STL_GRID_SIZE");
+    if (gridSize <= 0)
+        gridSize = 500;
+
+    const QString gridFilePath = QDir::temp().filePath("mayo_bench_writer_grid.stlb");
+    QVERIFY(Internal::writeBinaryStlGrid(gridFilePath, gridSize));
+    const StlReader::ReadResult result = StlReader::readFile(gridFilePath);
+    QVERIFY(result.valid());
+    const Handle_Poly_Triangulation mesh = result.get().front().mesh;
+
+    const QString filePath = QDir::temp().filePath("mayo_bench_writer.stl");
+    const QByteArray filePathLocal8b = filePath.toLocal8Bit();
+    qint64 elapsed = 0;
+    QBENCHMARK {
+        QElapsedTimer chrono;
+        chrono.start();
+        if (stlIoLibrary == Application::StlIoLibrary::Mayo) {
+            StlWriter writer(format);
+            QVERIFY(writer.open(filePath).valid());
+            writer.beginSolid("grid");
+            writer.writeTriangulation(mesh);
+            QVERIFY(writer.close().valid());
+        }
+        else if (stlIoLibrary == Application::StlIoLibrary::OpenCascade) {
+            const OSD_Path osdFilePath(filePathLocal8b.constData());
+            if (format == StlWriter::Format::Ascii)
+                QVERIFY(RWStl::WriteAscii(mesh, osdFilePath));
+            else
+                QVERIFY(RWStl::WriteBinary(mesh, osdFilePath));
+        }
+
+        elapsed = chrono.elapsed();
+    }
+
+    const qint64 fileSize = QFileInfo(filePath).size();
+    if (elapsed > 0)
+        qInfo() << "Throughput:" << (fileSize / (1024. * 1024.)) / (elapsed / 1000.) << "MB/s";
+}
+
+void Test::StlWriter_benchmark_data()
+{
+    QTest::addColumn<Application::StlIoLibrary>("stlIoLibrary");
+    QTest::addColumn<StlWriter::Format>("format");
+
+    QTest::newRow("OpenCascade_ascii")
+            << Application::StlIoLibrary::OpenCascade << StlWriter::Format::Ascii;
+    QTest::newRow("OpenCascade_binary")
+            << Application::StlIoLibrary::OpenCascade << StlWriter::Format::Binary;
+    QTest::newRow("Mayo_ascii") << Application::StlIoLibrary::Mayo << StlWriter::Format::Ascii;
+    QTest::newRow("Mayo_binary") << Application::StlIoLibrary::Mayo << StlWriter::Format::Binary;
+}
+
 void Test::StringUtils_append_test()
 {
     QFETCH(QString, strExpected);
@@ -376,6 +1804,261 @@ void Test::StringUtils_text_test_data()
             << QStringLiteral("(0.55mm 4.9mm 15.14mm)");
 }
 
+void Test::TaskScheduler_test()
+{
+    auto fnSleep = [](int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); };
+    auto fnWaitFor = [=](const std::function<bool()>& fnCondition) {
+        QElapsedTimer chrono;
+        chrono.start();
+        while (!fnCondition() && chrono.elapsed() < 5000)
+            fnSleep(1);
+
+        return fnCondition();
+    };
+
+    // Count of jobs running at the same time is bounded by worker count
+    {
+        qttask::Scheduler scheduler(2);
+        std::atomic<int> runningCount = {};
+        std::atomic<int> maxRunningCount = {};
+        std::atomic<int> doneCount = {};
+        for (int i = 0; i < 8; ++i) {
+            qttask::Scheduler::Job job;
+            job.id = i;
+            job.func = [&]{
+                const int count = ++runningCount;
+                int maxCount = maxRunningCount;
+                while (count > maxCount && !maxRunningCount.compare_exchange_weak(maxCount, count));
+                fnSleep(10);
+                --runningCount;
+                ++doneCount;
+            };
+            scheduler.submit(std::move(job));
+        }
+
+        QVERIFY(fnWaitFor([&]{ return doneCount == 8; }));
+        QVERIFY(maxRunningCount <= 2);
+    }
+
+    // Queued jobs are started by priority, then submission order
+    // Queued jobs can be cancelled or reprioritized
+    {
+        qttask::Scheduler scheduler(1);
+        std::atomic<bool> blockerStarted = {};
+        std::atomic<bool> blockerReleased = {};
+        qttask::Scheduler::Job jobBlocker;
+        jobBlocker.id = 100;
+        jobBlocker.func = [&]{
+            blockerStarted = true;
+            while (!blockerReleased)
+                fnSleep(1);
+        };
+        scheduler.submit(std::move(jobBlocker));
+        QVERIFY(fnWaitFor([&]{ return blockerStarted.load(); }));
+
+        std::mutex mutexOrder;
+        std::vector<quint64> vecJobIdOrder;
+        int cancelCount = 0;
+        const std::pair<quint64, int> arrayJobIdPriority[] = { {1, 0}, {2, 2}, {3, 1}, {4, 1}, {5, 5} };
+        for (const auto& jobIdPriority : arrayJobIdPriority) {
+            qttask::Scheduler::Job job;
+            job.id = jobIdPriority.first;
+            job.priority = jobIdPriority.second;
+            job.func = [&, jobId = job.id]{
+                std::lock_guard<std::mutex> lock(mutexOrder);
+                vecJobIdOrder.push_back(jobId);
+            };
+            job.cancelFunc = [&]{ ++cancelCount; };
+            scheduler.submit(std::move(job));
+        }
+
+        QCOMPARE(scheduler.queuedCount(), 5);
+        QVERIFY(scheduler.cancel(5));
+        QVERIFY(!scheduler.cancel(5));
+        QVERIFY(!scheduler.cancel(100)); // Already running
+        QCOMPARE(cancelCount, 1);
+        QVERIFY(scheduler.setPriority(1, 3));
+        blockerReleased = true;
+        QVERIFY(fnWaitFor([&]{ return scheduler.queuedCount() == 0 && scheduler.runningCount() == 0; }));
+        QCOMPARE(vecJobIdOrder, std::vector<quint64>({ 1, 2, 3, 4 }));
+    }
+
+    // Job is started only if running jobs leave enough memory budget
+    {
+        qttask::Scheduler scheduler(2, 100);
+        std::atomic<bool> job1Released = {};
+        std::atomic<bool> job2Started = {};
+        std::atomic<bool> job3Started = {};
+        qttask::Scheduler::Job job1;
+        job1.id = 1;
+        job1.memoryCost = 80;
+        job1.func = [&]{
+            while (!job1Released)
+                fnSleep(1);
+        };
+        qttask::Scheduler::Job job2;
+        job2.id = 2;
+        job2.memoryCost = 50;
+        job2.func = [&]{ job2Started = true; };
+        scheduler.submit(std::move(job1));
+        scheduler.submit(std::move(job2));
+        fnSleep(50);
+        QVERIFY(!job2Started);
+        QCOMPARE(scheduler.memoryInUse(), quint64(80));
+        job1Released = true;
+        QVERIFY(fnWaitFor([&]{ return job2Started.load(); }));
+
+        // Job exceeding the budget is started anyway when alone
+        qttask::Scheduler::Job job3;
+        job3.id = 3;
+        job3.memoryCost = 500;
+        job3.func = [&]{ job3Started = true; };
+        scheduler.submit(std::move(job3));
+        QVERIFY(fnWaitFor([&]{ return job3Started.load(); }));
+    }
+
+    // Scheduler state is observable through Manager signals
+    {
+        qttask::Manager taskMgr;
+        qttask::Scheduler scheduler(1);
+        QSignalSpy spyQueued(&taskMgr, &qttask::Manager::queued);
+        QSignalSpy spyStarted(&taskMgr, &qttask::Manager::started);
+        QSignalSpy spyEnded(&taskMgr, &qttask::Manager::ended);
+        std::atomic<bool> task1Released = {};
+        bool task2Executed = false;
+        auto task1 = taskMgr.newTask<qttask::Scheduler>(&scheduler);
+        task1->run([&]{
+            while (!task1Released)
+                fnSleep(1);
+        });
+        auto task2 = taskMgr.newTask<qttask::Scheduler>(&scheduler);
+        const quint64 task2Id = task2->taskId();
+        task2->run([&]{ task2Executed = true; });
+        QCOMPARE(spyQueued.count(), 2);
+
+        // Abort of a queued task ends it without starting it
+        taskMgr.requestAbort(task2Id);
+        QTRY_COMPARE(spyEnded.count(), 1);
+        QCOMPARE(spyEnded.at(0).at(0).toULongLong(), task2Id);
+        task1Released = true;
+        QTRY_COMPARE(spyEnded.count(), 2);
+        QCOMPARE(spyStarted.count(), 1);
+        QVERIFY(!task2Executed);
+    }
+}
+
+void Test::TessellationCache_eviction_test()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    TessellationCache cache;
+    cache.setDirectory(cacheDir.path());
+    cache.setMaxSize(64 * 1024 * 1024);
+    cache.setEnabled(true);
+
+    TessellationCache::Entry entry;
+    entry.cafDoc = CafUtils::createXdeDocument();
+    XCAFDoc_DocumentTool::ShapeTool(entry.cafDoc->Main())->AddShape(BRepPrimAPI_MakeBox(1, 1, 1), false);
+    const QByteArray keyOld = TessellationCache::computeKey("inputs/cube.step", "old");
+    const QByteArray keyRecent = TessellationCache::computeKey("inputs/cube.step", "recent");
+    QVERIFY(cache.store(keyOld, entry));
+    QVERIFY(cache.store(keyRecent, entry));
+    QCOMPARE(cache.statistics().entryCount, 2);
+
+    // Age both entries, then touch one of them by loading it
+    const QDateTime pastTime = QDateTime::currentDateTime().addSecs(-3600);
+    for (const QFileInfo& fileInfo : QDir(cacheDir.path()).entryInfoList(QDir::Files)) {
+        QFile file(fileInfo.absoluteFilePath());
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(pastTime, QFileDevice::FileModificationTime));
+    }
+
+    TessellationCache::Entry entryLoaded;
+    QVERIFY(cache.load(keyRecent, &entryLoaded));
+
+    // Room left for a single entry, the least recently used one is evicted
+    cache.setMaxSize(cache.statistics().totalSize - 1);
+    QCOMPARE(cache.statistics().entryCount, 1);
+    QVERIFY(cache.load(keyRecent, &entryLoaded));
+    QVERIFY(!cache.load(keyOld, &entryLoaded));
+
+    // Loading a missing entry doesn't create an empty file
+    QCOMPARE(cache.statistics().entryCount, 1);
+    QVERIFY(!QDir(cacheDir.path()).entryInfoList(QDir::Files).isEmpty());
+    for (const QFileInfo& fileInfo : QDir(cacheDir.path()).entryInfoList(QDir::Files))
+        QVERIFY(fileInfo.size() > 0);
+}
+
+void Test::TessellationCache_test()
+{
+    QFETCH(QString, filePath);
+    QFETCH(Application::PartFormat, partFormat);
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    auto app = Application::instance();
+    TessellationCache* cache = app->tessellationCache();
+    cache->setDirectory(cacheDir.path());
+    cache->setMaxSize(64 * 1024 * 1024);
+    cache->setEnabled(true);
+    const TessellationCache::Statistics statsBegin = cache->statistics();
+
+    auto fnImport = [=](Document* doc, Application::ImportInfo* info) -> const XdeDocumentItem* {
+        const Application::IoResult res = app->importInDocument(doc, partFormat, filePath, nullptr, info);
+        if (!res.valid() || doc->rootItems().size() != 1)
+            return nullptr;
+
+        return dynamic_cast<const XdeDocumentItem*>(doc->rootItems().at(0));
+    };
+
+    // First import fills the cache, second one is loaded from it
+    const std::unique_ptr<Document> docMiss(new Document(nullptr));
+    Application::ImportInfo infoMiss;
+    const XdeDocumentItem* xdeDocItemMiss = fnImport(docMiss.get(), &infoMiss);
+    const std::unique_ptr<Document> docHit(new Document(nullptr));
+    Application::ImportInfo infoHit;
+    const XdeDocumentItem* xdeDocItemHit = fnImport(docHit.get(), &infoHit);
+    const TessellationCache::Statistics stats = cache->statistics();
+    cache->setEnabled(false);
+
+    QVERIFY(xdeDocItemMiss != nullptr);
+    QVERIFY(xdeDocItemHit != nullptr);
+    QVERIFY(!infoMiss.isFromCache);
+    QVERIFY(infoHit.isFromCache);
+    QCOMPARE(stats.hitCount - statsBegin.hitCount, 1);
+    QCOMPARE(stats.missCount - statsBegin.missCount, 1);
+    QCOMPARE(stats.entryCount, 1);
+    QVERIFY(stats.totalSize > 0);
+
+    QCOMPARE(xdeDocItemHit->propertyVolume.quantity().value(), xdeDocItemMiss->propertyVolume.quantity().value());
+    QCOMPARE(xdeDocItemHit->propertyArea.quantity().value(), xdeDocItemMiss->propertyArea.quantity().value());
+    const TDF_LabelSequence seqFreeShapeMiss = xdeDocItemMiss->topLevelFreeShapes();
+    const TDF_LabelSequence seqFreeShapeHit = xdeDocItemHit->topLevelFreeShapes();
+    QCOMPARE(seqFreeShapeHit.Size(), seqFreeShapeMiss.Size());
+    for (int i = 1; i <= seqFreeShapeHit.Size(); ++i) {
+        const TDF_Label labelMiss = seqFreeShapeMiss.Value(i);
+        const TDF_Label labelHit = seqFreeShapeHit.Value(i);
+        QCOMPARE(XdeDocumentItem::findLabelName(labelHit), XdeDocumentItem::findLabelName(labelMiss));
+        QCOMPARE(XdeDocumentItem::isShapeAssembly(labelHit), XdeDocumentItem::isShapeAssembly(labelMiss));
+        const TopoDS_Shape shapeHit = XdeDocumentItem::shape(labelHit);
+        QVERIFY(BRepTools::Triangulation(shapeHit, Precision::Infinite()));
+    }
+
+    // Entries larger than maximum size are evicted
+    cache->setMaxSize(1);
+    QCOMPARE(cache->statistics().entryCount, 0);
+    cache->setDirectory(QString());
+}
+
+void Test::TessellationCache_test_data()
+{
+    QTest::addColumn<QString>("filePath");
+    QTest::addColumn<Application::PartFormat>("partFormat");
+
+    QTest::newRow("cube.step") << "inputs/cube.step" << Application::PartFormat::Step;
+    QTest::newRow("cube.iges") << "inputs/cube.iges" << Application::PartFormat::Iges;
+}
+
 void Test::UnitSystem_test()
 {
     QFETCH(UnitSystem::TranslateResult, trResultActual);
@@ -407,6 +2090,575 @@ void Test::UnitSystem_test_data()
             << UnitSystem::TranslateResult{ 180., "°", radDeg };
 }
 
+namespace Internal {
+
+// Controller recording camera changes instead of rendering them on a view
+class FakeV3dViewController : public V3dViewController {
+public:
+    FakeV3dViewController()
+        : V3dViewController(Handle_V3d_View())
+    {}
+
+    using V3dViewController::CameraChanges;
+    using V3dViewController::queueRotation;
+    using V3dViewController::queuePanning;
+    using V3dViewController::applyPendingCameraChanges;
+
+    std::vector<CameraChanges> vecRenderedChanges;
+
+protected:
+    void renderCameraChanges(const CameraChanges& changes) override {
+        this->vecRenderedChanges.push_back(changes);
+    }
+
+    AbstractRubberBand* createRubberBand() override { return nullptr; }
+};
+
+} // namespace Internal
+
+void Test::V3dViewController_coalescing_test()
+{
+    Internal::FakeV3dViewController controller;
+    QSignalSpy spyFrameRendered(&controller, &V3dViewController::frameRendered);
+
+    // Rotation, panning and zoom queued before a frame are rendered at once
+    // Frame is driven manually here, before the frame clock ticks
+    controller.queueRotation(QPoint(10, 10));
+    controller.queueRotation(QPoint(20, 15));
+    controller.queuePanning(5, 0);
+    controller.queuePanning(3, -2);
+    controller.zoomIn();
+    controller.applyPendingCameraChanges();
+    QCOMPARE(controller.vecRenderedChanges.size(), size_t(1));
+    QCOMPARE(spyFrameRendered.count(), 1);
+    const Internal::FakeV3dViewController::CameraChanges& changes = controller.vecRenderedChanges.front();
+    QVERIFY(changes.hasRotation);
+    QCOMPARE(changes.rotationPos, QPoint(20, 15));
+    QCOMPARE(changes.panDelta, QPoint(8, -2));
+    QCOMPARE(changes.scaleFactor, 1.1);
+    QCOMPARE(controller.frameStats().frameCount, quint64(1));
+    QCOMPARE(controller.frameStats().coalescedEventCount, quint64(4));
+
+    // Frame without queued changes doesn't redraw
+    controller.applyPendingCameraChanges();
+    QCOMPARE(controller.vecRenderedChanges.size(), size_t(1));
+    QCOMPARE(spyFrameRendered.count(), 1);
+
+    // Frame clock renders the changes queued meanwhile on its next tick, then stops
+    controller.queueRotation(QPoint(30, 20));
+    controller.queuePanning(1, 1);
+    controller.zoomOut();
+    QTRY_COMPARE(controller.vecRenderedChanges.size(), size_t(2));
+    QTest::qWait(100);
+    QCOMPARE(controller.vecRenderedChanges.size(), size_t(2));
+    QCOMPARE(spyFrameRendered.count(), 2);
+    QCOMPARE(controller.vecRenderedChanges.back().rotationPos, QPoint(30, 20));
+    QCOMPARE(controller.vecRenderedChanges.back().panDelta, QPoint(1, 1));
+    QCOMPARE(controller.vecRenderedChanges.back().scaleFactor, 1. / 1.1);
+    QCOMPARE(controller.frameStats().frameCount, quint64(2));
+    QCOMPARE(controller.frameStats().coalescedEventCount, quint64(6));
+}
+
+namespace Internal {
+
+// Sum of square roots of range [itBegin, itEnd), computed with recursive fork/join
+static double forkJoinSqrtSum(
+        qttask::WorkStealingPool* pool, const double* itBegin, const double* itEnd)
+{
+    constexpr std::ptrdiff_t grainSize = 4096;
+    if (itEnd - itBegin <= grainSize) {
+        double sum = 0.;
+        for (const double* it = itBegin; it != itEnd; ++it)
+            sum += std::sqrt(*it);
+
+        return sum;
+    }
+
+    const double* itMiddle = itBegin + (itEnd - itBegin) / 2;
+    double sumLeft = 0.;
+    double sumRight = 0.;
+    qttask::TaskGroup group(pool);
+    group.spawn([&]{ sumLeft = forkJoinSqrtSum(pool, itBegin, itMiddle); });
+    group.spawn([&]{ sumRight = forkJoinSqrtSum(pool, itMiddle, itEnd); });
+    group.wait();
+    return sumLeft + sumRight;
+}
+
+} // namespace Internal
+
+void Test::V3dViewer_sharedDriver_benchmark()
+{
+    QFETCH(int, documentCount);
+    QFETCH(bool, isDriverShared);
+
+    // Same setup as GuiDocument : a viewer and an AIS context per document
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(1, 1, 1);
+    auto fnCreateDocuments = [&]{
+        std::vector<Handle_AIS_InteractiveContext> vecCtx;
+        const Handle_Graphic3d_GraphicDriver sharedDriver = Internal::createHeadlessGraphicDriver();
+        for (int i = 0; i < documentCount; ++i) {
+            Handle_V3d_Viewer viewer = new V3d_Viewer(
+                        isDriverShared ? sharedDriver : Internal::createHeadlessGraphicDriver());
+            viewer->SetDefaultLights();
+            viewer->SetLightOn();
+            Handle_AIS_InteractiveContext ctx = new AIS_InteractiveContext(viewer);
+            ctx->Display(new AIS_Shape(shapeBox), false);
+            vecCtx.push_back(ctx);
+        }
+
+        return vecCtx;
+    };
+
+    const qint64 memUsageBefore = OsUtils::processMemoryUsage();
+    std::vector<Handle_AIS_InteractiveContext> vecCtx = fnCreateDocuments();
+    const qint64 memUsageAfter = OsUtils::processMemoryUsage();
+    if (memUsageBefore > 0 && memUsageAfter > 0) {
+        qInfo() << "Documents:" << documentCount
+                << "Memory(KB):" << (memUsageAfter - memUsageBefore) / 1024;
+    }
+
+    vecCtx.clear();
+    QBENCHMARK {
+        fnCreateDocuments();
+    }
+}
+
+void Test::V3dViewer_sharedDriver_benchmark_data()
+{
+    QTest::addColumn<int>("documentCount");
+    QTest::addColumn<bool>("isDriverShared");
+
+    QTest::newRow("driver_per_document_1") << 1 << false;
+    QTest::newRow("driver_per_document_20") << 20 << false;
+    QTest::newRow("shared_driver_1") << 1 << true;
+    QTest::newRow("shared_driver_20") << 20 << true;
+}
+
+void Test::WorkStealingPool_test()
+{
+    // Recursive fork/join
+    {
+        qttask::WorkStealingPool pool(4);
+        QCOMPARE(pool.workerCount(), 4);
+        std::vector<double> vecValue(1000 * 1000);
+        for (size_t i = 0; i < vecValue.size(); ++i)
+            vecValue.at(i) = static_cast<double>(i % 1000);
+
+        double expectedSum = 0.;
+        for (double value : vecValue)
+            expectedSum += std::sqrt(value);
+
+        const double* itBegin = vecValue.data();
+        const double sum = Internal::forkJoinSqrtSum(&pool, itBegin, itBegin + vecValue.size());
+        QVERIFY(std::abs(sum - expectedSum) <= 1e-9 * expectedSum);
+    }
+
+    // Progress of subtasks is aggregated in task progress
+    {
+        qttask::Manager taskMgr;
+        qttask::WorkStealingPool pool(2);
+        QSignalSpy spyProgress(&taskMgr, &qttask::Manager::progress);
+        QSignalSpy spyEnded(&taskMgr, &qttask::Manager::ended);
+        std::atomic<int> subtaskCount = {};
+        auto task = taskMgr.newTask<qttask::WorkStealingPool>(&pool);
+        QCOMPARE(task->pool(), &pool);
+        task->run([&, task]{
+            qttask::TaskGroup group(task->pool(), &task->progress());
+            for (int i = 1; i <= 20; ++i)
+                group.spawn([&]{ ++subtaskCount; }, i);
+        });
+        QTRY_COMPARE(spyEnded.count(), 1);
+        QCOMPARE(subtaskCount.load(), 20);
+        QVERIFY(!spyProgress.isEmpty());
+        int prevValue = -1;
+        for (const QList<QVariant>& args : spyProgress) {
+            QVERIFY(args.at(1).toInt() > prevValue);
+            prevValue = args.at(1).toInt();
+        }
+
+        QCOMPARE(prevValue, 100);
+    }
+
+    // Subtasks not started yet are skipped once abort is requested
+    {
+        qttask::Manager taskMgr;
+        qttask::WorkStealingPool pool(2);
+        QSignalSpy spyEnded(&taskMgr, &qttask::Manager::ended);
+        std::atomic<int> startedCount = {};
+        std::atomic<bool> released = {};
+        auto task = taskMgr.newTask<qttask::WorkStealingPool>(&pool);
+        const quint64 taskId = task->taskId();
+        task->run([&, task]{
+            qttask::TaskGroup group(task->pool(), &task->progress());
+            for (int i = 0; i < 100; ++i) {
+                group.spawn([&]{
+                    ++startedCount;
+                    while (!released)
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                });
+            }
+        });
+        QTRY_VERIFY(startedCount > 0);
+        taskMgr.requestAbort(taskId);
+        released = true;
+        QTRY_COMPARE(spyEnded.count(), 1);
+        QVERIFY(startedCount <= pool.workerCount());
+    }
+}
+
+void Test::WorkStealingPool_benchmark()
+{
+    QFETCH(int, workerCount);
+
+    std::vector<double> vecValue(1 << 24);
+    for (size_t i = 0; i < vecValue.size(); ++i)
+        vecValue.at(i) = static_cast<double>(i % 1000);
+
+    qttask::WorkStealingPool pool(workerCount);
+    const double* itBegin = vecValue.data();
+    double sum = 0.;
+    QBENCHMARK {
+        sum = Internal::forkJoinSqrtSum(&pool, itBegin, itBegin + vecValue.size());
+    }
+
+    QVERIFY(sum > 0.);
+}
+
+void Test::WorkStealingPool_benchmark_data()
+{
+    QTest::addColumn<int>("workerCount");
+
+    const int idealThreadCount = std::max(QThread::idealThreadCount(), 1);
+    for (int count = 1; count < idealThreadCount; count *= 2)
+        QTest::newRow(qPrintable(QString("%1_workers").arg(count))) << count;
+
+    QTest::newRow(qPrintable(QString("%1_workers").arg(idealThreadCount))) << idealThreadCount;
+}
+
+namespace Internal {
+
+// Creates an XDE document with an assembly of 'depth' levels, each assembly
+// having 'breadth' components. Leaves are instances of the same box
+static Handle_TDocStd_Document createDeepAssembly(int depth, int breadth)
+{
+    Handle_TDocStd_Document doc = CafUtils::createXdeDocument();
+    Handle_XCAFDoc_ShapeTool shapeTool = XCAFDoc_DocumentTool::ShapeTool(doc->Main());
+    TDF_Label labelPart = shapeTool->AddShape(BRepPrimAPI_MakeBox(1, 1, 1), false);
+    for (int i = 0; i < depth; ++i) {
+        const TDF_Label labelAsm = shapeTool->NewShape();
+        for (int j = 0; j < breadth; ++j) {
+            gp_Trsf trsf;
+            trsf.SetTranslation(gp_Vec(2 * j * std::pow(breadth, i), 0, 0));
+            shapeTool->AddComponent(labelAsm, labelPart, TopLoc_Location(trsf));
+        }
+
+        labelPart = labelAsm;
+    }
+
+    return doc;
+}
+
+// Count of nodes in the assembly tree : a reference node and a referred node
+// for each component
+static int deepAssemblyNodeCount(int depth, int breadth)
+{
+    int count = 1;
+    int levelCount = 1;
+    for (int i = 0; i < depth; ++i) {
+        levelCount *= breadth;
+        count += 2 * levelCount;
+    }
+
+    return count;
+}
+
+static int assemblyTreeNodeCount(const Tree<TDF_Label>& tree)
+{
+    int count = 0;
+    deepForeachTreeNode(tree, [&](TreeNodeId) { ++count; });
+    return count;
+}
+
+// Absolute location computed by walking up the assembly tree, no cache involved
+static TopLoc_Location walkShapeAbsoluteLocation(const Tree<TDF_Label>& tree, TreeNodeId nodeId)
+{
+    TopLoc_Location absoluteLoc;
+    for (TreeNodeId it = nodeId; it != 0; it = tree.nodeParent(it))
+        absoluteLoc = XdeDocumentItem::shapeReferenceLocation(tree.nodeData(it)) * absoluteLoc;
+
+    return absoluteLoc;
+}
+
+static bool isSameTransformation(const TopLoc_Location& lhs, const TopLoc_Location& rhs)
+{
+    const gp_Trsf trsfLhs = lhs.Transformation();
+    const gp_Trsf trsfRhs = rhs.Transformation();
+    for (int row = 1; row <= 3; ++row) {
+        for (int col = 1; col <= 4; ++col) {
+            if (std::abs(trsfLhs.Value(row, col) - trsfRhs.Value(row, col)) > 1e-9)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace Internal
+
+void Test::XdeDocumentItem_absoluteLocation_test()
+{
+    XdeDocumentItem xdeDocItem(Internal::createDeepAssembly(3, 3));
+    xdeDocItem.fetchAssemblyTree();
+    const Tree<TDF_Label>& asmTree = xdeDocItem.assemblyTree();
+    std::vector<TreeNodeId> vecNodeId;
+    deepForeachTreeNode(asmTree, [&](TreeNodeId nodeId) { vecNodeId.push_back(nodeId); });
+
+    auto fnCheckAbsoluteLocations = [&]{
+        const std::vector<TopLoc_Location> vecLoc = xdeDocItem.shapeAbsoluteLocations(vecNodeId);
+        QCOMPARE(vecLoc.size(), vecNodeId.size());
+        for (size_t i = 0; i < vecNodeId.size(); ++i) {
+            const TopLoc_Location expectedLoc = Internal::walkShapeAbsoluteLocation(asmTree, vecNodeId.at(i));
+            QVERIFY(Internal::isSameTransformation(vecLoc.at(i), expectedLoc));
+            QVERIFY(Internal::isSameTransformation(
+                        xdeDocItem.shapeAbsoluteLocation(vecNodeId.at(i)), expectedLoc));
+        }
+    };
+    fnCheckAbsoluteLocations();
+
+    // Change location of the first component of the root assembly, only its
+    // subtree moves
+    const TreeNodeId rootId = asmTree.roots().at(0);
+    const TreeNodeId refId = asmTree.nodeChildFirst(rootId);
+    const TreeNodeId otherRefId = asmTree.nodeChildLast(rootId);
+    const TopLoc_Location otherRefLoc = xdeDocItem.shapeAbsoluteLocation(otherRefId);
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec(0, 100, 0));
+    xdeDocItem.setShapeReferenceLocation(refId, TopLoc_Location(trsf));
+    fnCheckAbsoluteLocations();
+    QVERIFY(Internal::isSameTransformation(xdeDocItem.shapeAbsoluteLocation(refId), TopLoc_Location(trsf)));
+    QVERIFY(Internal::isSameTransformation(xdeDocItem.shapeAbsoluteLocation(otherRefId), otherRefLoc));
+    deepForeachTreeNode(refId, asmTree, [&](TreeNodeId nodeId) {
+        const gp_XYZ pos = xdeDocItem.shapeAbsoluteLocation(nodeId).Transformation().TranslationPart();
+        QCOMPARE(pos.Y(), 100.);
+    });
+
+    // Compound of the parent assembly holds the new location
+    bool hasMovedComponentShape = false;
+    for (TopoDS_Iterator it(XdeDocumentItem::shape(asmTree.nodeData(rootId))); it.More(); it.Next()) {
+        if (Internal::isSameTransformation(it.Value().Location(), TopLoc_Location(trsf)))
+            hasMovedComponentShape = true;
+    }
+
+    QVERIFY(hasMovedComponentShape);
+
+    // Change location of a component of a sub-assembly instanced many times,
+    // all the nodes referring to the component move
+    const TreeNodeId subAsmId = asmTree.nodeChildFirst(otherRefId);
+    const TreeNodeId subRefId = asmTree.nodeChildFirst(subAsmId);
+    const TDF_Label subRefLabel = asmTree.nodeData(subRefId);
+    std::vector<TreeNodeId> vecSubRefNodeId;
+    for (TreeNodeId nodeId : vecNodeId) {
+        if (asmTree.nodeData(nodeId) == subRefLabel)
+            vecSubRefNodeId.push_back(nodeId);
+    }
+
+    QVERIFY(vecSubRefNodeId.size() > 1);
+    trsf.SetTranslation(gp_Vec(0, 0, 50));
+    xdeDocItem.setShapeReferenceLocation(subRefId, TopLoc_Location(trsf));
+    fnCheckAbsoluteLocations();
+    for (TreeNodeId nodeId : vecSubRefNodeId) {
+        const gp_XYZ pos = xdeDocItem.shapeAbsoluteLocation(nodeId).Transformation().TranslationPart();
+        QCOMPARE(pos.Z(), 50.);
+    }
+
+    // Null and unknown nodes
+    QVERIFY(xdeDocItem.shapeAbsoluteLocation(0).IsIdentity());
+    QVERIFY(xdeDocItem.shapeAbsoluteLocation(TreeNodeId(vecNodeId.size() + 1)).IsIdentity());
+}
+
+void Test::XdeDocumentItem_absoluteLocation_benchmark()
+{
+    QFETCH(bool, useCache);
+
+    XdeDocumentItem xdeDocItem(Internal::createDeepAssembly(5, 6));
+    xdeDocItem.fetchAssemblyTree();
+    const Tree<TDF_Label>& asmTree = xdeDocItem.assemblyTree();
+    std::vector<TreeNodeId> vecNodeId;
+    deepForeachTreeNode(asmTree, [&](TreeNodeId nodeId) { vecNodeId.push_back(nodeId); });
+
+    std::vector<TopLoc_Location> vecLoc;
+    QBENCHMARK {
+        if (useCache) {
+            vecLoc = xdeDocItem.shapeAbsoluteLocations(vecNodeId);
+        }
+        else {
+            vecLoc.clear();
+            for (TreeNodeId nodeId : vecNodeId)
+                vecLoc.push_back(Internal::walkShapeAbsoluteLocation(asmTree, nodeId));
+        }
+    }
+
+    QCOMPARE(vecLoc.size(), vecNodeId.size());
+}
+
+void Test::XdeDocumentItem_absoluteLocation_benchmark_data()
+{
+    QTest::addColumn<bool>("useCache");
+
+    QTest::newRow("walk_up") << false;
+    QTest::newRow("cached") << true;
+}
+
+void Test::XdeDocumentItem_lazyAssemblyTree_test()
+{
+    const int depth = 3;
+    const int breadth = 4;
+    XdeDocumentItem xdeDocItem(Internal::createDeepAssembly(depth, breadth));
+    const Tree<TDF_Label>& asmTree = xdeDocItem.assemblyTree();
+
+    // Only the root node is created at construction
+    QCOMPARE(static_cast<int>(asmTree.roots().size()), 1);
+    const TreeNodeId rootId = asmTree.roots().at(0);
+    QCOMPARE(Internal::assemblyTreeNodeCount(asmTree), 1);
+    QVERIFY(XdeDocumentItem::isShapeAssembly(asmTree.nodeData(rootId)));
+    QVERIFY(xdeDocItem.canFetchAssemblyNodeChildren(rootId));
+
+    // Fetching is done once
+    xdeDocItem.fetchAssemblyNodeChildren(rootId);
+    QVERIFY(!xdeDocItem.canFetchAssemblyNodeChildren(rootId));
+    xdeDocItem.fetchAssemblyNodeChildren(rootId);
+    QCOMPARE(Internal::assemblyTreeNodeCount(asmTree), 1 + breadth);
+    for (auto it = asmTree.nodeChildFirst(rootId); it != 0; it = asmTree.nodeSiblingNext(it)) {
+        QVERIFY(XdeDocumentItem::isShapeReference(asmTree.nodeData(it)));
+        QVERIFY(xdeDocItem.canFetchAssemblyNodeChildren(it));
+    }
+
+    // Fetch whole tree, leaves can't be fetched
+    xdeDocItem.fetchAssemblyTree();
+    QCOMPARE(Internal::assemblyTreeNodeCount(asmTree), Internal::deepAssemblyNodeCount(depth, breadth));
+    int leafCount = 0;
+    deepForeachTreeNode(asmTree, [&](TreeNodeId nodeId) {
+        if (asmTree.nodeChildFirst(nodeId) == 0) {
+            ++leafCount;
+            QVERIFY(XdeDocumentItem::isShapeSimple(asmTree.nodeData(nodeId)));
+            QVERIFY(!xdeDocItem.canFetchAssemblyNodeChildren(nodeId));
+        }
+    });
+    QCOMPARE(leafCount, int(std::pow(breadth, depth)));
+
+    // Rebuild resets the tree to its root nodes
+    xdeDocItem.rebuildAssemblyTree();
+    QCOMPARE(Internal::assemblyTreeNodeCount(asmTree), 1);
+
+    // Child label being neither a component nor a sub-shape can't be fetched
+    {
+        Handle_TDocStd_Document doc = CafUtils::createXdeDocument();
+        Handle_XCAFDoc_ShapeTool shapeTool = XCAFDoc_DocumentTool::ShapeTool(doc->Main());
+        const TDF_Label labelPart = shapeTool->AddShape(BRepPrimAPI_MakeBox(1, 1, 1), false);
+        labelPart.FindChild(1, true);
+        QVERIFY(labelPart.HasChild());
+        XdeDocumentItem xdeDocItemPart(doc);
+        const TreeNodeId partId = xdeDocItemPart.assemblyTree().roots().at(0);
+        QVERIFY(XdeDocumentItem::isShapeSimple(xdeDocItemPart.assemblyTree().nodeData(partId)));
+        QCOMPARE(xdeDocItemPart.assemblyNodeFetchCount(partId), 0);
+        QVERIFY(!xdeDocItemPart.canFetchAssemblyNodeChildren(partId));
+    }
+}
+
+void Test::XdeDocumentItem_lazyAssemblyTree_benchmark()
+{
+    QFETCH(bool, isLazy);
+
+    // Default gives 46656 instances, can be increased with environment variable
+    int depth = qEnvironmentVariableIntValue("MAYO_BENCH_ASSEMBLY_DEPTH");
+    if (depth <= 0)
+        depth = 6;
+
+    const int breadth = 6;
+    const Handle_TDocStd_Document doc = Internal::createDeepAssembly(depth, breadth);
+    int nodeCount = 0;
+    // Time to first paint : nodes for the top-level shapes and their children
+    // must exist so the model tree can be displayed
+    QBENCHMARK {
+        XdeDocumentItem xdeDocItem(doc);
+        if (isLazy) {
+            for (TreeNodeId rootId : xdeDocItem.assemblyTree().roots())
+                xdeDocItem.fetchAssemblyNodeChildren(rootId);
+        }
+        else {
+            xdeDocItem.fetchAssemblyTree();
+        }
+
+        nodeCount = Internal::assemblyTreeNodeCount(xdeDocItem.assemblyTree());
+    }
+
+    QCOMPARE(nodeCount, isLazy ? 1 + breadth : Internal::deepAssemblyNodeCount(depth, breadth));
+}
+
+void Test::XdeDocumentItem_lazyAssemblyTree_benchmark_data()
+{
+    QTest::addColumn<bool>("isLazy");
+
+    QTest::newRow("lazy") << true;
+    QTest::newRow("deep") << false;
+}
+
+void Test::XdeDocumentItem_shapePrototypes_test()
+{
+    const int depth = 3;
+    const int breadth = 4;
+    const Handle_TDocStd_Document doc = Internal::createDeepAssembly(depth, breadth);
+    {
+        // All leaves of the assembly are instances of the same box
+        const XdeDocumentItem xdeDocItem(doc);
+        const std::vector<XdeDocumentItem::ShapePrototype> vecPrototype = xdeDocItem.shapePrototypes();
+        QCOMPARE(static_cast<int>(vecPrototype.size()), 1);
+        const XdeDocumentItem::ShapePrototype& prototype = vecPrototype.front();
+        QVERIFY(XdeDocumentItem::isShapeSimple(prototype.label));
+        QCOMPARE(static_cast<int>(prototype.vecInstanceLocation.size()), int(std::pow(breadth, depth)));
+
+        // Instance locations are the absolute locations of the leaves in the assembly tree
+        std::set<double> setInstanceX;
+        for (const TopLoc_Location& loc : prototype.vecInstanceLocation)
+            setInstanceX.insert(loc.Transformation().TranslationPart().X());
+
+        QCOMPARE(setInstanceX.size(), prototype.vecInstanceLocation.size());
+        XdeDocumentItem xdeDocItemFetched(doc);
+        xdeDocItemFetched.fetchAssemblyTree();
+        const Tree<TDF_Label>& asmTree = xdeDocItemFetched.assemblyTree();
+        deepForeachTreeNode(asmTree, [&](TreeNodeId nodeId) {
+            if (asmTree.nodeChildFirst(nodeId) == 0) {
+                const TopLoc_Location loc = xdeDocItemFetched.shapeAbsoluteLocation(nodeId);
+                QVERIFY(setInstanceX.find(loc.Transformation().TranslationPart().X()) != setInstanceX.cend());
+            }
+        });
+    }
+
+    {
+        // Free shape not part of any assembly is a prototype with a single instance
+        Handle_XCAFDoc_ShapeTool shapeTool = XCAFDoc_DocumentTool::ShapeTool(doc->Main());
+        const TDF_Label labelSphere = shapeTool->AddShape(BRepPrimAPI_MakeSphere(1.), false);
+        const XdeDocumentItem xdeDocItem(doc);
+        const std::vector<XdeDocumentItem::ShapePrototype> vecPrototype = xdeDocItem.shapePrototypes();
+        QCOMPARE(static_cast<int>(vecPrototype.size()), 2);
+        int uniqueCount = 0;
+        int instancedCount = 0;
+        for (const XdeDocumentItem::ShapePrototype& prototype : vecPrototype) {
+            if (prototype.vecInstanceLocation.size() == 1) {
+                ++uniqueCount;
+                QVERIFY(prototype.label == labelSphere);
+                QVERIFY(prototype.vecInstanceLocation.front().IsIdentity());
+            }
+            else {
+                ++instancedCount;
+            }
+        }
+
+        QCOMPARE(uniqueCount, 1);
+        QCOMPARE(instancedCount, 1);
+    }
+}
+
 void Test::LibTree_test()
 {
     const TreeNodeId nullptrId = 0;
@@ -416,6 +2668,7 @@ void Test::LibTree_test()
     TreeNodeId n0_2 = tree.appendChild(n0, "0-2");
     TreeNodeId n0_1_1 = tree.appendChild(n0_1, "0-1-1");
     TreeNodeId n0_1_2 = tree.appendChild(n0_1, "0-1-2");
+    TreeNodeId n0_3 = tree.appendChild(n0, "0-3");
 
     QCOMPARE(tree.nodeParent(n0_1), n0);
     QCOMPARE(tree.nodeParent(n0_2), n0);
@@ -426,6 +2679,62 @@ void Test::LibTree_test()
     QCOMPARE(tree.nodeSiblingNext(n0_1_1), n0_1_2);
     QCOMPARE(tree.nodeSiblingPrevious(n0_1_2), n0_1_1);
     QCOMPARE(tree.nodeSiblingNext(n0_1_2), nullptrId);
+    QCOMPARE(tree.nodeChildCount(n0), 3);
+    QCOMPARE(tree.nodeChildCount(n0_2), 0);
+    QCOMPARE(tree.nodeSiblingIndex(n0), 0);
+    QCOMPARE(tree.nodeSiblingIndex(n0_2), 1);
+    QCOMPARE(tree.nodeSiblingIndex(n0_1_2), 1);
+    QCOMPARE(tree.nodeChild(n0, 1), n0_2);
+    QCOMPARE(tree.nodeChild(n0, 2), n0_3);
+    QCOMPARE(tree.nodeChild(n0_1, 0), n0_1_1);
+    QCOMPARE(tree.nodeChild(n0_1, 1), n0_1_2);
+    QCOMPARE(tree.nodeChild(n0_1, 2), nullptrId);
+}
+
+void Test::LibTree_benchmark()
+{
+    // Tree backing the model tree view, 1111111 nodes with default depth
+    int depth = qEnvironmentVariableIntValue("MAYO_BENCH_TREE_DEPTH");
+    if (depth <= 0)
+        depth = 7;
+
+    const int breadth = 10;
+    const qint64 memUsageBefore = OsUtils::processMemoryUsage();
+    Tree<TDF_Label> tree;
+    std::vector<TreeNodeId> vecParentId = { tree.appendChild(0, TDF_Label()) };
+    for (int level = 1; level < depth; ++level) {
+        std::vector<TreeNodeId> vecChildId;
+        vecChildId.reserve(vecParentId.size() * breadth);
+        for (TreeNodeId parentId : vecParentId) {
+            for (int i = 0; i < breadth; ++i)
+                vecChildId.push_back(tree.appendChild(parentId, TDF_Label()));
+        }
+
+        vecParentId = std::move(vecChildId);
+    }
+
+    const TreeNodeId nodeCount = vecParentId.back();
+    const qint64 memUsageAfter = OsUtils::processMemoryUsage();
+    if (memUsageBefore > 0 && memUsageAfter > 0) {
+        qInfo() << "Nodes:" << nodeCount
+                << "Memory(KB):" << (memUsageAfter - memUsageBefore) / 1024;
+    }
+
+    // Selection in the model tree view maps nodes to model indexes (row + parent)
+    // and back, checks the round-trip on the leaves which is the worst case
+    int mismatchCount = 0;
+    QBENCHMARK {
+        mismatchCount = 0;
+        for (TreeNodeId id : vecParentId) {
+            const int row = tree.nodeSiblingIndex(id);
+            const TreeNodeId parentId = tree.nodeParent(id);
+            if (tree.nodeChild(parentId, row) != id)
+                ++mismatchCount;
+        }
+    }
+
+    QCOMPARE(mismatchCount, 0);
+    QCOMPARE(tree.nodeChildCount(tree.nodeParent(nodeCount)), breadth);
 }
 
 } // namespace Mayo
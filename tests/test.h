@@ -15,24 +15,77 @@ class Test : public QObject {
     Q_OBJECT
 
 private slots:
+    void AisContext_selectionActivation_benchmark();
+    void AisContext_selectionActivation_benchmark_data();
+    void AisContext_toggleSelection_benchmark();
+    void AisContext_toggleSelection_benchmark_data();
     void Application_test();
     void Application_test_data();
+    void Application_concurrentImport_test();
+    void Application_concurrentImport_test_data();
+    void Application_meshingAtImport_test();
+    void Application_meshingAtImport_test_data();
+    void BndBoxTree_test();
+    void BndBoxTree_benchmark();
+    void BndBoxTree_benchmark_data();
     void BRepUtils_test();
+    void BRepUtils_faceIndex_benchmark();
+    void BRepUtils_faceIndex_benchmark_data();
     void CafUtils_test();
+    void CafUtils_labelHash_benchmark();
+    void CafUtils_labelHash_benchmark_data();
+    void Document_addRootItems_test();
+    void GpxXdeDocumentItem_displayChange_test();
+    void MeshLod_test();
     void MeshUtils_test();
     void MeshUtils_test_data();
+    void MeshUtils_volumeArea_benchmark();
+    void MeshUtils_volumeArea_benchmark_data();
     void MeshUtils_orientation_test();
     void MeshUtils_orientation_test_data();
+    void MeshUtils_positionNormalBuffer_test();
+    void MeshUtils_positionNormalBuffer_benchmark();
+    void OsUtils_test();
     void Quantity_test();
+    void RenderQualityRegulator_test();
     void Result_test();
+    void ShapeDisplayChange_test();
+    void StlReader_test();
+    void StlReader_test_data();
+    void StlReader_asciiMultiSolid_test();
+    void StlReader_binaryTrailingData_test();
+    void StlReader_benchmark();
+    void StlReader_benchmark_data();
+    void StlWriter_test();
+    void StlWriter_test_data();
+    void StlWriter_benchmark();
+    void StlWriter_benchmark_data();
     void StringUtils_append_test();
     void StringUtils_append_test_data();
     void StringUtils_text_test();
     void StringUtils_text_test_data();
+    void TaskScheduler_test();
+    void TessellationCache_eviction_test();
+    void TessellationCache_test();
+    void TessellationCache_test_data();
     void UnitSystem_test();
     void UnitSystem_test_data();
+    void V3dViewController_coalescing_test();
+    void V3dViewer_sharedDriver_benchmark();
+    void V3dViewer_sharedDriver_benchmark_data();
+    void WorkStealingPool_test();
+    void WorkStealingPool_benchmark();
+    void WorkStealingPool_benchmark_data();
+    void XdeDocumentItem_absoluteLocation_test();
+    void XdeDocumentItem_absoluteLocation_benchmark();
+    void XdeDocumentItem_absoluteLocation_benchmark_data();
+    void XdeDocumentItem_lazyAssemblyTree_test();
+    void XdeDocumentItem_lazyAssemblyTree_benchmark();
+    void XdeDocumentItem_lazyAssemblyTree_benchmark_data();
+    void XdeDocumentItem_shapePrototypes_test();
 
     void LibTree_test();
+    void LibTree_benchmark();
 };
 
 } // namespace Mayo